@@ -0,0 +1,317 @@
+/*
+ *  `gfs-aho-corasick.c'.
+ *
+ *  This interface deals with the multiple patterns automaton.
+ *
+ *  Copyright (C) 2008  Efstathios Chatzikyriakidis (stathis.chatzikyriakidis@gmail.com).
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*!
+   \file gfs-aho-corasick.c
+   \brief This interface deals with the multiple patterns automaton.
+*/
+
+/* standard includes. */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <limits.h>
+#include <libintl.h>
+
+/* basic includes. */
+#include "gfs-i18n-macros.h"
+#include "gfs-typedefs.h"
+#include "gfs-aho-corasick.h"
+
+/* enumeration constants. */
+
+/*!
+   \brief Constants used from the interface.
+
+   This anonymous enumeration is used from the
+   interface in order to specify some constants.
+*/
+enum
+{
+  AC_ROOT = 0                   /*!< The root state of the automaton. */
+};
+
+/*!
+   \def AC_ACCEPT
+   \brief Accepting transition bit.
+
+   This define marks the transitions into accepting states.
+*/
+#define AC_ACCEPT 0x80000000U
+
+/* function prototypes. */
+AHO_CORASICK *new_aho_corasick (char *const *patterns, const size_t * lens,
+                                const ulong num, const BOOL fold);
+void free_aho_corasick (AHO_CORASICK * acp);
+const uchar *aho_corasick_find (const AHO_CORASICK * acp, const uchar * p,
+                                size_t n);
+
+/* functions. */
+
+/*!
+   \fn AHO_CORASICK * new_aho_corasick (char *const *, const size_t *, const ulong, const BOOL)
+
+   \brief A function that compiles many patterns into an automaton.
+
+   This function compiles the `num' patterns (`patterns' with lengths
+   `lens') into a new Aho-Corasick automaton. First, the characters
+   of the patterns get their classes. Then, the patterns are inserted
+   in a trie, which is completed (breadth first, with the failure
+   links) into a deterministic automaton. If `fold' is `true', then
+   the automaton ignores case distinctions. No pattern may be empty.
+
+   \param patterns a pointer to a constant pointer to a character.
+   \param lens a pointer to a constant `size_t' type definition.
+   \param num a constant unsigned long integer.
+   \param fold a constant `BOOL' enumeration value.
+
+   \return A pointer to a `AHO_CORASICK' data structure.
+*/
+AHO_CORASICK *
+new_aho_corasick (char *const *patterns, const size_t * lens,
+                  const ulong num, const BOOL fold)
+{
+  /* externs. */
+
+  /* function externs. */
+  extern void *emalloc (size_t);
+  extern void *erealloc (void *, size_t);
+  extern void eprintf (char *, ...);
+
+  /* variable externs. */
+  extern cstring usage_too_many_patterns;
+
+  /* local variables. */
+
+  AHO_CORASICK *newp;
+
+  /* the failure links and the breadth first queue. */
+  uint *fail, *queue;
+
+  /* the total length of the patterns (the max number of states). */
+  ulong total = 1L;
+
+  /* is used for the loops. */
+  register ulong i;
+  register size_t j;
+  register int c;
+
+  /* the trie walking states. */
+  uint s, t, k, head, tail;
+
+  /* allocate enough memory space. */
+  newp = (AHO_CORASICK *) emalloc (sizeof (AHO_CORASICK));
+
+  /* the class of each character (class 0 is for the
+     characters which do not occur in any pattern). */
+  memset (newp->classes, 0, sizeof (newp->classes));
+  memset (newp->starts, 0, sizeof (newp->starts));
+  newp->num_classes = 1;
+
+  for (i = 0L; i < num; i++)
+    {
+      for (j = 0; j < lens[i]; j++)
+        {
+          c = (uchar) patterns[i][j];
+          if (fold)
+            c = tolower (c);
+
+          if (newp->classes[c] == 0)
+            newp->classes[c] = newp->num_classes++;
+        }
+
+      total += lens[i];
+    }
+
+  /* the other case of a character shares its class. */
+  if (fold)
+    for (c = 0; c <= UCHAR_MAX; c++)
+      newp->classes[c] = newp->classes[tolower (c)];
+
+  /* check that the premultiplied states fit. */
+  if (total > (ulong) (AC_ACCEPT - 1) / newp->num_classes)
+    eprintf ("%s", _(usage_too_many_patterns));
+
+  k = newp->num_classes;
+  newp->delta = (uint *) emalloc (total * k * sizeof (uint));
+  memset (newp->delta, 0, total * k * sizeof (uint));
+  newp->num_states = 1;
+
+  /* build the trie (a zero transition means no child,
+     since the root state is never a child). */
+  for (i = 0L; i < num; i++)
+    {
+      s = AC_ROOT;
+
+      for (j = 0; j < lens[i]; j++)
+        {
+          const uint cls = newp->classes[(uchar) patterns[i][j]];
+
+          if ((newp->delta[s + cls] & ~AC_ACCEPT) == 0)
+            newp->delta[s + cls] = (newp->num_states++) * k;
+
+          /* the last character of a pattern is accepting. */
+          if (j + 1 == lens[i])
+            newp->delta[s + cls] |= AC_ACCEPT;
+
+          s = newp->delta[s + cls] & ~AC_ACCEPT;
+        }
+    }
+
+  /* the characters which can start a pattern. */
+  newp->start = -1;
+  for (c = 0, j = 0; c <= UCHAR_MAX; c++)
+    if (newp->delta[AC_ROOT + newp->classes[c]] != 0)
+      {
+        newp->starts[c] = 1;
+        newp->start = c;
+        j++;
+      }
+
+  /* more than one starting character. */
+  if (j > 1)
+    newp->start = -1;
+
+  /* complete the trie breadth first. The failure link of a state
+     is kept as the row of the state (premultiplied). */
+  fail = (uint *) emalloc (newp->num_states * sizeof (uint));
+  queue = (uint *) emalloc (newp->num_states * sizeof (uint));
+  head = tail = 0;
+
+  fail[0] = AC_ROOT;
+  for (c = 0; c < (int) k; c++)
+    if ((t = newp->delta[AC_ROOT + (uint) c] & ~AC_ACCEPT) != 0)
+      {
+        fail[t / k] = AC_ROOT;
+        queue[tail++] = t;
+      }
+
+  while (head < tail)
+    {
+      s = queue[head++];
+
+      for (c = 0; c < (int) k; c++)
+        {
+          /* the transition of the failure state. */
+          const uint f = newp->delta[fail[s / k] + (uint) c];
+
+          t = newp->delta[s + (uint) c] & ~AC_ACCEPT;
+
+          if (t != 0)
+            {
+              /* a trie child: link it and inherit the outputs. */
+              fail[t / k] = f & ~AC_ACCEPT;
+              newp->delta[s + (uint) c] |= (f & AC_ACCEPT);
+              queue[tail++] = t;
+            }
+          else
+            /* a missing child: follow the failure state. */
+            newp->delta[s + (uint) c] = f;
+        }
+    }
+
+  free (queue);
+  free (fail);
+
+  /* release the unused states. */
+  newp->delta = (uint *) erealloc (newp->delta, newp->num_states * k
+                                   * sizeof (uint));
+
+  /* return the automaton pointer. */
+  return newp;
+}
+
+/*!
+   \fn void free_aho_corasick (AHO_CORASICK *)
+
+   \brief A function that deallocates an `AHO_CORASICK' data structure.
+
+   \param acp a pointer to a `AHO_CORASICK' data structure.
+*/
+void
+free_aho_corasick (AHO_CORASICK * acp)
+{
+  if (acp != NULL)
+    {
+      free (acp->delta);
+      free (acp);
+    }
+}
+
+/*!
+   \fn const uchar * aho_corasick_find (const AHO_CORASICK *, const uchar *, size_t)
+
+   \brief A function that finds the first occurrence of any pattern.
+
+   This function runs the automaton (`acp') over the `n' characters
+   of `p' once. While the automaton is in its root state, it skips
+   the characters which can not start a pattern (with `memchr' if
+   there is only one starting character). It returns a pointer
+   to the last character of the first occurrence of any pattern or
+   NULL if there is not any.
+
+   \param acp a pointer to a constant `AHO_CORASICK' data structure.
+   \param p a pointer to a constant unsigned character.
+   \param n a `size_t' type definition.
+
+   \return A pointer to a constant unsigned character.
+*/
+const uchar *
+aho_corasick_find (const AHO_CORASICK * acp, const uchar * p, size_t n)
+{
+  /* the end of the data. */
+  const uchar *const end = p + n;
+
+  /* the automaton tables. */
+  const uint *const delta = acp->delta;
+  const uint *const classes = acp->classes;
+  const uchar *const starts = acp->starts;
+
+  /* the current state. */
+  register uint s = AC_ROOT;
+
+  while (p < end)
+    {
+      /* skip the characters which can not start a pattern. */
+      if (s == AC_ROOT)
+        {
+          if (acp->start >= 0)
+            p = (const uchar *) memchr (p, acp->start, (size_t) (end - p));
+          else
+            while (p < end && !starts[*p])
+              p++;
+
+          if (p == NULL || p == end)
+            break;
+        }
+
+      s = delta[s + classes[*p]];
+
+      /* an occurrence ends here. */
+      if (s & AC_ACCEPT)
+        return p;
+
+      p++;
+    }
+
+  return NULL;
+}
@@ -0,0 +1,93 @@
+/*
+ *  `gfs-aho-corasick.h'.
+ *
+ *  This header contains the multiple patterns automaton struct and typedef.
+ *
+ *  Copyright (C) 2008  Efstathios Chatzikyriakidis (stathis.chatzikyriakidis@gmail.com).
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*!
+   \file gfs-aho-corasick.h
+   \brief This header contains the multiple patterns automaton struct and typedef.
+*/
+
+/*
+ * structure data types.
+ */
+
+/*!
+   \struct aho_corasickT
+   \brief Aho-Corasick automaton data structure.
+
+   This data structure keeps an Aho-Corasick automaton of many
+   patterns as a complete deterministic automaton. The characters
+   are mapped into classes (the characters which do not occur in
+   any pattern share one class), so each state has a small row of
+   transitions. The transitions are premultiplied by the number of
+   classes (they point to the row of the next state) and the ones
+   into an accepting state have the `AC_ACCEPT' bit set.
+*/
+struct aho_corasickT
+{
+  /*!
+     \var delta
+     \brief The transitions (states x classes).
+   */
+  uint *delta;
+
+  /*!
+     \var classes
+     \brief The class of each character.
+   */
+  uint classes[UCHAR_MAX + 1];
+
+  /*!
+     \var starts
+     \brief Can a pattern start with each character?
+   */
+  uchar starts[UCHAR_MAX + 1];
+
+  /*!
+     \var start
+     \brief The only character which can start a pattern (or -1).
+   */
+  int start;
+
+  /*!
+     \var num_classes
+     \brief The number of character classes.
+   */
+  uint num_classes;
+
+  /*!
+     \var num_states
+     \brief The number of states.
+   */
+  uint num_states;
+};
+
+/*
+ * type definitions.
+ */
+
+/*!
+   \typedef AHO_CORASICK
+   \brief Aho-Corasick automaton data structure type definition.
+
+   This type definition is a synonym for
+   the Aho-Corasick automaton data structure.
+*/
+typedef struct aho_corasickT AHO_CORASICK;
@@ -0,0 +1,209 @@
+/*
+ *  `gfs-arena.c'.
+ *
+ *  This interface deals with the memory arenas.
+ *
+ *  Copyright (C) 2008  Efstathios Chatzikyriakidis (stathis.chatzikyriakidis@gmail.com).
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*!
+   \file gfs-arena.c
+   \brief This interface deals with the memory arenas.
+*/
+
+/* standard includes. */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* basic includes. */
+#include "gfs-typedefs.h"
+#include "gfs-arena.h"
+
+/* enumeration constants. */
+
+/*!
+   \brief Constants used from the interface.
+
+   This anonymous enumeration is used from the
+   interface in order to specify some constants.
+*/
+enum
+{
+  ARENA_BLOCK_SIZE = 64 * 1024, /*!< Min block characters (64Kbytes). */
+  ARENA_ALIGN = sizeof (void *) /*!< The alignment of an object. */
+};
+
+/* function prototypes. */
+ARENA *new_arena (void);
+void free_arena (ARENA * ap);
+void *arena_alloc (ARENA * ap, size_t size);
+char *arena_strdup (ARENA * ap, const char *str);
+static void *arena_take (ARENA * ap, size_t size, const size_t align);
+
+/* functions. */
+
+/*!
+   \fn ARENA * new_arena (void)
+
+   \brief A function that returns a new empty memory arena.
+
+   \return A pointer to a `ARENA' data structure.
+*/
+ARENA *
+new_arena (void)
+{
+  /* externs. */
+
+  /* function externs. */
+  extern void *emalloc (size_t);
+
+  ARENA *newp;
+
+  /* allocate enough memory space. */
+  newp = (ARENA *) emalloc (sizeof (ARENA));
+
+  newp->blocks = NULL;
+  newp->pos = NULL;
+  newp->left = newp->used = newp->reserved = 0;
+
+  /* return the arena pointer. */
+  return newp;
+}
+
+/*!
+   \fn void free_arena (ARENA *)
+
+   \brief A function that deallocates a memory arena.
+
+   This function deallocates a memory arena (`ap') and
+   all the objects of the arena at once.
+
+   \param ap a pointer to a `ARENA' data structure.
+*/
+void
+free_arena (ARENA * ap)
+{
+  ARENA_BLOCK *bp, *nextp;
+
+  if (ap == NULL)
+    return;
+
+  for (bp = ap->blocks; bp != NULL; bp = nextp)
+    {
+      nextp = bp->next;
+      free (bp);
+    }
+
+  free (ap);
+}
+
+/*!
+   \fn void * arena_alloc (ARENA *, size_t)
+
+   \brief A function that allocates an object in a memory arena.
+
+   This function allocates `size' characters (aligned for any
+   pointer) in the arena (`ap').
+
+   \param ap a pointer to a `ARENA' data structure.
+   \param size a `size_t' type definition.
+
+   \return A pointer to void.
+*/
+void *
+arena_alloc (ARENA * ap, size_t size)
+{
+  return arena_take (ap, size, ARENA_ALIGN);
+}
+
+/*!
+   \fn char * arena_strdup (ARENA *, const char *)
+
+   \brief A function that copies a string into a memory arena.
+
+   This function copies the string `str' into the arena (`ap').
+   The strings are packed without any alignment.
+
+   \param ap a pointer to a `ARENA' data structure.
+   \param str a pointer to a constant character.
+
+   \return A pointer to a character.
+*/
+char *
+arena_strdup (ARENA * ap, const char *str)
+{
+  const size_t n = strlen (str) + 1;
+
+  return (char *) memcpy (arena_take (ap, n, 1), str, n);
+}
+
+/*!
+   \fn static void * arena_take (ARENA *, size_t, const size_t)
+
+   \brief A function that takes memory from the current block of an arena.
+
+   This function takes `size' characters aligned to `align' (a power
+   of two) from the current block of the arena (`ap'). If they do not
+   fit, a new block is started (a large object gets its own block).
+
+   \param ap a pointer to a `ARENA' data structure.
+   \param size a `size_t' type definition.
+   \param align a constant `size_t' type definition.
+
+   \return A pointer to void.
+*/
+static void *
+arena_take (ARENA * ap, size_t size, const size_t align)
+{
+  /* externs. */
+
+  /* function externs. */
+  extern void *emalloc (size_t);
+
+  /* the new block. */
+  ARENA_BLOCK *bp;
+  size_t block_size;
+
+  /* the padding of the alignment. */
+  size_t pad = (align - (size_t) ap->pos % align) % align;
+
+  /* the object. */
+  void *p;
+
+  if (size + pad > ap->left)
+    {
+      block_size = (size > ARENA_BLOCK_SIZE ? size : ARENA_BLOCK_SIZE);
+
+      /* the memory of the block follows its header. */
+      bp = (ARENA_BLOCK *) emalloc (sizeof (ARENA_BLOCK) + block_size);
+      bp->next = ap->blocks;
+      bp->size = block_size;
+      ap->blocks = bp;
+      ap->reserved += sizeof (ARENA_BLOCK) + block_size;
+
+      ap->pos = (char *) (bp + 1);
+      ap->left = block_size;
+      pad = 0;
+    }
+
+  p = ap->pos + pad;
+  ap->pos += size + pad;
+  ap->left -= size + pad;
+  ap->used += size;
+
+  return p;
+}
@@ -0,0 +1,114 @@
+/*
+ *  `gfs-arena.h'.
+ *
+ *  This header contains the memory arena structs and typedefs.
+ *
+ *  Copyright (C) 2008  Efstathios Chatzikyriakidis (stathis.chatzikyriakidis@gmail.com).
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*!
+   \file gfs-arena.h
+   \brief This header contains the memory arena structs and typedefs.
+*/
+
+/*
+ * structure data types.
+ */
+
+/*!
+   \struct arena_blockT
+   \brief Memory arena block data structure.
+
+   This data structure is the header of a block of an arena. The
+   memory of the block follows the header.
+*/
+struct arena_blockT
+{
+  /*!
+     \var next
+     \brief The previous block of the arena.
+   */
+  struct arena_blockT *next;
+
+  /*!
+     \var size
+     \brief The size of the memory of the block.
+   */
+  size_t size;
+};
+
+/*!
+   \struct arenaT
+   \brief Memory arena data structure.
+
+   This data structure keeps many small objects (which live
+   together) contiguously in large blocks. An object is allocated
+   by bumping a pointer and all of them are released at once.
+*/
+struct arenaT
+{
+  /*!
+     \var blocks
+     \brief The blocks of the arena (the current one first).
+   */
+  struct arena_blockT *blocks;
+
+  /*!
+     \var pos
+     \brief The free memory of the current block.
+   */
+  char *pos;
+
+  /*!
+     \var left
+     \brief The size of the free memory of the current block.
+   */
+  size_t left;
+
+  /*!
+     \var used
+     \brief The total size of the allocated objects.
+   */
+  size_t used;
+
+  /*!
+     \var reserved
+     \brief The total size of the blocks.
+   */
+  size_t reserved;
+};
+
+/*
+ * type definitions.
+ */
+
+/*!
+   \typedef ARENA_BLOCK
+   \brief Memory arena block data structure type definition.
+
+   This type definition is a synonym
+   for the memory arena block data structure.
+*/
+typedef struct arena_blockT ARENA_BLOCK;
+
+/*!
+   \typedef ARENA
+   \brief Memory arena data structure type definition.
+
+   This type definition is a synonym
+   for the memory arena data structure.
+*/
+typedef struct arenaT ARENA;
@@ -0,0 +1,710 @@
+/*
+ *  `gfs-cache.c'.
+ *
+ *  This interface deals with the result cache of the searches.
+ *
+ *  Copyright (C) 2008  Efstathios Chatzikyriakidis (stathis.chatzikyriakidis@gmail.com).
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*!
+   \file gfs-cache.c
+   \brief This interface deals with the result cache of the searches.
+*/
+
+/* standard includes. */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <utime.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <libintl.h>
+
+/* basic includes. */
+#include "gfs-i18n-macros.h"
+#include "gfs-typedefs.h"
+#include "gfs-options.h"
+#include "gfs-input-files-list.h"
+#include "gfs-cache.h"
+
+/* enumeration constants. */
+
+/*!
+   \brief Constants used from the interface.
+
+   This anonymous enumeration is used from the
+   interface in order to specify some constants.
+*/
+enum
+{
+  NAME_ROOM = 64,               /*!< Room for the name of a cached result file. */
+  PRUNE_INTERVAL = 24 * 60 * 60,        /*!< Seconds between two prunes (a day). */
+  MAX_AGE = 30 * 24 * 60 * 60,  /*!< Seconds a cached result is kept unused. */
+  TEMP_AGE = 60 * 60            /*!< Seconds a file which is written aside is kept. */
+};
+
+/* basic defines. */
+
+/*!
+   \def RESULT_MAGIC
+   \brief The magic characters of a cached result file.
+*/
+#define RESULT_MAGIC "GFS\0RES3"
+
+/*!
+   \def RESULT_WORD
+   \brief The known number of the header of a cached result file.
+*/
+#define RESULT_WORD 0x01020304UL
+
+/*!
+   \def RESULT_TEMP
+   \brief The suffix of a cached result file which is written.
+*/
+#define RESULT_TEMP ".XXXXXX"
+
+/*!
+   \def RESULT_DIGITS
+   \brief The characters of the name of a cached result file.
+*/
+#define RESULT_DIGITS "0123456789abcdef-"
+
+/*!
+   \def PRUNE_STAMP
+   \brief The file whose modification time is the time of the last prune.
+*/
+#define PRUNE_STAMP ".pruned"
+
+/*!
+   \def ALIGNED
+   \brief Rounds up a size to a multiple of the size of a word.
+*/
+#define ALIGNED(n) (((n) + sizeof (ulong) - 1) / sizeof (ulong) * sizeof (ulong))
+
+/* function prototypes. */
+RESULT_CACHE *open_result_cache (OPTIONS * cop);
+void free_result_cache (RESULT_CACHE * cp);
+CACHED_RESULT *find_result (const RESULT_CACHE * cp,
+                            const INPUT_FILE * node);
+void free_result (CACHED_RESULT * rp);
+void store_result (const RESULT_CACHE * cp, const INPUT_FILE * node,
+                   const ulong num_match, const RESULT_RECORD * recs,
+                   const ulong num_recs);
+static void prune_cache (const char *dir);
+static BOOL stale_result (const char *name, const struct stat *sp,
+                          const time_t now);
+static char *result_name (const RESULT_CACHE * cp, const INPUT_FILE * node);
+static BOOL check_result (const RESULT_CACHE * cp, const RESULT_HEADER * hp,
+                          const size_t size);
+static BOOL write_part (FILE * fp, const void *p, const size_t n,
+                        const size_t pad);
+
+/* functions. */
+
+/*!
+   \fn RESULT_CACHE * open_result_cache (OPTIONS *)
+
+   \brief A function that opens the result cache of the command line arguments.
+
+   This function opens the result cache directory of the command line
+   arguments (`cop'), if any (it is made if it does not exist, and it
+   exits if it is not a directory), and prunes it once in a while (see
+   `prune_cache'). The key of the search is made of the options which
+   change the selected lines and of the patterns, so a cached result
+   is used only by the same search. If there is no result cache, it
+   returns NULL.
+
+   \param cop a pointer to a `OPTIONS' data structure.
+
+   \return A pointer to a `RESULT_CACHE' data structure.
+*/
+RESULT_CACHE *
+open_result_cache (OPTIONS * cop)
+{
+  /* externs. */
+
+  /* function externs. */
+  extern void *emalloc (size_t);
+  extern char *estrdup (const char *);
+  extern void eprintf (char *, ...);
+  extern ulong fnv_hash (const uchar *, const size_t);
+
+  /* variable externs. */
+  extern cstring usage_not_directory;
+
+  RESULT_CACHE *newp;
+
+  /* the status of the directory. */
+  struct stat stbuf;
+
+  /* the length of the key. */
+  size_t len;
+
+  /* is used for the loops. */
+  register ulong i;
+
+  if (cop->cache == NULL)
+    return NULL;
+
+  if (mkdir (cop->cache, 0777) == -1 && errno != EEXIST)
+    eprintf ("mkdir(\"%.500s\") failed:", cop->cache);
+
+  if (stat (cop->cache, &stbuf) == -1 || !S_ISDIR (stbuf.st_mode))
+    eprintf (_(usage_not_directory), cop->cache);
+
+  prune_cache (cop->cache);
+
+  /* allocate enough memory space. */
+  newp = (RESULT_CACHE *) emalloc (sizeof (RESULT_CACHE));
+  newp->dir = estrdup (cop->cache);
+
+  /* the options, then each pattern after its length. */
+  len = NAME_ROOM;
+  for (i = 0L; i < cop->num_patterns; i++)
+    len += NAME_ROOM + cop->pattern_lens[i];
+
+  newp->key = (uchar *) emalloc (len);
+  newp->key_len = (size_t) sprintf ((char *) newp->key,
+                                    "r%di%dE%dn%dq%dl%dc%dM%lu:%lu",
+                                    cop->reverse_match, cop->ignore_case,
+                                    cop->regex, cop->line_number, cop->quiet,
+                                    cop->list_files, cop->count_only,
+                                    cop->max_count, cop->num_patterns);
+
+  for (i = 0L; i < cop->num_patterns; i++)
+    {
+      newp->key_len += (size_t) sprintf ((char *) newp->key + newp->key_len,
+                                         ":%lu:", (ulong) cop->pattern_lens[i]);
+      memcpy (newp->key + newp->key_len, cop->patterns[i],
+              cop->pattern_lens[i]);
+      newp->key_len += cop->pattern_lens[i];
+    }
+
+  newp->hash = fnv_hash (newp->key, newp->key_len);
+
+  /* return the result cache pointer. */
+  return newp;
+}
+
+/*!
+   \fn void free_result_cache (RESULT_CACHE *)
+
+   \brief A function that deallocates a `RESULT_CACHE' data structure.
+
+   \param cp a pointer to a `RESULT_CACHE' data structure.
+*/
+void
+free_result_cache (RESULT_CACHE * cp)
+{
+  if (cp == NULL)
+    return;
+
+  free (cp->dir);
+  free (cp->key);
+  free (cp);
+}
+
+/*!
+   \fn CACHED_RESULT * find_result (const RESULT_CACHE *, const INPUT_FILE *)
+
+   \brief A function that finds the cached result of a file.
+
+   This function maps the cached result file of the search of the
+   result cache (`cp') in the open regular input file `node' in
+   memory, if there is one. The cached result is used only if it is
+   of the same search and of the same file (the device and the inode),
+   and the file is not changed since (the same size and modification
+   time). A file which is larger since is searched whole again (its
+   old characters may be changed too, and a check of them would cost
+   more than their search). If there is no usable cached result (a
+   cached result file which is not valid is written again later), it
+   returns NULL.
+
+   \param cp a pointer to a constant `RESULT_CACHE' data structure.
+   \param node a pointer to a constant `INPUT_FILE' data structure.
+
+   \return A pointer to a `CACHED_RESULT' data structure.
+*/
+CACHED_RESULT *
+find_result (const RESULT_CACHE * cp, const INPUT_FILE * node)
+{
+  /* externs. */
+
+  /* function externs. */
+  extern void *emalloc (size_t);
+
+  CACHED_RESULT *newp;
+
+  /* the cached result file. */
+  char *name = result_name (cp, node);
+  int fd;
+  struct stat stbuf;
+  void *map;
+  const RESULT_HEADER *hp;
+
+  /* the size of the cached result file. */
+  size_t size;
+
+  fd = open (name, O_RDONLY | O_NOCTTY);
+  free (name);
+
+  if (fd == -1)
+    return NULL;
+
+  size = (size_t) 0;
+  if (fstat (fd, &stbuf) == 0 && S_ISREG (stbuf.st_mode)
+      && stbuf.st_size >= (off_t) sizeof (RESULT_HEADER)
+      && (off_t) (size_t) stbuf.st_size == stbuf.st_size)
+    size = (size_t) stbuf.st_size;
+
+  map = (size > 0 ? mmap (NULL, size, PROT_READ, MAP_PRIVATE, fd, 0)
+         : MAP_FAILED);
+  close (fd);
+
+  if (map == MAP_FAILED)
+    return NULL;
+
+  hp = (const RESULT_HEADER *) map;
+
+  /* the same file, not changed since. */
+  if (!check_result (cp, hp, size) || hp->dev != (ulong) node->dev
+      || hp->ino != (ulong) node->ino
+      || (off_t) hp->data_size != node->size || hp->mtime != node->mtime
+      || hp->mtime_nsec != node->mtime_nsec)
+    {
+      munmap (map, size);
+      return NULL;
+    }
+
+  /* allocate enough memory space. */
+  newp = (CACHED_RESULT *) emalloc (sizeof (CACHED_RESULT));
+
+  newp->map = map;
+  newp->map_size = size;
+  newp->recs = (const RESULT_RECORD *) ((const char *) map + hp->recs);
+  newp->num_recs = hp->num_recs;
+  newp->num_match = hp->num_match;
+
+  /* return the cached result pointer. */
+  return newp;
+}
+
+/*!
+   \fn void free_result (CACHED_RESULT *)
+
+   \brief A function that deallocates a `CACHED_RESULT' data structure.
+
+   \param rp a pointer to a `CACHED_RESULT' data structure.
+*/
+void
+free_result (CACHED_RESULT * rp)
+{
+  if (rp == NULL)
+    return;
+
+  munmap (rp->map, rp->map_size);
+  free (rp);
+}
+
+/*!
+   \fn void store_result (const RESULT_CACHE *, const INPUT_FILE *, const ulong, const RESULT_RECORD *, const ulong)
+
+   \brief A function that writes the cached result of a file.
+
+   This function writes the results of the search of the result cache
+   (`cp') in the open regular input file `node': the number of the
+   selected lines (`num_match') and the `num_recs' records (`recs') of
+   the selected lines, after the absolute path of the file. The cached
+   result file is written aside and then renamed, so a concurrent
+   search reads either the old or the new one. If it can not be
+   written, it warns.
+
+   \param cp a pointer to a constant `RESULT_CACHE' data structure.
+   \param node a pointer to a constant `INPUT_FILE' data structure.
+   \param num_match a constant unsigned long integer.
+   \param recs a pointer to a constant `RESULT_RECORD' data structure.
+   \param num_recs a constant unsigned long integer.
+*/
+void
+store_result (const RESULT_CACHE * cp, const INPUT_FILE * node,
+              const ulong num_match, const RESULT_RECORD * recs,
+              const ulong num_recs)
+{
+  /* externs. */
+
+  /* function externs. */
+  extern void *emalloc (size_t);
+  extern void weprintf (char *, ...);
+
+  /* the header of the cached result file. */
+  RESULT_HEADER h;
+
+  /* the cached result file and the file which is written aside. */
+  char *name = result_name (cp, node);
+  char *temp;
+  FILE *fp;
+  int fd;
+
+  /* the absolute path of the searched file (if it is known). */
+  char *path = (node->path != NULL ? realpath (node->path, NULL) : NULL);
+  const size_t path_len = (path != NULL ? strlen (path) : 0);
+
+  /* is the cached result file written? */
+  BOOL written;
+
+  memset (&h, 0, sizeof (h));
+  memcpy (h.magic, RESULT_MAGIC, sizeof (h.magic));
+  h.word = RESULT_WORD;
+  h.dev = (ulong) node->dev;
+  h.ino = (ulong) node->ino;
+  h.data_size = (ulong) node->size;
+  h.mtime = node->mtime;
+  h.mtime_nsec = node->mtime_nsec;
+  h.num_match = num_match;
+  h.key_len = (ulong) cp->key_len;
+  h.path_len = (ulong) path_len;
+  h.num_recs = num_recs;
+  h.recs = ALIGNED (ALIGNED (sizeof (RESULT_HEADER)) + cp->key_len
+                    + path_len);
+  h.size = h.recs + num_recs * sizeof (RESULT_RECORD);
+
+  /* write the cached result file aside. */
+  temp = (char *) emalloc (strlen (name) + sizeof (RESULT_TEMP));
+  strcpy (temp, name);
+  strcat (temp, RESULT_TEMP);
+
+  if ((fd = mkstemp (temp)) == -1)
+    weprintf ("mkstemp(\"%.500s\") failed:", temp);
+  else if ((fp = fdopen (fd, "wb")) == NULL)
+    {
+      weprintf ("fdopen(\"%.500s\") failed:", temp);
+      close (fd);
+      unlink (temp);
+    }
+  else
+    {
+      written = (write_part (fp, &h, sizeof (h),
+                             ALIGNED (sizeof (h)) - sizeof (h))
+                 && write_part (fp, cp->key, cp->key_len, 0)
+                 && write_part (fp, path, path_len,
+                                h.recs - ALIGNED (sizeof (h)) - cp->key_len
+                                - path_len)
+                 && write_part (fp, recs, num_recs * sizeof (RESULT_RECORD),
+                                0)) ? true : false;
+
+      if (fclose (fp) != 0)
+        written = false;
+
+      if (!written)
+        weprintf ("fwrite(\"%.500s\") failed:", temp);
+      else if (rename (temp, name) == -1)
+        {
+          weprintf ("rename(\"%.500s\") failed:", temp);
+          written = false;
+        }
+
+      if (!written)
+        unlink (temp);
+    }
+
+  free (temp);
+  free (name);
+  free (path);
+}
+
+/*!
+   \fn static void prune_cache (const char *)
+
+   \brief A function that prunes the cached result files of a directory.
+
+   This function removes from the result cache directory `dir' the
+   cached result files which are stale (see `stale_result'). The
+   directory is read at most once in `PRUNE_INTERVAL' seconds (the
+   time of the last prune is kept in the modification time of its
+   `PRUNE_STAMP' file), so most searches do not read it at all. Only
+   the files which are named as cached result files are looked at.
+   Nothing is warned, a file which can not be removed is left.
+
+   \param dir a pointer to a constant character.
+*/
+static void
+prune_cache (const char *dir)
+{
+  /* externs. */
+
+  /* function externs. */
+  extern void *emalloc (size_t);
+
+  /* a file of the directory. */
+  char *name = (char *) emalloc (strlen (dir) + NAME_ROOM);
+  struct stat stbuf;
+  int fd;
+
+  /* the directory and its entries. */
+  DIR *dp;
+  struct dirent *de;
+
+  /* the length of the name of an entry (up to a suffix). */
+  size_t len;
+
+  /* the time of the prune. */
+  const time_t now = time (NULL);
+
+  /* the directory is pruned lately. */
+  sprintf (name, "%s/%s", dir, PRUNE_STAMP);
+  if (stat (name, &stbuf) == 0 && stbuf.st_mtime <= now
+      && now - stbuf.st_mtime < PRUNE_INTERVAL)
+    {
+      free (name);
+      return;
+    }
+
+  /* the other searches skip the prune from now on. */
+  if ((fd = open (name, O_WRONLY | O_CREAT | O_NOCTTY, 0666)) == -1)
+    {
+      free (name);
+      return;
+    }
+
+  close (fd);
+  utime (name, NULL);
+
+  if ((dp = opendir (dir)) == NULL)
+    {
+      free (name);
+      return;
+    }
+
+  while ((de = readdir (dp)) != NULL)
+    {
+      /* a cached result file (or one which is written aside). */
+      len = strspn (de->d_name, RESULT_DIGITS);
+      if (len == 0 || strlen (de->d_name) + 2 > NAME_ROOM
+          || (de->d_name[len] != '\0'
+              && strlen (de->d_name + len) != strlen (RESULT_TEMP)))
+        continue;
+
+      sprintf (name, "%s/%s", dir, de->d_name);
+      if (lstat (name, &stbuf) == -1 || !S_ISREG (stbuf.st_mode))
+        continue;
+
+      /* a file which is written aside is left by a
+         search which stopped (unless it is still written). */
+      if (de->d_name[len] != '\0'
+          ? now - stbuf.st_mtime > TEMP_AGE
+          : stale_result (name, &stbuf, now))
+        unlink (name);
+    }
+
+  closedir (dp);
+  free (name);
+}
+
+/*!
+   \fn static BOOL stale_result (const char *, const struct stat *, const time_t)
+
+   \brief A function that checks if a cached result file is stale.
+
+   This function checks the cached result file `name' (whose status is
+   `sp'): it is stale if it is not used for `MAX_AGE' seconds (since it
+   is written or read last, as of `now'), if it is of another version,
+   or if its searched file is gone (its path names no file, or another
+   file). A file which is not a cached result file is not stale.
+
+   \param name a pointer to a constant character.
+   \param sp a pointer to a constant `stat' data structure.
+   \param now a constant `time_t' type definition.
+
+   \return A `BOOL' enumeration value (`false', `true').
+*/
+static BOOL
+stale_result (const char *name, const struct stat *sp, const time_t now)
+{
+  /* externs. */
+
+  /* function externs. */
+  extern void *emalloc (size_t);
+
+  /* the header of the cached result file. */
+  RESULT_HEADER h;
+  int fd;
+
+  /* the path of the searched file and its status. */
+  char *path;
+  struct stat stbuf;
+
+  /* the last use of the cached result file. */
+  const time_t used = (sp->st_atime > sp->st_mtime ? sp->st_atime
+                       : sp->st_mtime);
+
+  /* is the cached result file stale? */
+  BOOL stale = false;
+
+  if ((fd = open (name, O_RDONLY | O_NOCTTY)) == -1)
+    return false;
+
+  if (read (fd, &h, sizeof (h)) != (ssize_t) sizeof (h)
+      || memcmp (h.magic, RESULT_MAGIC, sizeof (h.magic) - 1))
+    {
+      /* not a cached result file. */
+      close (fd);
+      return false;
+    }
+
+  if (h.magic[sizeof (h.magic) - 1] != RESULT_MAGIC[sizeof (h.magic) - 1]
+      || h.word != RESULT_WORD || now - used > MAX_AGE)
+    stale = true;
+  else if (h.path_len > 0 && h.path_len < (ulong) sp->st_size)
+    {
+      path = (char *) emalloc ((size_t) h.path_len + 1);
+
+      /* the path names another file, or none. */
+      if (pread (fd, path, (size_t) h.path_len,
+                 (off_t) (ALIGNED (sizeof (h)) + h.key_len))
+          == (ssize_t) h.path_len)
+        {
+          path[h.path_len] = '\0';
+          if (stat (path, &stbuf) == -1)
+            stale = (errno == ENOENT || errno == ENOTDIR) ? true : false;
+          else if ((ulong) stbuf.st_dev != h.dev
+                   || (ulong) stbuf.st_ino != h.ino)
+            stale = true;
+        }
+
+      free (path);
+    }
+
+  close (fd);
+
+  return stale;
+}
+
+/*!
+   \fn static char * result_name (const RESULT_CACHE *, const INPUT_FILE *)
+
+   \brief A function that returns the name of a cached result file.
+
+   This function returns the path of the cached result file of the
+   search of the result cache (`cp') in the input file `node': the
+   hash of the key, the device and the inode, in the directory of
+   the result cache. The caller releases it.
+
+   \param cp a pointer to a constant `RESULT_CACHE' data structure.
+   \param node a pointer to a constant `INPUT_FILE' data structure.
+
+   \return A pointer to a character.
+*/
+static char *
+result_name (const RESULT_CACHE * cp, const INPUT_FILE * node)
+{
+  /* externs. */
+
+  /* function externs. */
+  extern void *emalloc (size_t);
+
+  char *name = (char *) emalloc (strlen (cp->dir) + NAME_ROOM);
+
+  sprintf (name, "%s/%08lx-%lx-%lx", cp->dir, cp->hash, (ulong) node->dev,
+           (ulong) node->ino);
+
+  return name;
+}
+
+/*!
+   \fn static BOOL check_result (const RESULT_CACHE *, const RESULT_HEADER *, const size_t)
+
+   \brief A function that checks a mapped cached result file.
+
+   This function checks the header (`hp') of a mapped cached result
+   file of `size' characters: its magic, its key (the same as the key
+   of the search of the result cache `cp'), the bounds of the path of
+   the searched file and of its records (each one is a line of the
+   searched file). If it is not
+   valid, it returns `false'.
+
+   \param cp a pointer to a constant `RESULT_CACHE' data structure.
+   \param hp a pointer to a constant `RESULT_HEADER' data structure.
+   \param size a constant `size_t' type definition.
+
+   \return A `BOOL' enumeration value (`false', `true').
+*/
+static BOOL
+check_result (const RESULT_CACHE * cp, const RESULT_HEADER * hp,
+              const size_t size)
+{
+  /* the records of the selected lines. */
+  const RESULT_RECORD *rp;
+
+  /* is used for the loops. */
+  register ulong i;
+
+  if (memcmp (hp->magic, RESULT_MAGIC, sizeof (hp->magic))
+      || hp->word != RESULT_WORD || hp->size != size
+      || hp->key_len != cp->key_len || hp->path_len > size
+      || hp->recs != ALIGNED (ALIGNED (sizeof (RESULT_HEADER))
+                              + cp->key_len + hp->path_len)
+      || hp->recs > size
+      || hp->num_recs != (size - hp->recs) / sizeof (RESULT_RECORD)
+      || hp->size != hp->recs + hp->num_recs * sizeof (RESULT_RECORD)
+      || hp->num_recs > hp->num_match
+      || memcmp ((const char *) hp + ALIGNED (sizeof (RESULT_HEADER)),
+                 cp->key, cp->key_len))
+    return false;
+
+  /* the selected lines are in the file, one after the other. */
+  rp = (const RESULT_RECORD *) ((const char *) hp + hp->recs);
+  for (i = 0L; i < hp->num_recs; i++)
+    if (rp[i].off > hp->data_size || rp[i].len > hp->data_size - rp[i].off
+        || (i > 0 && rp[i].off < rp[i - 1].off + rp[i - 1].len))
+      return false;
+
+  return true;
+}
+
+/*!
+   \fn static BOOL write_part (FILE *, const void *, const size_t, const size_t)
+
+   \brief A function that writes a part of a cached result file.
+
+   This function writes `n' characters (`p') and then `pad' null
+   characters to the cached result file `fp'. If they can not be
+   written, it returns `false'.
+
+   \param fp a pointer to a `FILE' data structure.
+   \param p a pointer to a constant void.
+   \param n a constant `size_t' type definition.
+   \param pad a constant `size_t' type definition.
+
+   \return A `BOOL' enumeration value (`false', `true').
+*/
+static BOOL
+write_part (FILE * fp, const void *p, const size_t n, const size_t pad)
+{
+  /* the null characters of the padding. */
+  static const char zeros[sizeof (ulong)];
+
+  if ((n > 0 && fwrite (p, 1, n, fp) != n)
+      || (pad > 0 && fwrite (zeros, 1, pad, fp) != pad))
+    return false;
+
+  return true;
+}
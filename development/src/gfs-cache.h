@@ -0,0 +1,262 @@
+/*
+ *  `gfs-cache.h'.
+ *
+ *  This header contains the result cache structs and typedefs.
+ *
+ *  Copyright (C) 2008  Efstathios Chatzikyriakidis (stathis.chatzikyriakidis@gmail.com).
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*!
+   \file gfs-cache.h
+   \brief This header contains the result cache structs and typedefs.
+*/
+
+/*
+ * structure data types.
+ */
+
+/*!
+   \struct result_headerT
+   \brief Cached result file header data structure.
+
+   This data structure is the header of a cached result file (the
+   results of a search of a file). The key of the search follows it,
+   then the absolute path of the file (to prune the results of the
+   files which are gone), and then the records of its selected lines.
+   The offsets are from the start of the cached result file.
+*/
+struct result_headerT
+{
+  /*!
+     \var magic
+     \brief The magic characters (and the version).
+   */
+  char magic[8];
+
+  /*!
+     \var word
+     \brief A known number (the byte order and the word size).
+   */
+  ulong word;
+
+  /*!
+     \var dev
+     \brief The device of the searched file.
+   */
+  ulong dev;
+
+  /*!
+     \var ino
+     \brief The inode of the searched file.
+   */
+  ulong ino;
+
+  /*!
+     \var data_size
+     \brief The size of the searched file.
+   */
+  ulong data_size;
+
+  /*!
+     \var mtime
+     \brief The modification time of the searched file (seconds).
+   */
+  long mtime;
+
+  /*!
+     \var mtime_nsec
+     \brief The modification time of the searched file (nanoseconds).
+   */
+  long mtime_nsec;
+
+  /*!
+     \var num_match
+     \brief Number of the selected lines.
+   */
+  ulong num_match;
+
+  /*!
+     \var key_len
+     \brief The length of the key of the search.
+   */
+  ulong key_len;
+
+  /*!
+     \var path_len
+     \brief The length of the absolute path of the searched file.
+   */
+  ulong path_len;
+
+  /*!
+     \var num_recs
+     \brief Number of the records of the selected lines.
+   */
+  ulong num_recs;
+
+  /*!
+     \var recs
+     \brief The offset of the records.
+   */
+  ulong recs;
+
+  /*!
+     \var size
+     \brief The size of the cached result file.
+   */
+  ulong size;
+};
+
+/*!
+   \struct result_recordT
+   \brief Cached selected line data structure.
+
+   This data structure keeps a selected line of a searched file.
+*/
+struct result_recordT
+{
+  /*!
+     \var off
+     \brief The offset of the line in the file.
+   */
+  ulong off;
+
+  /*!
+     \var len
+     \brief The length of the line.
+   */
+  ulong len;
+
+  /*!
+     \var line
+     \brief The number of the line.
+   */
+  ulong line;
+};
+
+/*!
+   \struct result_cacheT
+   \brief Result cache data structure.
+
+   This data structure keeps the directory of the cached result
+   files and the key of the search of a run: the command line
+   options which change the selected lines, and the patterns.
+*/
+struct result_cacheT
+{
+  /*!
+     \var dir
+     \brief The directory of the cached result files.
+   */
+  char *dir;
+
+  /*!
+     \var key
+     \brief The key of the search.
+   */
+  uchar *key;
+
+  /*!
+     \var key_len
+     \brief The length of the key.
+   */
+  size_t key_len;
+
+  /*!
+     \var hash
+     \brief The hash of the key (in the names of the files).
+   */
+  ulong hash;
+};
+
+/*!
+   \struct cached_resultT
+   \brief Cached result data structure.
+
+   This data structure keeps a mapped cached result file of a file
+   which is not changed since.
+*/
+struct cached_resultT
+{
+  /*!
+     \var map
+     \brief The mapped cached result file.
+   */
+  void *map;
+
+  /*!
+     \var map_size
+     \brief The size of the mapped cached result file.
+   */
+  size_t map_size;
+
+  /*!
+     \var recs
+     \brief The records of the selected lines.
+   */
+  const struct result_recordT *recs;
+
+  /*!
+     \var num_recs
+     \brief Number of the records.
+   */
+  ulong num_recs;
+
+  /*!
+     \var num_match
+     \brief Number of the selected lines.
+   */
+  ulong num_match;
+};
+
+/*
+ * type definitions.
+ */
+
+/*!
+   \typedef RESULT_HEADER
+   \brief Cached result file header data structure type definition.
+
+   This type definition is a synonym for
+   the cached result file header data structure.
+*/
+typedef struct result_headerT RESULT_HEADER;
+
+/*!
+   \typedef RESULT_RECORD
+   \brief Cached selected line data structure type definition.
+
+   This type definition is a synonym for
+   the cached selected line data structure.
+*/
+typedef struct result_recordT RESULT_RECORD;
+
+/*!
+   \typedef RESULT_CACHE
+   \brief Result cache data structure type definition.
+
+   This type definition is a synonym for
+   the result cache data structure.
+*/
+typedef struct result_cacheT RESULT_CACHE;
+
+/*!
+   \typedef CACHED_RESULT
+   \brief Cached result data structure type definition.
+
+   This type definition is a synonym for
+   the cached result data structure.
+*/
+typedef struct cached_resultT CACHED_RESULT;
@@ -76,3 +76,21 @@
    order to print the tab space character.
 */
 #define TAB_SPACE "\t"
+
+/*!
+   \def MAX_JOBS
+   \brief Max number of jobs.
+
+   This define is used from the program in
+   order to limit the number of the jobs.
+*/
+#define MAX_JOBS 1024
+
+/*!
+   \def MAX_CONTEXT
+   \brief Max number of context lines.
+
+   This define is used from the program in order
+   to limit the lines around the selected lines.
+*/
+#define MAX_CONTEXT 1048576
@@ -30,9 +30,11 @@
 #include <stdlib.h>
 #include <string.h>
 #include <errno.h>
+#include <sys/types.h>
 
 /* basic includes. */
 #include "gfs-defines.h"
+#include "gfs-typedefs.h"
 #include "gfs-input-files-list.h"
 
 /* function prototypes. */
@@ -41,6 +43,7 @@ void weprintf (char *fmt, ...);
 FILE *efopen (const char *filepath, const char *mode);
 char *estrdup (const char *str);
 void *emalloc (size_t size);
+void *erealloc (void *ptr, size_t size);
 
 /* functions. */
 
@@ -217,6 +220,35 @@ emalloc (size_t size)
   return ptr;
 }
 
+/*!
+   \fn void * erealloc (void *, size_t)
+
+   \brief A function that reallocates memory space and checks for error.
+
+   This function tries to change the size of the memory space (`ptr')
+   to `size' bytes. If an error occur then prints an error message and
+   exits. Otherwise, returns the pointer of the first byte of the new
+   memory space.
+
+   \param ptr a pointer to void.
+   \param size a `size_t' type definition.
+
+   \return A pointer to void.
+*/
+void *
+erealloc (void *ptr, size_t size)
+{
+  /* reallocate enough memory space. */
+  void *tmp = realloc (ptr, size);
+
+  /* if memory reallocation fail. */
+  if (tmp == NULL && size != 0)
+    eprintf ("realloc(%lu) failed:", (ulong) size);
+
+  /* return the pointer. */
+  return tmp;
+}
+
 /*!
    \fn FILE * efopen (const char *, const char *)
 
@@ -0,0 +1,2664 @@
+/*
+ *  `gfs-index.c'.
+ *
+ *  This interface deals with the trigram index.
+ *
+ *  Copyright (C) 2008  Efstathios Chatzikyriakidis (stathis.chatzikyriakidis@gmail.com).
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*!
+   \file gfs-index.c
+   \brief This interface deals with the trigram index.
+*/
+
+/* standard includes. */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <errno.h>
+#include <limits.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <pthread.h>
+#include <libintl.h>
+
+/* basic includes. */
+#include "gfs-defines.h"
+#include "gfs-i18n-macros.h"
+#include "gfs-typedefs.h"
+#include "gfs-input-files-list.h"
+#include "gfs-walk.h"
+#include "gfs-index.h"
+
+/* enumeration constants. */
+
+/*!
+   \brief Constants used from the interface.
+
+   This anonymous enumeration is used from the
+   interface in order to specify some constants.
+*/
+enum
+{
+  GRAM_MASK = 0xFFFFFF,         /*!< The bits of a trigram. */
+  FILTER_BLOCK = 1024 * 1024,   /*!< Min characters of a filtered block (1Mbyte). */
+  BLOOM_BITS = 8,               /*!< The bits of a Bloom filter per trigram. */
+  BLOOM_HASHES = 4,             /*!< The bits of a trigram in a Bloom filter. */
+  MIN_FILTER = 8,               /*!< The min characters of a Bloom filter. */
+  INDEX_BLOCK = 1024 * 1024,    /*!< Read block characters (1Mbyte). */
+  INDEX_BINARY = 1,             /*!< The flag of a binary file. */
+  INDEX_WALKERS = 4,            /*!< Max directory walker threads. */
+  MIN_TABLE = 16,               /*!< The min size of a hash table. */
+  MIN_APPENDED = 4096,          /*!< Min size of a file read from its old end. */
+  VARINT_BYTES = 10             /*!< The max bytes of a variable length number. */
+};
+
+/*!
+   \def INDEX_MAGIC
+   \brief The magic characters of an index file.
+
+   The null character makes an index file binary,
+   so it is never searched as an input file.
+*/
+#define INDEX_MAGIC "GFS\0IDX2"
+
+/*!
+   \def SIDECAR_MAGIC
+   \brief The magic characters of a block filters file.
+*/
+#define SIDECAR_MAGIC "GFS\0BLK1"
+
+/*!
+   \def INDEX_WORD
+   \brief The known number of the header of an index file.
+*/
+#define INDEX_WORD 0x01020304UL
+
+/*!
+   \def INDEX_NAME
+   \brief The default name of an index file (in its directory).
+*/
+#define INDEX_NAME ".gfs-index"
+
+/*!
+   \def SIDECAR_NAME
+   \brief The suffix of a block filters file (after the path of its file).
+*/
+#define SIDECAR_NAME ".gfs-blocks"
+
+/*!
+   \def INDEX_TEMP
+   \brief The suffix of an index file which is written.
+*/
+#define INDEX_TEMP ".tmp"
+
+/*
+ * structure data types.
+ */
+
+/*!
+   \struct gram_listT
+   \brief Trigram posting list data structure.
+
+   This data structure keeps the posting list of a trigram
+   while the index is built (as the bytes of the index file).
+*/
+struct gram_listT
+{
+  /*!
+     \var gram
+     \brief The trigram.
+   */
+  uint gram;
+
+  /*!
+     \var count
+     \brief The number of the files of the list.
+   */
+  uint count;
+
+  /*!
+     \var last
+     \brief The last file of the list.
+   */
+  ulong last;
+
+  /*!
+     \var bytes
+     \brief The deltas of the files (variable length bytes).
+   */
+  uchar *bytes;
+
+  /*!
+     \var len
+     \brief The length of the bytes.
+   */
+  size_t len;
+
+  /*!
+     \var room
+     \brief The room of the bytes.
+   */
+  size_t room;
+};
+
+/*!
+   \struct index_builderT
+   \brief Index builder data structure.
+
+   This data structure keeps the files and the posting lists
+   of an index which is built. The posting lists are found by
+   their trigrams through an open addressing hash table.
+*/
+struct index_builderT
+{
+  /*!
+     \var files
+     \brief The indexed files.
+   */
+  INDEX_FILE *files;
+
+  /*!
+     \var num_files
+     \brief The number of the indexed files.
+   */
+  ulong num_files;
+
+  /*!
+     \var max_files
+     \brief The room of the indexed files.
+   */
+  ulong max_files;
+
+  /*!
+     \var paths
+     \brief The paths of the files (null terminated).
+   */
+  char *paths;
+
+  /*!
+     \var paths_len
+     \brief The length of the paths.
+   */
+  size_t paths_len;
+
+  /*!
+     \var paths_room
+     \brief The room of the paths.
+   */
+  size_t paths_room;
+
+  /*!
+     \var lists
+     \brief The posting lists.
+   */
+  struct gram_listT *lists;
+
+  /*!
+     \var num_lists
+     \brief The number of the posting lists.
+   */
+  ulong num_lists;
+
+  /*!
+     \var max_lists
+     \brief The room of the posting lists.
+   */
+  ulong max_lists;
+
+  /*!
+     \var slots
+     \brief The hash table of the posting lists (list + 1, 0 if empty).
+   */
+  uint *slots;
+
+  /*!
+     \var num_slots
+     \brief The size of the hash table (a power of two).
+   */
+  ulong num_slots;
+
+  /*!
+     \var shift
+     \brief The shift of the hash of a trigram.
+   */
+  uint shift;
+
+  /*!
+     \var seen
+     \brief The trigrams of the current file (a bitmap).
+   */
+  uchar *seen;
+
+  /*!
+     \var found
+     \brief The trigrams of the current file (a list).
+   */
+  uint *found;
+
+  /*!
+     \var num_found
+     \brief The number of the trigrams of the current file.
+   */
+  ulong num_found;
+
+  /*!
+     \var max_found
+     \brief The room of the trigrams of the current file.
+   */
+  ulong max_found;
+
+  /*!
+     \var buf
+     \brief The read block.
+   */
+  uchar *buf;
+};
+
+/*
+ * type definitions.
+ */
+
+/*!
+   \typedef GRAM_LIST
+   \brief Trigram posting list data structure type definition.
+*/
+typedef struct gram_listT GRAM_LIST;
+
+/*!
+   \typedef INDEX_BUILDER
+   \brief Index builder data structure type definition.
+*/
+typedef struct index_builderT INDEX_BUILDER;
+
+/* function prototypes. */
+int index_command (cint argc, char *argv[]);
+void build_index (const char *dir, const char *path, const INDEX * old);
+INDEX *open_index (const char *path);
+void free_index (INDEX * ip);
+void index_select (INDEX * ip, char *const *strs, const size_t * lens,
+                   const ulong num, const BOOL fold);
+BOOL index_skips (const INDEX * ip, const INPUT_FILE * node);
+void build_sidecar (const char *path);
+SIDECAR *open_sidecar (const char *path, const INPUT_FILE * node);
+void free_sidecar (SIDECAR * scp);
+void sidecar_select (SIDECAR * scp, char *const *strs, const size_t * lens,
+                     const ulong num, const BOOL fold);
+ulong fnv_hash (const uchar * p, const size_t n);
+static ulong fnv_more (ulong hash, const uchar * p, const size_t n);
+static void add_file (INDEX_BUILDER * bp, const char *path,
+                      const INDEX * old, ulong * remap);
+static BOOL read_grams (INDEX_BUILDER * bp, const int fd, const char *path,
+                        off_t from, const off_t to, ulong * flags,
+                        ulong * hash);
+static void collect_grams (INDEX_BUILDER * bp, const uchar * p,
+                           const size_t n, uint * gram, ulong * run);
+static BOOL read_hash (INDEX_BUILDER * bp, const int fd, off_t from,
+                       const off_t to, ulong * hash);
+static void add_posting (INDEX_BUILDER * bp, const uint gram,
+                         const ulong file);
+static void append_posting (GRAM_LIST * lp, const ulong file);
+static GRAM_LIST *find_list (INDEX_BUILDER * bp, const uint gram);
+static void merge_index (INDEX_BUILDER * bp, const INDEX * old,
+                         const char *path, const ulong * remap);
+static void write_index (INDEX_BUILDER * bp, const char *path);
+static FILE *create_temp (const char *path, char **temp);
+static void commit_temp (FILE * fp, char *temp, const char *path);
+static void write_section (FILE * fp, const char *path, const void *p,
+                           const size_t n, const size_t pad);
+static char *sidecar_name (const char *path);
+static void bloom_add (uchar * filter, const ulong bits, const uint gram);
+static BOOL bloom_test (const uchar * filter, const ulong bits,
+                        const uint gram);
+static void fold_skips (uchar * skip, const BOOL fold);
+static ulong string_grams (const uchar * str, const size_t len,
+                           const uchar * skip, const BOOL fold,
+                           uint * grams);
+static ulong select_string (INDEX * ip, const uchar * str, const size_t len,
+                            const uchar * skip, const BOOL fold,
+                            uint * grams, ulong * ids);
+static ulong decode_list (const INDEX * ip, const INDEX_GRAM * gp,
+                          ulong * ids);
+static BOOL list_bytes (const INDEX * ip, const INDEX_GRAM * gp,
+                        const uchar ** p, const uchar ** end);
+static const uchar *read_varint (const uchar * p, const uchar * end,
+                                 ulong * value);
+static const INDEX_GRAM *find_gram (const INDEX * ip, const uint gram);
+static ulong find_file (const INDEX * ip, const ulong dev, const ulong ino);
+static uint identity_hash (const ulong dev, const ulong ino);
+static int compare_lists (const void *a, const void *b);
+static int compare_grams (const void *a, const void *b);
+static int compare_counts (const void *a, const void *b);
+static int compare_ids (const void *a, const void *b);
+
+/* the lowercase of the ascii letters (the folding of the trigrams). */
+#define ASCII_LOWER(c) ((c) >= 'A' && (c) <= 'Z' ? (c) - 'A' + 'a' : (c))
+
+/* the length of a section aligned to a long integer. */
+#define ALIGNED(n) (((n) + sizeof (ulong) - 1) / sizeof (ulong) * sizeof (ulong))
+
+/* functions. */
+
+/*!
+   \fn int index_command (cint, char *[])
+
+   \brief A function that runs an index command.
+
+   This function runs the index command of the command line arguments
+   (`argc' and `argv', which start from the `index' word). The command
+   `build DIR [INDEX]' indexes the regular files under the directory
+   DIR into the index file INDEX (by default, `.gfs-index' in DIR).
+   The command `update DIR [INDEX]' does the same, but it reads only
+   the files which are new or changed since INDEX was written (it
+   builds INDEX if it does not exist). The command `blocks FILE...'
+   writes the block filters of each FILE (in `FILE.gfs-blocks'). If
+   the command is not valid, it exits. At the end, it returns the
+   exit status.
+
+   \param argc a constant integer value.
+   \param argv an array of pointers to a character.
+
+   \return An integer exit status value.
+*/
+int
+index_command (cint argc, char *argv[])
+{
+  /* externs. */
+
+  /* function externs. */
+  extern void *emalloc (size_t);
+  extern char *estrdup (const char *);
+  extern void eprintf (char *, ...);
+
+  /* variable externs. */
+  extern cstring usage_index_command;
+
+  /* the path of the index file. */
+  char *path;
+
+  /* the index file which is updated. */
+  INDEX *old = NULL;
+
+  /* the length of the directory. */
+  size_t len;
+
+  /* is it an update? */
+  BOOL update;
+
+  /* is used for the loops. */
+  register int i;
+
+  /* the block filters of the files. */
+  if (argc >= 3 && !strcmp (argv[1], "blocks"))
+    {
+      for (i = 2; i < argc; i++)
+        build_sidecar (argv[i]);
+      return EXIT_SUCCESS;
+    }
+
+  if (argc < 3 || argc > 4
+      || (strcmp (argv[1], "build") && strcmp (argv[1], "update")))
+    eprintf ("%s", _(usage_index_command));
+
+  update = strcmp (argv[1], "update") ? false : true;
+
+  /* the index file of the directory. */
+  if (argc == 4)
+    path = estrdup (argv[3]);
+  else
+    {
+      len = strlen (argv[2]);
+      path = (char *) emalloc (len + sizeof (INDEX_NAME) + 1);
+      memcpy (path, argv[2], len);
+      if (len == 0 || argv[2][len - 1] != '/')
+        path[len++] = '/';
+      memcpy (path + len, INDEX_NAME, sizeof (INDEX_NAME));
+    }
+
+  /* a missing index file is built. */
+  if (update && access (path, F_OK) == 0)
+    old = open_index (path);
+
+  build_index (argv[2], path, old);
+  free_index (old);
+  free (path);
+
+  return EXIT_SUCCESS;
+}
+
+/*!
+   \fn void build_index (const char *, const char *, const INDEX *)
+
+   \brief A function that builds the index of a directory.
+
+   This function indexes the regular files under the directory `dir'
+   (in the order of its walk) into the index file `path'. Each file
+   is read once: its distinct trigrams (the ascii letters are folded
+   to lowercase, and the trigrams which cross a new line are left
+   out) are appended to their posting lists. A binary file has no
+   trigrams. If `old' is not NULL, then it is the previous index of
+   the directory, and its posting lists are kept for the files which
+   are found in it (by identity) and are not changed, or are only
+   appended (then only the appended characters are read). The index
+   file is written aside and renamed at the end, so a search never
+   maps a partial index. If the index can not be written, it exits.
+
+   \param dir a pointer to a constant character.
+   \param path a pointer to a constant character.
+   \param old a pointer to a constant `INDEX' data structure.
+*/
+void
+build_index (const char *dir, const char *path, const INDEX * old)
+{
+  /* externs. */
+
+  /* function externs. */
+  extern void *emalloc (size_t);
+  extern void eprintf (char *, ...);
+  extern ulong default_num_jobs (void);
+  extern WALK *new_walk (const char *, const ulong);
+  extern void free_walk (WALK *);
+  extern char *walk_next (WALK *);
+
+  /* variable externs. */
+  extern cstring usage_not_directory;
+
+  /* the builder of the index. */
+  INDEX_BUILDER b;
+
+  /* the walk of the directory. */
+  WALK *walk;
+  char *file;
+
+  /* the info of the directory. */
+  struct stat stbuf;
+
+  /* the number of the walker threads. */
+  ulong num_walkers = default_num_jobs ();
+
+  /* the files of the old index in the new one (ULONG_MAX if none). */
+  ulong *remap = NULL;
+
+  /* is used for the loops. */
+  register ulong i;
+
+  if (stat (dir, &stbuf) == -1)
+    eprintf ("stat(\"%.500s\") failed:", dir);
+  if (!S_ISDIR (stbuf.st_mode))
+    eprintf (_(usage_not_directory), dir);
+
+  b.files = NULL;
+  b.num_files = b.max_files = 0L;
+  b.paths = NULL;
+  b.paths_len = b.paths_room = 0;
+  b.lists = NULL;
+  b.num_lists = b.max_lists = 0L;
+  b.num_slots = MIN_TABLE;
+  b.shift = 32 - 4;
+  b.slots = (uint *) emalloc (b.num_slots * sizeof (uint));
+  memset (b.slots, 0, b.num_slots * sizeof (uint));
+  b.seen = (uchar *) emalloc ((GRAM_MASK + 1) / CHAR_BIT);
+  memset (b.seen, 0, (GRAM_MASK + 1) / CHAR_BIT);
+  b.found = NULL;
+  b.num_found = b.max_found = 0L;
+  b.buf = (uchar *) emalloc (INDEX_BLOCK);
+
+  if (old != NULL)
+    {
+      remap = (ulong *) emalloc ((old->header->num_files + 1)
+                                 * sizeof (ulong));
+      for (i = 0L; i < old->header->num_files; i++)
+        remap[i] = ULONG_MAX;
+    }
+
+  /* index the files of the walk. */
+  walk = new_walk (dir, (num_walkers < INDEX_WALKERS ? num_walkers
+                         : INDEX_WALKERS));
+  while ((file = walk_next (walk)) != NULL)
+    {
+      add_file (&b, file, old, remap);
+      free (file);
+    }
+  free_walk (walk);
+
+  /* the kept files join the lists of the read ones. */
+  if (old != NULL)
+    merge_index (&b, old, path, remap);
+
+  write_index (&b, path);
+
+  /* release the builder. */
+  for (i = 0L; i < b.num_lists; i++)
+    free (b.lists[i].bytes);
+  free (b.lists);
+  free (b.slots);
+  free (b.files);
+  free (b.paths);
+  free (b.seen);
+  free (b.found);
+  free (b.buf);
+  free (remap);
+}
+
+/*!
+   \fn INDEX * open_index (const char *)
+
+   \brief A function that opens an index file.
+
+   This function maps the index file `path' in memory and checks
+   its header and its sections. Every file is a candidate, until
+   the candidates are selected. If the index file can not be
+   opened or it is not valid, it exits.
+
+   \param path a pointer to a constant character.
+
+   \return A pointer to a `INDEX' data structure.
+*/
+INDEX *
+open_index (const char *path)
+{
+  /* externs. */
+
+  /* function externs. */
+  extern void *emalloc (size_t);
+  extern void eprintf (char *, ...);
+
+  /* variable externs. */
+  extern cstring usage_invalid_index;
+
+  INDEX *newp;
+
+  /* the index file. */
+  int fd;
+  struct stat stbuf;
+
+  /* the header of the index file. */
+  const INDEX_HEADER *hp;
+
+  /* the sizes of the sections. */
+  size_t size, n;
+
+  /* is used for the loops. */
+  register ulong i;
+
+  if ((fd = open (path, O_RDONLY | O_NOCTTY)) == -1)
+    eprintf ("open(\"%.500s\") failed:", path);
+  if (fstat (fd, &stbuf) == -1)
+    eprintf ("fstat(\"%.500s\") failed:", path);
+
+  size = (size_t) stbuf.st_size;
+  if (!S_ISREG (stbuf.st_mode) || stbuf.st_size < (off_t) sizeof (INDEX_HEADER)
+      || (off_t) size != stbuf.st_size)
+    eprintf (_(usage_invalid_index), path);
+
+  /* allocate enough memory space. */
+  newp = (INDEX *) emalloc (sizeof (INDEX));
+
+  newp->map = mmap (NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  if (newp->map == MAP_FAILED)
+    eprintf ("mmap(\"%.500s\") failed:", path);
+  close (fd);
+
+  newp->map_size = size;
+  newp->header = hp = (const INDEX_HEADER *) newp->map;
+
+  /* check the header and the bounds of the sections. */
+  if (memcmp (hp->magic, INDEX_MAGIC, sizeof (hp->magic))
+      || hp->word != INDEX_WORD || hp->size != size
+      || hp->files != ALIGNED (sizeof (INDEX_HEADER))
+      || hp->num_files > (size / sizeof (INDEX_FILE))
+      || hp->table != ALIGNED (hp->files + hp->num_files
+                               * sizeof (INDEX_FILE))
+      || hp->table_size > size / sizeof (uint)
+      || hp->table_size < MIN_TABLE
+      || (hp->table_size & (hp->table_size - 1)) != 0
+      || hp->num_files >= hp->table_size
+      || hp->grams != ALIGNED (hp->table + hp->table_size * sizeof (uint))
+      || hp->num_grams >= size / sizeof (INDEX_GRAM)
+      || hp->paths > size || hp->paths < hp->grams
+      || hp->paths - hp->grams < (hp->num_grams + 1) * sizeof (INDEX_GRAM)
+      || hp->postings > size || hp->postings < hp->paths)
+    eprintf (_(usage_invalid_index), path);
+
+  newp->files = (const INDEX_FILE *) ((const char *) newp->map + hp->files);
+  newp->table = (const uint *) ((const char *) newp->map + hp->table);
+  newp->grams = (const INDEX_GRAM *) ((const char *) newp->map + hp->grams);
+  newp->paths = (const char *) newp->map + hp->paths;
+  newp->postings = (const uchar *) newp->map + hp->postings;
+
+  /* the paths end in their section. */
+  n = hp->postings - hp->paths;
+  if (n > 0 && newp->paths[n - 1] != '\0')
+    eprintf (_(usage_invalid_index), path);
+  for (i = 0L; i < hp->num_files; i++)
+    if (newp->files[i].path >= n)
+      eprintf (_(usage_invalid_index), path);
+
+  newp->candidates = (uchar *) emalloc (hp->num_files + 1);
+  memset (newp->candidates, 1, hp->num_files + 1);
+
+  /* return the index pointer. */
+  return newp;
+}
+
+/*!
+   \fn void free_index (INDEX *)
+
+   \brief A function that deallocates a `INDEX' data structure.
+
+   \param ip a pointer to a `INDEX' data structure.
+*/
+void
+free_index (INDEX * ip)
+{
+  if (ip == NULL)
+    return;
+
+  munmap (ip->map, ip->map_size);
+  free (ip->candidates);
+  free (ip);
+}
+
+/*!
+   \fn void index_select (INDEX *, char *const *, const size_t *, const ulong, const BOOL)
+
+   \brief A function that selects the candidate files of an index.
+
+   This function selects the candidate files of the index (`ip') for
+   the `num' strings (`strs' with lengths `lens'), one of which any
+   matching line contains: a file is a candidate if it contains all
+   the trigrams of one of the strings. The posting lists of the
+   trigrams of a string are intersected from the shortest one. If
+   `fold' is `true', then the case distinctions of the strings are
+   ignored (a trigram is used only if the lowercase of each of its
+   characters comes from characters which fold to it in the index
+   too). If a string has no usable trigram (or there are no
+   strings), then every file is a candidate.
+
+   \param ip a pointer to a `INDEX' data structure.
+   \param strs a pointer to a constant pointer to a character.
+   \param lens a pointer to a constant `size_t' type definition.
+   \param num a constant unsigned long integer.
+   \param fold a constant `BOOL' enumeration value.
+*/
+void
+index_select (INDEX * ip, char *const *strs, const size_t * lens,
+              const ulong num, const BOOL fold)
+{
+  /* externs. */
+
+  /* function externs. */
+  extern void *emalloc (size_t);
+
+  /* the characters which can not be used in a trigram. */
+  uchar skip[UCHAR_MAX + 1];
+
+  /* the trigrams of a string and the files of its lists. */
+  uint *grams;
+  ulong *ids;
+
+  /* the longest string. */
+  size_t max_len = 0;
+
+  /* the number of the files of a string. */
+  ulong n;
+
+  /* is used for the loops. */
+  register ulong i, j;
+
+  const ulong num_files = ip->header->num_files;
+
+  memset (ip->candidates, 1, num_files + 1);
+  if (num == 0)
+    return;
+
+  fold_skips (skip, fold);
+
+  for (i = 0L; i < num; i++)
+    if (lens[i] > max_len)
+      max_len = lens[i];
+
+  grams = (uint *) emalloc ((max_len + 1) * sizeof (uint));
+  ids = (ulong *) emalloc ((num_files + 1) * sizeof (ulong));
+
+  memset (ip->candidates, 0, num_files + 1);
+  for (i = 0L; i < num; i++)
+    {
+      n = select_string (ip, (const uchar *) strs[i], lens[i], skip, fold,
+                         grams, ids);
+
+      /* the string can be anywhere. */
+      if (n == ULONG_MAX)
+        {
+          memset (ip->candidates, 1, num_files + 1);
+          break;
+        }
+
+      for (j = 0L; j < n; j++)
+        ip->candidates[ids[j]] = 1;
+    }
+
+  free (grams);
+  free (ids);
+}
+
+/*!
+   \fn BOOL index_skips (const INDEX *, const INPUT_FILE *)
+
+   \brief A function that checks if an input file can be skipped.
+
+   This function returns `true' if the open input file `node' is in
+   the index (`ip') by its identity (the device and the inode), it
+   is not changed since it was indexed (the same size and modification
+   time), and it is not a candidate (so it has no match). Otherwise,
+   it returns `false' and the input file is searched (so a file which
+   is changed after an update is never skipped by a stale entry).
+
+   \param ip a pointer to a constant `INDEX' data structure.
+   \param node a pointer to a constant `INPUT_FILE' data structure.
+
+   \return A `BOOL' enumeration value (`false', `true').
+*/
+BOOL
+index_skips (const INDEX * ip, const INPUT_FILE * node)
+{
+  /* the indexed file. */
+  const ulong id = find_file (ip, (ulong) node->dev, (ulong) node->ino);
+  const INDEX_FILE *fp;
+
+  if (id == ULONG_MAX)
+    return false;
+
+  fp = &ip->files[id];
+
+  return (!ip->candidates[id] && !(fp->flags & INDEX_BINARY)
+          && (off_t) fp->size == node->size
+          && fp->mtime == node->mtime
+          && fp->mtime_nsec == node->mtime_nsec) ? true : false;
+}
+
+/*!
+   \fn void build_sidecar (const char *)
+
+   \brief A function that writes the block filters of a file.
+
+   This function cuts the regular file `path' in blocks (of at least
+   FILTER_BLOCK characters, which end at a new line) and writes the
+   block filters file `path.gfs-blocks': for each block, its start,
+   the number of the new lines before it, and a Bloom filter of its
+   distinct trigrams (of about BLOOM_BITS bits per trigram). If the
+   sidecar of the file is up to date, it is kept, and else the whole
+   file is read again (a file which is larger since may be changed
+   before its old end too). The file is mapped in memory (and read
+   once). If the sidecar can not be written, it exits.
+
+   \param path a pointer to a constant character.
+*/
+void
+build_sidecar (const char *path)
+{
+  /* externs. */
+
+  /* function externs. */
+  extern void *emalloc (size_t);
+  extern void *erealloc (void *, size_t);
+  extern void eprintf (char *, ...);
+
+  /* variable externs. */
+  extern cstring usage_not_regular;
+
+  /* the collector of the trigrams of a block. */
+  INDEX_BUILDER b;
+
+  /* the file and its contents. */
+  int fd;
+  struct stat stbuf;
+  INPUT_FILE node;
+  void *map = NULL;
+  const uchar *data;
+  size_t size;
+
+  /* the old sidecar of the file. */
+  SIDECAR *old;
+
+  /* the sidecar which is written. */
+  SIDECAR_HEADER h;
+  SIDECAR_BLOCK *blocks = NULL;
+  ulong num_blocks = 0L, max_blocks = 0L;
+  uchar *filters = NULL;
+  size_t filters_len = 0, filters_room = 0;
+  char *name, *temp;
+  FILE *fp;
+
+  /* the current block and the new lines before it. */
+  const uchar *p, *end, *nl;
+  ulong lines = 0L;
+
+  /* the current trigram and the characters of the current line. */
+  uint gram;
+  ulong run;
+
+  /* the bits of a Bloom filter. */
+  size_t bytes;
+
+  /* is used for the loops. */
+  register ulong k;
+
+  if ((fd = open (path, O_RDONLY | O_NOCTTY)) == -1)
+    eprintf ("open(\"%.500s\") failed:", path);
+  if (fstat (fd, &stbuf) == -1)
+    eprintf ("fstat(\"%.500s\") failed:", path);
+
+  size = (size_t) stbuf.st_size;
+  if (!S_ISREG (stbuf.st_mode) || (off_t) size != stbuf.st_size)
+    eprintf (_(usage_not_regular), path);
+
+  node.fd = -1;
+  node.path = NULL;
+  node.size = stbuf.st_size;
+  node.dev = stbuf.st_dev;
+  node.ino = stbuf.st_ino;
+  node.mtime = (long) stbuf.st_mtim.tv_sec;
+  node.mtime_nsec = stbuf.st_mtim.tv_nsec;
+
+  /* an up to date sidecar is kept as it is. */
+  if ((old = open_sidecar (path, &node)) != NULL)
+    {
+      free_sidecar (old);
+      close (fd);
+      return;
+    }
+
+  /* the file is read once, in order. */
+  if (size > 0)
+    {
+      map = mmap (NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (map == MAP_FAILED)
+        eprintf ("mmap(\"%.500s\") failed:", path);
+      madvise (map, size, MADV_SEQUENTIAL);
+    }
+  close (fd);
+  data = (const uchar *) map;
+
+  p = data;
+  end = data + size;
+
+  b.seen = (uchar *) emalloc ((GRAM_MASK + 1) / CHAR_BIT);
+  memset (b.seen, 0, (GRAM_MASK + 1) / CHAR_BIT);
+  b.found = NULL;
+  b.num_found = b.max_found = 0L;
+
+  for (; p < end; p = nl)
+    {
+      /* the block ends at the first new line after its size. */
+      nl = ((size_t) (end - p) > FILTER_BLOCK ? p + FILTER_BLOCK : end);
+      if (nl < end
+          && (nl = (const uchar *) memchr (nl, '\n', (size_t) (end - nl)))
+          != NULL)
+        ++nl;
+      else
+        nl = end;
+
+      if (num_blocks == max_blocks)
+        {
+          max_blocks = (max_blocks ? 2 * max_blocks : 1024L);
+          blocks = (SIDECAR_BLOCK *) erealloc (blocks, (max_blocks + 1)
+                                               * sizeof (SIDECAR_BLOCK));
+        }
+
+      /* the trigrams of the block (its lines are whole). */
+      b.num_found = 0L;
+      gram = 0;
+      run = 0L;
+      collect_grams (&b, p, (size_t) (nl - p), &gram, &run);
+
+      bytes = (b.num_found * BLOOM_BITS + CHAR_BIT - 1) / CHAR_BIT;
+      bytes = ALIGNED (bytes < MIN_FILTER ? MIN_FILTER : bytes);
+      while (filters_len + bytes > filters_room)
+        {
+          filters_room = (filters_room ? 2 * filters_room : 65536);
+          filters = (uchar *) erealloc (filters, filters_room);
+        }
+      memset (filters + filters_len, 0, bytes);
+
+      for (k = 0L; k < b.num_found; k++)
+        {
+          bloom_add (filters + filters_len, (ulong) bytes * CHAR_BIT,
+                     b.found[k]);
+          b.seen[b.found[k] / CHAR_BIT] = 0;
+        }
+
+      blocks[num_blocks].start = (ulong) (p - data);
+      blocks[num_blocks].lines = lines;
+      blocks[num_blocks].filter = (ulong) filters_len;
+      num_blocks++;
+      filters_len += bytes;
+
+      /* the new lines of the block. */
+      for (; p < nl && (p = (const uchar *) memchr (p, '\n',
+                                                    (size_t) (nl - p)))
+           != NULL; p++)
+        lines++;
+    }
+
+  /* the sentinel. */
+  if (blocks == NULL)
+    blocks = (SIDECAR_BLOCK *) emalloc (sizeof (SIDECAR_BLOCK));
+  blocks[num_blocks].start = (ulong) size;
+  blocks[num_blocks].lines = lines;
+  blocks[num_blocks].filter = (ulong) filters_len;
+
+  /* the header. */
+  memset (&h, 0, sizeof (h));
+  memcpy (h.magic, SIDECAR_MAGIC, sizeof (h.magic));
+  h.word = INDEX_WORD;
+  h.dev = (ulong) node.dev;
+  h.ino = (ulong) node.ino;
+  h.data_size = (ulong) size;
+  h.mtime = node.mtime;
+  h.mtime_nsec = node.mtime_nsec;
+  h.num_blocks = num_blocks;
+  h.blocks = ALIGNED (sizeof (SIDECAR_HEADER));
+  h.filters = h.blocks + (num_blocks + 1) * sizeof (SIDECAR_BLOCK);
+  h.size = h.filters + filters_len;
+
+  /* write the sidecar aside. */
+  name = sidecar_name (path);
+  fp = create_temp (name, &temp);
+
+  write_section (fp, temp, &h, sizeof (h), h.blocks - sizeof (h));
+  write_section (fp, temp, blocks, (num_blocks + 1)
+                 * sizeof (SIDECAR_BLOCK), 0);
+  write_section (fp, temp, filters, filters_len, 0);
+
+  commit_temp (fp, temp, name);
+
+  if (map != NULL)
+    munmap (map, size);
+
+  free (name);
+  free (blocks);
+  free (filters);
+  free (b.seen);
+  free (b.found);
+}
+
+/*!
+   \fn SIDECAR * open_sidecar (const char *, const INPUT_FILE *)
+
+   \brief A function that opens the block filters of a file.
+
+   This function maps the block filters file of the open regular
+   input file `node' (of the path `path') in memory, if there is
+   one, and checks it. The sidecar is used only if it is of the same
+   file (the device and the inode) and the file is not changed since
+   (the same size and modification time), so any other file is read
+   whole. Every block is admitted, until the blocks are selected. If
+   there is no usable sidecar, it returns NULL (and if it is not
+   valid, it warns).
+
+   \param path a pointer to a constant character.
+   \param node a pointer to a constant `INPUT_FILE' data structure.
+
+   \return A pointer to a `SIDECAR' data structure.
+*/
+SIDECAR *
+open_sidecar (const char *path, const INPUT_FILE * node)
+{
+  /* externs. */
+
+  /* function externs. */
+  extern void *emalloc (size_t);
+  extern void weprintf (char *, ...);
+
+  /* variable externs. */
+  extern cstring usage_invalid_index;
+
+  SIDECAR *newp;
+
+  /* the block filters file. */
+  char *name = sidecar_name (path);
+  int fd;
+  struct stat stbuf;
+  void *map;
+
+  /* the header and the blocks of the block filters file. */
+  const SIDECAR_HEADER *hp;
+  const SIDECAR_BLOCK *bp;
+
+  /* the size of the sidecar. */
+  size_t size;
+
+  /* the number of the filtered blocks of the file. */
+  ulong num = ULONG_MAX;
+
+  /* is used for the loops. */
+  register ulong i;
+
+  if ((fd = open (name, O_RDONLY | O_NOCTTY)) == -1)
+    {
+      free (name);
+      return NULL;
+    }
+
+  size = (size_t) 0;
+  if (fstat (fd, &stbuf) == 0 && S_ISREG (stbuf.st_mode)
+      && stbuf.st_size >= (off_t) sizeof (SIDECAR_HEADER)
+      && (off_t) (size_t) stbuf.st_size == stbuf.st_size)
+    size = (size_t) stbuf.st_size;
+
+  map = (size > 0 ? mmap (NULL, size, PROT_READ, MAP_PRIVATE, fd, 0)
+         : MAP_FAILED);
+  close (fd);
+
+  if (map == MAP_FAILED)
+    {
+      weprintf (_(usage_invalid_index), name);
+      free (name);
+      return NULL;
+    }
+
+  hp = (const SIDECAR_HEADER *) map;
+  bp = (const SIDECAR_BLOCK *) ((const char *) map + hp->blocks);
+
+  /* check the header and the bounds of the sections. */
+  if (memcmp (hp->magic, SIDECAR_MAGIC, sizeof (hp->magic))
+      || hp->word != INDEX_WORD || hp->size != size
+      || hp->blocks != ALIGNED (sizeof (SIDECAR_HEADER))
+      || hp->num_blocks >= size / sizeof (SIDECAR_BLOCK)
+      || hp->filters != hp->blocks + (hp->num_blocks + 1)
+      * sizeof (SIDECAR_BLOCK) || hp->filters > size
+      || bp[hp->num_blocks].start != hp->data_size
+      || bp[hp->num_blocks].filter != size - hp->filters)
+    i = ULONG_MAX;
+  else
+    /* the blocks go on, and each one has a filter. */
+    for (i = 0L; i < hp->num_blocks; i++)
+      if (bp[i].start >= bp[i + 1].start || bp[i].lines > bp[i + 1].lines
+          || bp[i].filter > bp[i + 1].filter
+          || bp[i + 1].filter - bp[i].filter < MIN_FILTER)
+        {
+          i = ULONG_MAX;
+          break;
+        }
+
+  if (i == ULONG_MAX)
+    weprintf (_(usage_invalid_index), name);
+
+  /* the sidecar of the same file, not changed since. */
+  else if (hp->dev == (ulong) node->dev && hp->ino == (ulong) node->ino
+           && (off_t) hp->data_size == node->size
+           && hp->mtime == node->mtime && hp->mtime_nsec == node->mtime_nsec)
+    num = hp->num_blocks;
+
+  free (name);
+
+  if (num == ULONG_MAX)
+    {
+      munmap (map, size);
+      return NULL;
+    }
+
+  /* allocate enough memory space. */
+  newp = (SIDECAR *) emalloc (sizeof (SIDECAR));
+
+  newp->map = map;
+  newp->map_size = size;
+  newp->header = hp;
+  newp->blocks = bp;
+  newp->filters = (const uchar *) map + hp->filters;
+  newp->num_blocks = num;
+
+  /* the sentinel (the end of the file) is never admitted. */
+  newp->admitted = (uchar *) emalloc (num + 1);
+  memset (newp->admitted, 1, num);
+  newp->admitted[num] = 0;
+
+  /* return the sidecar pointer. */
+  return newp;
+}
+
+/*!
+   \fn void free_sidecar (SIDECAR *)
+
+   \brief A function that deallocates a `SIDECAR' data structure.
+
+   \param scp a pointer to a `SIDECAR' data structure.
+*/
+void
+free_sidecar (SIDECAR * scp)
+{
+  if (scp == NULL)
+    return;
+
+  munmap (scp->map, scp->map_size);
+  free (scp->admitted);
+  free (scp);
+}
+
+/*!
+   \fn void sidecar_select (SIDECAR *, char *const *, const size_t *, const ulong, const BOOL)
+
+   \brief A function that selects the admitted blocks of a file.
+
+   This function selects the admitted blocks of the block filters
+   (`scp') for the `num' strings (`strs' with lengths `lens'), one of
+   which any matching line contains: a block is admitted if its Bloom
+   filter has all the trigrams of one of the strings (the trigrams are
+   found as `index_select' finds them, with `fold'). If a string has no
+   usable trigram (or there are no strings), then every block is
+   admitted.
+
+   \param scp a pointer to a `SIDECAR' data structure.
+   \param strs a pointer to a constant pointer to a character.
+   \param lens a pointer to a constant `size_t' type definition.
+   \param num a constant unsigned long integer.
+   \param fold a constant `BOOL' enumeration value.
+*/
+void
+sidecar_select (SIDECAR * scp, char *const *strs, const size_t * lens,
+                const ulong num, const BOOL fold)
+{
+  /* externs. */
+
+  /* function externs. */
+  extern void *emalloc (size_t);
+
+  /* the characters which can not be used in a trigram. */
+  uchar skip[UCHAR_MAX + 1];
+
+  /* the trigrams of the strings (one after the other). */
+  uint *grams;
+  ulong *firsts;
+  size_t total = 0;
+
+  /* the filter of a block. */
+  const uchar *filter;
+  ulong bits;
+
+  /* is used for the loops. */
+  register ulong i, j, k;
+
+  memset (scp->admitted, 1, scp->num_blocks);
+  if (num == 0)
+    return;
+
+  fold_skips (skip, fold);
+
+  for (j = 0L; j < num; j++)
+    total += lens[j];
+
+  grams = (uint *) emalloc ((total + 1) * sizeof (uint));
+  firsts = (ulong *) emalloc ((num + 1) * sizeof (ulong));
+
+  /* a string without trigrams can be anywhere. */
+  for (j = 0L, firsts[0] = 0L; j < num; j++)
+    {
+      k = string_grams ((const uchar *) strs[j], lens[j], skip, fold,
+                        grams + firsts[j]);
+      if (k == 0)
+        {
+          free (grams);
+          free (firsts);
+          return;
+        }
+      firsts[j + 1] = firsts[j] + k;
+    }
+
+  for (i = 0L; i < scp->num_blocks; i++)
+    {
+      filter = scp->filters + scp->blocks[i].filter;
+      bits = (scp->blocks[i + 1].filter - scp->blocks[i].filter) * CHAR_BIT;
+
+      scp->admitted[i] = 0;
+      for (j = 0L; j < num && !scp->admitted[i]; j++)
+        {
+          for (k = firsts[j]; k < firsts[j + 1]; k++)
+            if (!bloom_test (filter, bits, grams[k]))
+              break;
+
+          if (k == firsts[j + 1])
+            scp->admitted[i] = 1;
+        }
+    }
+
+  free (grams);
+  free (firsts);
+}
+
+/*!
+   \fn ulong fnv_hash (const uchar *, const size_t)
+
+   \brief A function that hashes some characters.
+
+   This function returns the FNV-1a hash of the `n' characters of `p'
+   (the contents of the indexed files, the tails of the cached files,
+   and the keys of the result cache).
+
+   \param p a pointer to a constant unsigned character.
+   \param n a constant `size_t' type definition.
+
+   \return An unsigned long integer.
+*/
+ulong
+fnv_hash (const uchar * p, const size_t n)
+{
+  return fnv_more (2166136261UL, p, n);
+}
+
+/*!
+   \fn static ulong fnv_more (ulong, const uchar *, const size_t)
+
+   \brief A function that hashes some more characters.
+
+   This function returns the FNV-1a hash `hash' of some characters
+   gone on with the `n' characters of `p', so some characters can be
+   hashed in parts.
+
+   \param hash an unsigned long integer.
+   \param p a pointer to a constant unsigned character.
+   \param n a constant `size_t' type definition.
+
+   \return An unsigned long integer.
+*/
+static ulong
+fnv_more (ulong hash, const uchar * p, const size_t n)
+{
+  /* the hash of the characters. */
+  uint h = (uint) hash;
+
+  /* is used for the loops. */
+  register size_t i;
+
+  for (i = 0; i < n; i++)
+    h = (h ^ p[i]) * 16777619U;
+
+  return (ulong) h;
+}
+
+/*!
+   \fn static void add_file (INDEX_BUILDER *, const char *, const INDEX *, ulong *)
+
+   \brief A function that indexes a file.
+
+   This function adds the file `path' to the index which is built
+   (`bp'). Its first block is sniffed, and a binary file is added
+   without trigrams. Only the size which the file has when it is
+   opened is read, so the trigrams are never fewer than the ones
+   of the file as it is recorded. A file which can not be read is
+   added as a binary one (so it is always searched).
+
+   If the file is in the old index (`old', or NULL) by its identity,
+   then its old file is mapped to it in `remap' (so its old posting
+   lists are kept) and the file is read only if it is changed. If
+   it only grew, then its old characters are hashed, and if the hash
+   is the same as the recorded hash of the whole file, then only the
+   trigrams of the appended characters (and of the two before them,
+   for the trigrams which cross the old end) are collected. Any other
+   changed file is read whole.
+
+   \param bp a pointer to a `INDEX_BUILDER' data structure.
+   \param path a pointer to a constant character.
+   \param old a pointer to a constant `INDEX' data structure.
+   \param remap a pointer to an unsigned long integer.
+*/
+static void
+add_file (INDEX_BUILDER * bp, const char *path, const INDEX * old,
+          ulong * remap)
+{
+  /* externs. */
+
+  /* function externs. */
+  extern void *erealloc (void *, size_t);
+  extern void weprintf (char *, ...);
+
+  /* the file. */
+  int fd;
+  struct stat stbuf;
+
+  /* the indexed file and its old one. */
+  INDEX_FILE *fp;
+  const INDEX_FILE *op = NULL;
+  ulong id = ULONG_MAX;
+
+  /* the length of the path. */
+  const size_t len = strlen (path) + 1;
+
+  /* the first character which is read and the hash of the old ones. */
+  off_t from = 0;
+  ulong hash;
+
+  /* the current trigram. */
+  uint gram;
+
+  /* is used for the loops. */
+  register ulong k;
+
+  if ((fd = open (path, O_RDONLY | O_NOCTTY | O_NONBLOCK)) == -1)
+    {
+      weprintf ("open(\"%.500s\") failed:", path);
+      return;
+    }
+
+  if (fstat (fd, &stbuf) == -1 || !S_ISREG (stbuf.st_mode))
+    {
+      close (fd);
+      return;
+    }
+
+  /* record the file. */
+  if (bp->num_files == bp->max_files)
+    {
+      bp->max_files = (bp->max_files ? 2 * bp->max_files : 1024L);
+      bp->files = (INDEX_FILE *) erealloc (bp->files, bp->max_files
+                                           * sizeof (INDEX_FILE));
+    }
+
+  while (bp->paths_len + len > bp->paths_room)
+    {
+      bp->paths_room = (bp->paths_room ? 2 * bp->paths_room : 65536);
+      bp->paths = (char *) erealloc (bp->paths, bp->paths_room);
+    }
+
+  fp = &bp->files[bp->num_files];
+  fp->path = (ulong) bp->paths_len;
+  fp->dev = (ulong) stbuf.st_dev;
+  fp->ino = (ulong) stbuf.st_ino;
+  fp->size = (ulong) stbuf.st_size;
+  fp->mtime = (long) stbuf.st_mtim.tv_sec;
+  fp->mtime_nsec = stbuf.st_mtim.tv_nsec;
+  fp->flags = 0L;
+  fp->hash = fnv_hash (NULL, 0);
+
+  memcpy (bp->paths + bp->paths_len, path, len);
+  bp->paths_len += len;
+
+  /* the old file (a file under two paths is kept once). */
+  if (old != NULL
+      && (id = find_file (old, fp->dev, fp->ino)) != ULONG_MAX
+      && remap[id] == ULONG_MAX)
+    op = &old->files[id];
+
+  if (op != NULL)
+    {
+      /* an unchanged file keeps its old lists. */
+      if (op->size == fp->size && op->mtime == fp->mtime
+          && op->mtime_nsec == fp->mtime_nsec)
+        {
+          fp->flags = op->flags;
+          fp->hash = op->hash;
+          remap[id] = bp->num_files++;
+          close (fd);
+          return;
+        }
+
+      /* an appended file keeps them too, if its old characters are
+         the same, and adds the appended ones. (a small file is read
+         whole, so its first block is sniffed again.) */
+      if (!(op->flags & INDEX_BINARY) && op->size >= MIN_APPENDED
+          && op->size < fp->size
+          && read_hash (bp, fd, 0, (off_t) op->size - 2, &fp->hash))
+        {
+          hash = fp->hash;
+          if (read_hash (bp, fd, (off_t) op->size - 2, (off_t) op->size,
+                         &hash) && hash == op->hash)
+            {
+              remap[id] = bp->num_files;
+              from = (off_t) op->size - 2;
+            }
+          else
+            fp->hash = fnv_hash (NULL, 0);
+        }
+    }
+
+  /* collect the distinct trigrams of the file (and go on hashing). */
+  bp->num_found = 0L;
+  if (!read_grams (bp, fd, path, from, stbuf.st_size, &fp->flags,
+                   &fp->hash))
+    fp->flags |= INDEX_BINARY;
+
+  close (fd);
+
+  /* append the file to the lists of its trigrams. */
+  for (k = 0L; k < bp->num_found; k++)
+    {
+      gram = bp->found[k];
+      bp->seen[gram / CHAR_BIT] = 0;
+      if (!(fp->flags & INDEX_BINARY))
+        add_posting (bp, gram, bp->num_files);
+    }
+
+  bp->num_files++;
+}
+
+/*!
+   \fn static BOOL read_grams (INDEX_BUILDER *, const int, const char *, off_t, const off_t, ulong *, ulong *)
+
+   \brief A function that collects the trigrams of a file.
+
+   This function reads the characters `from' up to `to' of the open
+   file `fd' (of the path `path') and collects their distinct trigrams
+   in the index which is built (`bp'), and goes on with the hash of
+   the characters before them (`hash', see `fnv_hash'). If the
+   characters start from the first one, then the first block is
+   sniffed, and a binary file is marked in `flags' (and its trigrams
+   are not collected, nor is it hashed). If the file can not be read,
+   it returns `false'.
+
+   \param bp a pointer to a `INDEX_BUILDER' data structure.
+   \param fd a constant integer value.
+   \param path a pointer to a constant character.
+   \param from a `off_t' type definition.
+   \param to a constant `off_t' type definition.
+   \param flags a pointer to an unsigned long integer.
+   \param hash a pointer to an unsigned long integer.
+
+   \return A `BOOL' enumeration value (`false', `true').
+*/
+static BOOL
+read_grams (INDEX_BUILDER * bp, const int fd, const char *path, off_t from,
+            const off_t to, ulong * flags, ulong * hash)
+{
+  /* externs. */
+
+  /* function externs. */
+  extern void weprintf (char *, ...);
+  extern FILE_INFO sniff_input_file (const uchar *, size_t);
+
+  /* the characters of a read. */
+  ssize_t n;
+
+  /* the current trigram and the characters of the current line. */
+  uint gram = 0;
+  ulong run = 0L;
+
+  for (; from < to; from += n)
+    {
+      do
+        n = pread (fd, bp->buf, (to - from < INDEX_BLOCK
+                                 ? (size_t) (to - from) : INDEX_BLOCK),
+                   from);
+      while (n < 0 && errno == EINTR);
+
+      if (n <= 0)
+        {
+          if (n < 0)
+            weprintf ("read(\"%.500s\") failed:", path);
+          return false;
+        }
+
+      /* a binary file has no trigrams. */
+      if (from == 0 && sniff_input_file (bp->buf, (size_t) n) == f_binary)
+        {
+          *flags |= INDEX_BINARY;
+          break;
+        }
+
+      collect_grams (bp, bp->buf, (size_t) n, &gram, &run);
+      *hash = fnv_more (*hash, bp->buf, (size_t) n);
+    }
+
+  return true;
+}
+
+/*!
+   \fn static void collect_grams (INDEX_BUILDER *, const uchar *, const size_t, uint *, ulong *)
+
+   \brief A function that collects the trigrams of some characters.
+
+   This function adds the distinct trigrams of the `n' characters of
+   `p' (the ascii letters are folded to lowercase, and the trigrams
+   which cross a new line are left out) to the trigrams which are
+   found by the index which is built (`bp'). The current trigram
+   (`gram') and the characters of the current line (`run') go on
+   from the previous characters.
+
+   \param bp a pointer to a `INDEX_BUILDER' data structure.
+   \param p a pointer to a constant unsigned character.
+   \param n a constant `size_t' type definition.
+   \param gram a pointer to an unsigned integer.
+   \param run a pointer to an unsigned long integer.
+*/
+static void
+collect_grams (INDEX_BUILDER * bp, const uchar * p, const size_t n,
+               uint * gram, ulong * run)
+{
+  /* externs. */
+
+  /* function externs. */
+  extern void *erealloc (void *, size_t);
+
+  /* the current trigram and the characters of the current line. */
+  uint g = *gram;
+  ulong r = *run;
+
+  /* is used for the loops. */
+  register size_t i;
+  register uint c;
+
+  for (i = 0; i < n; i++)
+    {
+      c = p[i];
+      if (c == '\n')
+        {
+          r = 0L;
+          continue;
+        }
+
+      g = ((g << CHAR_BIT) | ASCII_LOWER (c)) & GRAM_MASK;
+      if (r < 2)
+        {
+          r++;
+          continue;
+        }
+
+      if (!(bp->seen[g / CHAR_BIT] & (1 << (g % CHAR_BIT))))
+        {
+          bp->seen[g / CHAR_BIT] |= (uchar) (1 << (g % CHAR_BIT));
+
+          if (bp->num_found == bp->max_found)
+            {
+              bp->max_found = (bp->max_found ? 2 * bp->max_found : 4096L);
+              bp->found = (uint *) erealloc (bp->found, bp->max_found
+                                             * sizeof (uint));
+            }
+          bp->found[bp->num_found++] = g;
+        }
+    }
+
+  *gram = g;
+  *run = r;
+}
+
+/*!
+   \fn static BOOL read_hash (INDEX_BUILDER *, const int, off_t, const off_t, ulong *)
+
+   \brief A function that hashes some characters of a file.
+
+   This function reads the characters `from' up to `to' of the open
+   file `fd' and goes on with the hash of the characters before them
+   (`hash', see `fnv_hash'). An update compares the hash of the old
+   characters of a file which grew, so a file which is changed before
+   its old end is read whole again. If the characters can not be
+   read, it returns `false'.
+
+   \param bp a pointer to a `INDEX_BUILDER' data structure.
+   \param fd a constant integer value.
+   \param from a `off_t' type definition.
+   \param to a constant `off_t' type definition.
+   \param hash a pointer to an unsigned long integer.
+
+   \return A `BOOL' enumeration value (`false', `true').
+*/
+static BOOL
+read_hash (INDEX_BUILDER * bp, const int fd, off_t from, const off_t to,
+           ulong * hash)
+{
+  /* the characters of a read. */
+  ssize_t n;
+
+  for (; from < to; from += n)
+    {
+      do
+        n = pread (fd, bp->buf, (to - from < INDEX_BLOCK
+                                 ? (size_t) (to - from) : INDEX_BLOCK),
+                   from);
+      while (n < 0 && errno == EINTR);
+
+      if (n <= 0)
+        return false;
+
+      *hash = fnv_more (*hash, bp->buf, (size_t) n);
+    }
+
+  return true;
+}
+
+/*!
+   \fn static void add_posting (INDEX_BUILDER *, const uint, const ulong)
+
+   \brief A function that appends a file to a posting list.
+
+   This function appends the file `file' to the posting list of the
+   trigram `gram' of the index which is built (`bp'), as the delta
+   from the last file of the list (in variable length bytes).
+
+   \param bp a pointer to a `INDEX_BUILDER' data structure.
+   \param gram a constant unsigned integer.
+   \param file a constant unsigned long integer.
+*/
+static void
+add_posting (INDEX_BUILDER * bp, const uint gram, const ulong file)
+{
+  append_posting (find_list (bp, gram), file);
+}
+
+/*!
+   \fn static void append_posting (GRAM_LIST *, const ulong)
+
+   \brief A function that appends a file to a posting list.
+
+   This function appends the file `file' (which follows the last
+   file) to the posting list `lp', as the delta from the last file
+   of the list (in variable length bytes).
+
+   \param lp a pointer to a `GRAM_LIST' data structure.
+   \param file a constant unsigned long integer.
+*/
+static void
+append_posting (GRAM_LIST * lp, const ulong file)
+{
+  /* externs. */
+
+  /* function externs. */
+  extern void *erealloc (void *, size_t);
+
+  /* the delta from the last file. */
+  ulong delta = file - lp->last;
+
+  if (lp->len + VARINT_BYTES > lp->room)
+    {
+      lp->room = (lp->room ? 2 * lp->room : 16);
+      lp->bytes = (uchar *) erealloc (lp->bytes, lp->room);
+    }
+
+  while (delta >= 0x80)
+    {
+      lp->bytes[lp->len++] = (uchar) (delta | 0x80);
+      delta >>= 7;
+    }
+  lp->bytes[lp->len++] = (uchar) delta;
+
+  lp->last = file;
+  lp->count++;
+}
+
+/*!
+   \fn static GRAM_LIST * find_list (INDEX_BUILDER *, const uint)
+
+   \brief A function that finds the posting list of a trigram.
+
+   This function returns the posting list of the trigram `gram' of
+   the index which is built (`bp'), a new empty one if there is not
+   any. The hash table doubles when it gets half full.
+
+   \param bp a pointer to a `INDEX_BUILDER' data structure.
+   \param gram a constant unsigned integer.
+
+   \return A pointer to a `GRAM_LIST' data structure.
+*/
+static GRAM_LIST *
+find_list (INDEX_BUILDER * bp, const uint gram)
+{
+  /* externs. */
+
+  /* function externs. */
+  extern void *emalloc (size_t);
+  extern void *erealloc (void *, size_t);
+
+  /* the slot of the trigram. */
+  ulong h = (gram * 2654435761U) >> bp->shift;
+  uint id;
+
+  /* the new list. */
+  GRAM_LIST *lp;
+
+  /* is used for the loops. */
+  register ulong i;
+
+  while ((id = bp->slots[h]) != 0)
+    {
+      if (bp->lists[id - 1].gram == gram)
+        return &bp->lists[id - 1];
+      h = (h + 1) & (bp->num_slots - 1);
+    }
+
+  if (bp->num_lists == bp->max_lists)
+    {
+      bp->max_lists = (bp->max_lists ? 2 * bp->max_lists : 4096L);
+      bp->lists = (GRAM_LIST *) erealloc (bp->lists, bp->max_lists
+                                          * sizeof (GRAM_LIST));
+    }
+
+  lp = &bp->lists[bp->num_lists++];
+  lp->gram = gram;
+  lp->count = 0;
+  lp->last = 0L;
+  lp->bytes = NULL;
+  lp->len = lp->room = 0;
+  bp->slots[h] = (uint) bp->num_lists;
+
+  /* double the hash table. */
+  if (2 * bp->num_lists >= bp->num_slots)
+    {
+      free (bp->slots);
+      bp->num_slots *= 2;
+      bp->shift--;
+      bp->slots = (uint *) emalloc (bp->num_slots * sizeof (uint));
+      memset (bp->slots, 0, bp->num_slots * sizeof (uint));
+
+      for (i = 0L; i < bp->num_lists; i++)
+        {
+          h = (bp->lists[i].gram * 2654435761U) >> bp->shift;
+          while (bp->slots[h] != 0)
+            h = (h + 1) & (bp->num_slots - 1);
+          bp->slots[h] = (uint) (i + 1);
+        }
+    }
+
+  return lp;
+}
+
+/*!
+   \fn static void merge_index (INDEX_BUILDER *, const INDEX *, const char *, const ulong *)
+
+   \brief A function that merges the lists of an old index.
+
+   This function merges the posting lists of the old index (`old', of
+   the index file `path') into the ones of the index which is built
+   (`bp'): each old file which is kept is mapped to its new one by
+   `remap' (ULONG_MAX for a file which is left out), and the files of
+   a trigram are sorted again (the walk may visit them in another
+   order) without duplicates. The lists are sorted by trigram, so the
+   hash table of the builder is not used after. If a posting list of
+   the old index is not valid, it exits.
+
+   \param bp a pointer to a `INDEX_BUILDER' data structure.
+   \param old a pointer to a constant `INDEX' data structure.
+   \param path a pointer to a constant character.
+   \param remap a pointer to a constant unsigned long integer.
+*/
+static void
+merge_index (INDEX_BUILDER * bp, const INDEX * old, const char *path,
+             const ulong * remap)
+{
+  /* externs. */
+
+  /* function externs. */
+  extern void *emalloc (size_t);
+  extern void eprintf (char *, ...);
+
+  /* variable externs. */
+  extern cstring usage_invalid_index;
+
+  /* the merged lists. */
+  GRAM_LIST *lists, *lp;
+  ulong num_lists = 0L;
+
+  /* the files of a trigram. */
+  ulong *ids, n, m;
+  BOOL sorted;
+
+  /* the files of a new list. */
+  const uchar *p, *end;
+  ulong id, delta;
+
+  /* the current trigram. */
+  uint gram;
+
+  /* is used for the loops. */
+  register ulong i = 0L, j = 0L, k;
+
+  const ulong num_grams = old->header->num_grams;
+
+  if (bp->num_lists > 0)
+    qsort (bp->lists, bp->num_lists, sizeof (GRAM_LIST), compare_lists);
+
+  lists = (GRAM_LIST *) emalloc ((bp->num_lists + num_grams + 1)
+                                 * sizeof (GRAM_LIST));
+  ids = (ulong *) emalloc ((old->header->num_files + bp->num_files + 1)
+                           * sizeof (ulong));
+
+  while (i < bp->num_lists || j < num_grams)
+    {
+      if (j == num_grams
+          || (i < bp->num_lists && bp->lists[i].gram < old->grams[j].gram))
+        gram = bp->lists[i].gram;
+      else
+        gram = old->grams[j].gram;
+
+      /* the kept files of the old list. */
+      n = 0L;
+      if (j < num_grams && old->grams[j].gram == gram)
+        {
+          if ((m = decode_list (old, &old->grams[j++], ids)) == ULONG_MAX)
+            eprintf (_(usage_invalid_index), path);
+          for (k = 0L; k < m; k++)
+            if (remap[ids[k]] != ULONG_MAX)
+              ids[n++] = remap[ids[k]];
+        }
+
+      /* the read files of the new list. */
+      if (i < bp->num_lists && bp->lists[i].gram == gram)
+        {
+          p = bp->lists[i].bytes;
+          end = p + bp->lists[i].len;
+          for (id = 0L; p < end && (p = read_varint (p, end, &delta)) != NULL;)
+            ids[n++] = (id += delta);
+          free (bp->lists[i++].bytes);
+        }
+
+      for (sorted = true, k = 1L; k < n && sorted; k++)
+        if (ids[k] <= ids[k - 1])
+          sorted = false;
+      if (!sorted)
+        qsort (ids, n, sizeof (ulong), compare_ids);
+
+      if (n == 0)
+        continue;
+
+      lp = &lists[num_lists++];
+      lp->gram = gram;
+      lp->count = 0;
+      lp->last = 0L;
+      lp->bytes = NULL;
+      lp->len = lp->room = 0;
+      for (k = 0L; k < n; k++)
+        if (k == 0 || ids[k] != ids[k - 1])
+          append_posting (lp, ids[k]);
+    }
+
+  free (ids);
+  free (bp->lists);
+  bp->lists = lists;
+  bp->num_lists = num_lists;
+  bp->max_lists = bp->num_lists;
+}
+
+/*!
+   \fn static void write_index (INDEX_BUILDER *, const char *)
+
+   \brief A function that writes an index file.
+
+   This function writes the index which is built (`bp') into the
+   index file `path': the header, the files, the hash table of the
+   files (by identity), the sorted trigrams, the paths and the posting lists. The
+   file is written aside and renamed over `path'. If it can not be
+   written, it exits.
+
+   \param bp a pointer to a `INDEX_BUILDER' data structure.
+   \param path a pointer to a constant character.
+*/
+static void
+write_index (INDEX_BUILDER * bp, const char *path)
+{
+  /* externs. */
+
+  /* function externs. */
+  extern void *emalloc (size_t);
+  extern void eprintf (char *, ...);
+
+  /* variable externs. */
+  extern cstring usage_too_many_files;
+
+  /* the header of the index file. */
+  INDEX_HEADER h;
+
+  /* the hash table of the files and the trigrams. */
+  uint *table;
+  INDEX_GRAM *grams;
+
+  /* the slot of a file. */
+  ulong slot;
+
+  /* the length of the posting lists. */
+  ulong total = 0L;
+
+  /* the index file which is written. */
+  char *temp;
+  FILE *fp;
+
+  /* is used for the loops. */
+  register ulong i;
+
+  if (bp->num_files >= UINT_MAX / 2)
+    eprintf ("%s", _(usage_too_many_files));
+
+  /* the trigrams in order. */
+  if (bp->num_lists > 0)
+    qsort (bp->lists, bp->num_lists, sizeof (GRAM_LIST), compare_lists);
+
+  grams = (INDEX_GRAM *) emalloc ((bp->num_lists + 1) * sizeof (INDEX_GRAM));
+  for (i = 0L; i < bp->num_lists; i++)
+    {
+      grams[i].gram = bp->lists[i].gram;
+      grams[i].count = bp->lists[i].count;
+      grams[i].postings = total;
+      total += (ulong) bp->lists[i].len;
+    }
+  grams[i].gram = UINT_MAX;
+  grams[i].count = 0;
+  grams[i].postings = total;
+
+  /* the hash table of the files. */
+  memset (&h, 0, sizeof (h));
+  h.table_size = MIN_TABLE;
+  while (h.table_size < 2 * bp->num_files)
+    h.table_size *= 2;
+
+  table = (uint *) emalloc (h.table_size * sizeof (uint));
+  memset (table, 0, h.table_size * sizeof (uint));
+  for (i = 0L; i < bp->num_files; i++)
+    {
+      slot = identity_hash (bp->files[i].dev, bp->files[i].ino)
+        & (h.table_size - 1);
+      while (table[slot] != 0)
+        slot = (slot + 1) & (h.table_size - 1);
+      table[slot] = (uint) (i + 1);
+    }
+
+  /* the header. */
+  memcpy (h.magic, INDEX_MAGIC, sizeof (h.magic));
+  h.word = INDEX_WORD;
+  h.num_files = bp->num_files;
+  h.num_grams = bp->num_lists;
+  h.files = ALIGNED (sizeof (INDEX_HEADER));
+  h.table = ALIGNED (h.files + bp->num_files * sizeof (INDEX_FILE));
+  h.grams = ALIGNED (h.table + h.table_size * sizeof (uint));
+  h.paths = h.grams + (bp->num_lists + 1) * sizeof (INDEX_GRAM);
+  h.postings = ALIGNED (h.paths + bp->paths_len);
+  h.size = h.postings + total;
+
+  /* write the index file aside. */
+  fp = create_temp (path, &temp);
+
+  write_section (fp, temp, &h, sizeof (h), h.files - sizeof (h));
+  write_section (fp, temp, bp->files, bp->num_files * sizeof (INDEX_FILE),
+                 h.table - h.files - bp->num_files * sizeof (INDEX_FILE));
+  write_section (fp, temp, table, h.table_size * sizeof (uint),
+                 h.grams - h.table - h.table_size * sizeof (uint));
+  write_section (fp, temp, grams, (bp->num_lists + 1) * sizeof (INDEX_GRAM),
+                 0);
+  write_section (fp, temp, bp->paths, bp->paths_len,
+                 h.postings - h.paths - bp->paths_len);
+  for (i = 0L; i < bp->num_lists; i++)
+    write_section (fp, temp, bp->lists[i].bytes, bp->lists[i].len, 0);
+
+  commit_temp (fp, temp, path);
+
+  free (table);
+  free (grams);
+}
+
+/*!
+   \fn static FILE * create_temp (const char *, char **)
+
+   \brief A function that creates a file which is written aside.
+
+   This function creates (or truncates) the file `path' with the
+   `.tmp' suffix, which `commit_temp' renames over `path' when it is
+   written, and it puts its path in `temp'. If it can not be created,
+   it exits.
+
+   \param path a pointer to a constant character.
+   \param temp a pointer to a pointer to a character.
+
+   \return A pointer to a `FILE' data structure.
+*/
+static FILE *
+create_temp (const char *path, char **temp)
+{
+  /* externs. */
+
+  /* function externs. */
+  extern void *emalloc (size_t);
+  extern void eprintf (char *, ...);
+
+  FILE *fp;
+
+  *temp = (char *) emalloc (strlen (path) + sizeof (INDEX_TEMP));
+  strcpy (*temp, path);
+  strcat (*temp, INDEX_TEMP);
+
+  if ((fp = fopen (*temp, "wb")) == NULL)
+    eprintf ("fopen(\"%.500s\") failed:", *temp);
+
+  return fp;
+}
+
+/*!
+   \fn static void commit_temp (FILE *, char *, const char *)
+
+   \brief A function that replaces a file with the one written aside.
+
+   This function closes the file `fp' (of the path `temp', which it
+   releases) and renames it over the file `path', so a reader never
+   maps a partial file. If it can not be done, it exits.
+
+   \param fp a pointer to a `FILE' data structure.
+   \param temp a pointer to a character.
+   \param path a pointer to a constant character.
+*/
+static void
+commit_temp (FILE * fp, char *temp, const char *path)
+{
+  /* externs. */
+
+  /* function externs. */
+  extern void eprintf (char *, ...);
+
+  if (fclose (fp) != 0)
+    eprintf ("fclose(\"%.500s\") failed:", temp);
+
+  if (rename (temp, path) == -1)
+    eprintf ("rename(\"%.500s\") failed:", temp);
+
+  free (temp);
+}
+
+/*!
+   \fn static void write_section (FILE *, const char *, const void *, const size_t, const size_t)
+
+   \brief A function that writes a section of an index file.
+
+   This function writes the `n' characters of `p' and `pad' null
+   characters to the index file `fp' (of the path `path'). If they
+   can not be written, it exits.
+
+   \param fp a pointer to a `FILE' data structure.
+   \param path a pointer to a constant character.
+   \param p a pointer to constant void.
+   \param n a constant `size_t' type definition.
+   \param pad a constant `size_t' type definition.
+*/
+static void
+write_section (FILE * fp, const char *path, const void *p, const size_t n,
+               const size_t pad)
+{
+  /* externs. */
+
+  /* function externs. */
+  extern void eprintf (char *, ...);
+
+  /* the null characters of the padding. */
+  static const char zeros[sizeof (ulong)];
+
+  if ((n > 0 && fwrite (p, 1, n, fp) != n)
+      || (pad > 0 && fwrite (zeros, 1, pad, fp) != pad))
+    eprintf ("fwrite(\"%.500s\") failed:", path);
+}
+
+/*!
+   \fn static ulong select_string (INDEX *, const uchar *, const size_t, const uchar *, const BOOL, uint *, ulong *)
+
+   \brief A function that selects the files of a string.
+
+   This function puts in `ids' the files of the index (`ip') which
+   contain all the trigrams of the string `str' of `len' characters
+   (a trigram with a character of `skip' is not used), and it returns
+   their number. If `fold' is `true', then the string is lowercased
+   first. `grams' has room for the trigrams of the string. If the
+   string has no usable trigram (or a posting list is not valid), it
+   returns ULONG_MAX.
+
+   \param ip a pointer to a `INDEX' data structure.
+   \param str a pointer to a constant unsigned character.
+   \param len a constant `size_t' type definition.
+   \param skip a pointer to a constant unsigned character.
+   \param fold a constant `BOOL' enumeration value.
+   \param grams a pointer to an unsigned integer.
+   \param ids a pointer to an unsigned long integer.
+
+   \return An unsigned long integer.
+*/
+static ulong
+select_string (INDEX * ip, const uchar * str, const size_t len,
+               const uchar * skip, const BOOL fold, uint * grams,
+               ulong * ids)
+{
+  /* externs. */
+
+  /* function externs. */
+  extern void *emalloc (size_t);
+
+  /* the posting lists of the trigrams. */
+  const INDEX_GRAM **lists;
+
+  /* the number of the trigrams and of the files. */
+  ulong num_grams, n, m, k;
+
+  /* the files of a posting list. */
+  const uchar *p, *end;
+  ulong id, delta;
+
+  /* is used for the loops. */
+  register ulong j;
+
+  /* the distinct trigrams of the string. */
+  if ((num_grams = string_grams (str, len, skip, fold, grams)) == 0)
+    return ULONG_MAX;
+
+  qsort (grams, num_grams, sizeof (uint), compare_grams);
+  for (j = 1L, k = 1L; j < num_grams; j++)
+    if (grams[j] != grams[k - 1])
+      grams[k++] = grams[j];
+  num_grams = k;
+
+  /* a missing trigram is in no file. */
+  lists = (const INDEX_GRAM **) emalloc (num_grams * sizeof (INDEX_GRAM *));
+  for (j = 0L; j < num_grams; j++)
+    if ((lists[j] = find_gram (ip, grams[j])) == NULL)
+      {
+        free ((void *) lists);
+        return 0L;
+      }
+
+  /* intersect the posting lists from the shortest one. */
+  qsort ((void *) lists, num_grams, sizeof (INDEX_GRAM *), compare_counts);
+
+  n = decode_list (ip, lists[0], ids);
+  for (j = 1L; j < num_grams && n != ULONG_MAX && n > 0; j++)
+    {
+      if (!list_bytes (ip, lists[j], &p, &end))
+        {
+          n = ULONG_MAX;
+          break;
+        }
+
+      /* keep the files which are in both lists. */
+      for (id = 0L, k = 0L, m = 0L; k < n && p < end;)
+        {
+          if ((p = read_varint (p, end, &delta)) == NULL)
+            {
+              m = ULONG_MAX;
+              break;
+            }
+          id += delta;
+
+          while (k < n && ids[k] < id)
+            k++;
+          if (k < n && ids[k] == id)
+            ids[m++] = ids[k++];
+        }
+      n = m;
+    }
+
+  free ((void *) lists);
+
+  return n;
+}
+
+/*!
+   \fn static char * sidecar_name (const char *)
+
+   \brief A function that returns the path of the sidecar of a file.
+
+   This function returns the path of the block filters file of the
+   file `path' (the path with the `.gfs-blocks' suffix).
+
+   \param path a pointer to a constant character.
+
+   \return A pointer to a character.
+*/
+static char *
+sidecar_name (const char *path)
+{
+  /* externs. */
+
+  /* function externs. */
+  extern void *emalloc (size_t);
+
+  char *name = (char *) emalloc (strlen (path) + sizeof (SIDECAR_NAME));
+
+  strcpy (name, path);
+  strcat (name, SIDECAR_NAME);
+
+  return name;
+}
+
+/*!
+   \fn static void bloom_add (uchar *, const ulong, const uint)
+
+   \brief A function that adds a trigram to a Bloom filter.
+
+   This function sets the BLOOM_HASHES bits of the trigram `gram' in
+   the Bloom filter `filter' of `bits' bits (the bits are found by
+   double hashing).
+
+   \param filter a pointer to an unsigned character.
+   \param bits a constant unsigned long integer.
+   \param gram a constant unsigned integer.
+*/
+static void
+bloom_add (uchar * filter, const ulong bits, const uint gram)
+{
+  /* the hashes of the trigram. */
+  uint h = gram * 2654435761U;
+  const uint d = ((gram ^ (gram >> 12)) * 2246822519U) | 1U;
+
+  /* the current bit. */
+  ulong bit;
+
+  /* is used for the loops. */
+  register int i;
+
+  for (i = 0; i < BLOOM_HASHES; i++, h += d)
+    {
+      bit = (ulong) h % bits;
+      filter[bit / CHAR_BIT] |= (uchar) (1 << (bit % CHAR_BIT));
+    }
+}
+
+/*!
+   \fn static BOOL bloom_test (const uchar *, const ulong, const uint)
+
+   \brief A function that checks a trigram of a Bloom filter.
+
+   This function returns `true' if all the bits of the trigram `gram'
+   are set in the Bloom filter `filter' of `bits' bits (the trigram
+   may be in the block), else `false' (it is not).
+
+   \param filter a pointer to a constant unsigned character.
+   \param bits a constant unsigned long integer.
+   \param gram a constant unsigned integer.
+
+   \return A `BOOL' enumeration value (`false', `true').
+*/
+static BOOL
+bloom_test (const uchar * filter, const ulong bits, const uint gram)
+{
+  /* the hashes of the trigram. */
+  uint h = gram * 2654435761U;
+  const uint d = ((gram ^ (gram >> 12)) * 2246822519U) | 1U;
+
+  /* the current bit. */
+  ulong bit;
+
+  /* is used for the loops. */
+  register int i;
+
+  for (i = 0; i < BLOOM_HASHES; i++, h += d)
+    {
+      bit = (ulong) h % bits;
+      if (!(filter[bit / CHAR_BIT] & (1 << (bit % CHAR_BIT))))
+        return false;
+    }
+
+  return true;
+}
+
+/*!
+   \fn static void fold_skips (uchar *, const BOOL)
+
+   \brief A function that finds the characters which are not indexed.
+
+   This function marks in `skip' (of UCHAR_MAX + 1 characters) the
+   characters which can not be used in a trigram of a string: the
+   new line and, if `fold' is `true', the lowercase characters which
+   come from a character which the index keeps apart (only the ascii
+   letters are folded there).
+
+   \param skip a pointer to an unsigned character.
+   \param fold a constant `BOOL' enumeration value.
+*/
+static void
+fold_skips (uchar * skip, const BOOL fold)
+{
+  /* is used for the loops. */
+  register int c, l;
+
+  memset (skip, 0, UCHAR_MAX + 1);
+  skip['\n'] = 1;
+  if (fold)
+    for (c = 0; c <= UCHAR_MAX; c++)
+      {
+        l = tolower (c);
+        if (ASCII_LOWER (c) != ASCII_LOWER (l))
+          skip[(uchar) l] = 1;
+      }
+}
+
+/*!
+   \fn static ulong string_grams (const uchar *, const size_t, const uchar *, const BOOL, uint *)
+
+   \brief A function that finds the trigrams of a string.
+
+   This function puts in `grams' the trigrams of the string `str' of
+   `len' characters (a trigram with a character of `skip' is not
+   used), and it returns their number. If `fold' is `true', then the
+   string is lowercased first. `grams' has room for `len' trigrams.
+
+   \param str a pointer to a constant unsigned character.
+   \param len a constant `size_t' type definition.
+   \param skip a pointer to a constant unsigned character.
+   \param fold a constant `BOOL' enumeration value.
+   \param grams a pointer to an unsigned integer.
+
+   \return An unsigned long integer.
+*/
+static ulong
+string_grams (const uchar * str, const size_t len, const uchar * skip,
+              const BOOL fold, uint * grams)
+{
+  /* the number of the trigrams. */
+  ulong num_grams = 0L;
+
+  /* the current trigram and its usable characters. */
+  uint gram = 0, run = 0;
+
+  /* is used for the loops. */
+  register size_t i;
+  register uint c;
+
+  for (i = 0; i < len; i++)
+    {
+      c = str[i];
+      if (fold)
+        c = (uchar) tolower ((int) c);
+
+      if (skip[c])
+        {
+          run = 0;
+          continue;
+        }
+
+      gram = ((gram << CHAR_BIT) | ASCII_LOWER (c)) & GRAM_MASK;
+      if (++run >= 3)
+        grams[num_grams++] = gram;
+    }
+
+  return num_grams;
+}
+
+/*!
+   \fn static ulong decode_list (const INDEX *, const INDEX_GRAM *, ulong *)
+
+   \brief A function that decodes a posting list.
+
+   This function puts in `ids' the files of the posting list of the
+   trigram `gp' of the index (`ip'), and it returns their number. If
+   the posting list is not valid, it returns ULONG_MAX.
+
+   \param ip a pointer to a constant `INDEX' data structure.
+   \param gp a pointer to a constant `INDEX_GRAM' data structure.
+   \param ids a pointer to an unsigned long integer.
+
+   \return An unsigned long integer.
+*/
+static ulong
+decode_list (const INDEX * ip, const INDEX_GRAM * gp, ulong * ids)
+{
+  /* the bytes of the posting list. */
+  const uchar *p, *end;
+
+  /* the current file and the delta. */
+  ulong id = 0L, delta, n = 0L;
+
+  if (!list_bytes (ip, gp, &p, &end))
+    return ULONG_MAX;
+
+  while (p < end)
+    {
+      if ((p = read_varint (p, end, &delta)) == NULL)
+        return ULONG_MAX;
+
+      /* the files are increasing (only the first delta may be 0). */
+      id += delta;
+      if (id >= ip->header->num_files || (n > 0 && delta == 0))
+        return ULONG_MAX;
+      ids[n++] = id;
+    }
+
+  return n;
+}
+
+/*!
+   \fn static BOOL list_bytes (const INDEX *, const INDEX_GRAM *, const uchar **, const uchar **)
+
+   \brief A function that returns the bytes of a posting list.
+
+   This function sets `p' and `end' to the bytes of the posting list
+   of the trigram `gp' of the index (`ip'). If they are not in the
+   section of the posting lists, it returns `false'.
+
+   \param ip a pointer to a constant `INDEX' data structure.
+   \param gp a pointer to a constant `INDEX_GRAM' data structure.
+   \param p a pointer to a pointer to a constant unsigned character.
+   \param end a pointer to a pointer to a constant unsigned character.
+
+   \return A `BOOL' enumeration value (`false', `true').
+*/
+static BOOL
+list_bytes (const INDEX * ip, const INDEX_GRAM * gp, const uchar ** p,
+            const uchar ** end)
+{
+  if ((gp + 1)->postings < gp->postings
+      || (gp + 1)->postings > ip->header->size - ip->header->postings)
+    return false;
+
+  *p = ip->postings + gp->postings;
+  *end = ip->postings + (gp + 1)->postings;
+
+  return true;
+}
+
+/*!
+   \fn static const uchar * read_varint (const uchar *, const uchar *, ulong *)
+
+   \brief A function that reads a variable length number.
+
+   This function reads the variable length number of `p' (seven bits
+   per character, the high bit marks a following character, which is
+   before `end') into `value', and it returns the character after it.
+   If the number does not end before `end', it returns NULL.
+
+   \param p a pointer to a constant unsigned character.
+   \param end a pointer to a constant unsigned character.
+   \param value a pointer to an unsigned long integer.
+
+   \return A pointer to a constant unsigned character.
+*/
+static const uchar *
+read_varint (const uchar * p, const uchar * end, ulong * value)
+{
+  /* the number and the place of its next bits. */
+  ulong v = 0L;
+  uint shift = 0;
+
+  while (p < end && shift < sizeof (ulong) * CHAR_BIT)
+    {
+      v |= (ulong) (*p & 0x7F) << shift;
+      shift += 7;
+
+      if (!(*p++ & 0x80))
+        {
+          *value = v;
+          return p;
+        }
+    }
+
+  return NULL;
+}
+
+/*!
+   \fn static const INDEX_GRAM * find_gram (const INDEX *, const uint)
+
+   \brief A function that finds a trigram of an index.
+
+   This function returns the trigram `gram' of the index (`ip')
+   by a binary search, or NULL if it is not in the index.
+
+   \param ip a pointer to a constant `INDEX' data structure.
+   \param gram a constant unsigned integer.
+
+   \return A pointer to a constant `INDEX_GRAM' data structure.
+*/
+static const INDEX_GRAM *
+find_gram (const INDEX * ip, const uint gram)
+{
+  /* the bounds of the search. */
+  ulong lo = 0L, hi = ip->header->num_grams, mid;
+
+  while (lo < hi)
+    {
+      mid = lo + (hi - lo) / 2;
+      if (ip->grams[mid].gram < gram)
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+
+  if (lo < ip->header->num_grams && ip->grams[lo].gram == gram)
+    return &ip->grams[lo];
+
+  return NULL;
+}
+
+/*!
+   \fn static ulong find_file (const INDEX *, const ulong, const ulong)
+
+   \brief A function that finds a file of an index by identity.
+
+   This function returns the number of the file of the index (`ip')
+   with the device `dev' and the inode `ino', or ULONG_MAX if it is
+   not in the index.
+
+   \param ip a pointer to a constant `INDEX' data structure.
+   \param dev a constant unsigned long integer.
+   \param ino a constant unsigned long integer.
+
+   \return An unsigned long integer.
+*/
+static ulong
+find_file (const INDEX * ip, const ulong dev, const ulong ino)
+{
+  /* the mask of the hash table. */
+  const ulong mask = ip->header->table_size - 1;
+
+  /* the slot of the file. */
+  ulong h = identity_hash (dev, ino) & mask;
+  uint id;
+
+  while ((id = ip->table[h]) != 0 && id <= ip->header->num_files)
+    {
+      if (ip->files[id - 1].ino == ino && ip->files[id - 1].dev == dev)
+        return (ulong) (id - 1);
+
+      h = (h + 1) & mask;
+    }
+
+  return ULONG_MAX;
+}
+
+/*!
+   \fn static uint identity_hash (const ulong, const ulong)
+
+   \brief A function that hashes the identity of a file.
+
+   This function returns the FNV-1a hash of the characters of the
+   device `dev' and the inode `ino' of a file.
+
+   \param dev a constant unsigned long integer.
+   \param ino a constant unsigned long integer.
+
+   \return An unsigned integer.
+*/
+static uint
+identity_hash (const ulong dev, const ulong ino)
+{
+  /* the hash of the identity. */
+  uint h = 2166136261U;
+
+  /* is used for the loops. */
+  register size_t i;
+
+  for (i = 0; i < sizeof (ulong); i++)
+    h = (h ^ (uchar) (ino >> (i * CHAR_BIT))) * 16777619U;
+  for (i = 0; i < sizeof (ulong); i++)
+    h = (h ^ (uchar) (dev >> (i * CHAR_BIT))) * 16777619U;
+
+  return h;
+}
+
+/*!
+   \fn static int compare_lists (const void *, const void *)
+
+   \brief A function that compares two posting lists by trigram.
+
+   \param a a pointer to constant void.
+   \param b a pointer to constant void.
+
+   \return An integer less than, equal to, or greater than zero.
+*/
+static int
+compare_lists (const void *a, const void *b)
+{
+  const uint x = ((const GRAM_LIST *) a)->gram;
+  const uint y = ((const GRAM_LIST *) b)->gram;
+
+  return (x > y) - (x < y);
+}
+
+/*!
+   \fn static int compare_grams (const void *, const void *)
+
+   \brief A function that compares two trigrams.
+
+   \param a a pointer to constant void.
+   \param b a pointer to constant void.
+
+   \return An integer less than, equal to, or greater than zero.
+*/
+static int
+compare_grams (const void *a, const void *b)
+{
+  const uint x = *(const uint *) a;
+  const uint y = *(const uint *) b;
+
+  return (x > y) - (x < y);
+}
+
+/*!
+   \fn static int compare_counts (const void *, const void *)
+
+   \brief A function that compares two trigrams by the length of their lists.
+
+   \param a a pointer to constant void.
+   \param b a pointer to constant void.
+
+   \return An integer less than, equal to, or greater than zero.
+*/
+static int
+compare_counts (const void *a, const void *b)
+{
+  const uint x = (*(const INDEX_GRAM * const *) a)->count;
+  const uint y = (*(const INDEX_GRAM * const *) b)->count;
+
+  return (x > y) - (x < y);
+}
+
+/*!
+   \fn static int compare_ids (const void *, const void *)
+
+   \brief A function that compares two files of a posting list.
+
+   \param a a pointer to constant void.
+   \param b a pointer to constant void.
+
+   \return An integer less than, equal to, or greater than zero.
+*/
+static int
+compare_ids (const void *a, const void *b)
+{
+  const ulong x = *(const ulong *) a;
+  const ulong y = *(const ulong *) b;
+
+  return (x > y) - (x < y);
+}
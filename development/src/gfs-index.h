@@ -0,0 +1,504 @@
+/*
+ *  `gfs-index.h'.
+ *
+ *  This header contains the trigram index structs and typedefs.
+ *
+ *  Copyright (C) 2008  Efstathios Chatzikyriakidis (stathis.chatzikyriakidis@gmail.com).
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*!
+   \file gfs-index.h
+   \brief This header contains the trigram index structs and typedefs.
+*/
+
+/*
+ * structure data types.
+ */
+
+/*!
+   \struct index_headerT
+   \brief Index file header data structure.
+
+   This data structure is the header of an index file. The index
+   file is mapped in memory as it is, so the header keeps the
+   offsets of its sections (from the start of the file, aligned to
+   a long integer) and their sizes. The numbers are in the byte
+   order of the machine which built the index (the `word' check
+   rejects an index of another machine).
+*/
+struct index_headerT
+{
+  /*!
+     \var magic
+     \brief The magic characters of an index file.
+   */
+  char magic[8];
+
+  /*!
+     \var word
+     \brief A known number (checks the byte order and the word size).
+   */
+  ulong word;
+
+  /*!
+     \var num_files
+     \brief The number of the indexed files.
+   */
+  ulong num_files;
+
+  /*!
+     \var num_grams
+     \brief The number of the distinct trigrams.
+   */
+  ulong num_grams;
+
+  /*!
+     \var table_size
+     \brief The size of the hash table of the files (a power of two).
+   */
+  ulong table_size;
+
+  /*!
+     \var files
+     \brief The offset of the files.
+   */
+  ulong files;
+
+  /*!
+     \var table
+     \brief The offset of the hash table of the files.
+   */
+  ulong table;
+
+  /*!
+     \var grams
+     \brief The offset of the trigrams.
+   */
+  ulong grams;
+
+  /*!
+     \var paths
+     \brief The offset of the paths.
+   */
+  ulong paths;
+
+  /*!
+     \var postings
+     \brief The offset of the posting lists.
+   */
+  ulong postings;
+
+  /*!
+     \var size
+     \brief The size of the index file.
+   */
+  ulong size;
+};
+
+/*!
+   \struct index_fileT
+   \brief Indexed file data structure.
+
+   This data structure keeps an indexed file: its path, its identity
+   (the device and the inode, which the hash table of the files is
+   keyed on) and the size and the modification time which it had
+   when it was read, so a changed file is known (and searched) at
+   query time. The hash of all the characters which were read lets
+   an update index only the characters which are appended later, if
+   the characters before them are the same.
+*/
+struct index_fileT
+{
+  /*!
+     \var path
+     \brief The offset of the path in the paths.
+   */
+  ulong path;
+
+  /*!
+     \var dev
+     \brief The device of the file.
+   */
+  ulong dev;
+
+  /*!
+     \var ino
+     \brief The inode of the file.
+   */
+  ulong ino;
+
+  /*!
+     \var size
+     \brief The size of the file.
+   */
+  ulong size;
+
+  /*!
+     \var mtime
+     \brief The modification time of the file (seconds).
+   */
+  long mtime;
+
+  /*!
+     \var mtime_nsec
+     \brief The modification time of the file (nanoseconds).
+   */
+  long mtime_nsec;
+
+  /*!
+     \var flags
+     \brief The flags of the file (a binary file has no trigrams).
+   */
+  ulong flags;
+
+  /*!
+     \var hash
+     \brief The hash of the characters of the file (as it was read).
+   */
+  ulong hash;
+};
+
+/*!
+   \struct index_gramT
+   \brief Index trigram data structure.
+
+   This data structure keeps a trigram and its posting list: the
+   increasing numbers of the files which contain it, as deltas in
+   variable length bytes (seven bits per byte, the high bit marks
+   a following byte). The trigrams are sorted, and the last one is
+   a sentinel whose offset is the end of the posting lists.
+*/
+struct index_gramT
+{
+  /*!
+     \var gram
+     \brief The trigram (three characters, the first is high).
+   */
+  uint gram;
+
+  /*!
+     \var count
+     \brief The number of the files which contain the trigram.
+   */
+  uint count;
+
+  /*!
+     \var postings
+     \brief The offset of the posting list in the posting lists.
+   */
+  ulong postings;
+};
+
+/*!
+   \struct indexT
+   \brief Trigram index data structure.
+
+   This data structure keeps a mapped index file and the candidate
+   files of a run (the files which may contain a match).
+*/
+struct indexT
+{
+  /*!
+     \var map
+     \brief The mapped index file.
+   */
+  void *map;
+
+  /*!
+     \var map_size
+     \brief The size of the mapped index file.
+   */
+  size_t map_size;
+
+  /*!
+     \var header
+     \brief The header of the index file.
+   */
+  const struct index_headerT *header;
+
+  /*!
+     \var files
+     \brief The indexed files.
+   */
+  const struct index_fileT *files;
+
+  /*!
+     \var table
+     \brief The hash table of the files by identity (file + 1, 0 if empty).
+   */
+  const uint *table;
+
+  /*!
+     \var grams
+     \brief The trigrams (and the sentinel).
+   */
+  const struct index_gramT *grams;
+
+  /*!
+     \var paths
+     \brief The paths of the files.
+   */
+  const char *paths;
+
+  /*!
+     \var postings
+     \brief The posting lists.
+   */
+  const uchar *postings;
+
+  /*!
+     \var candidates
+     \brief Is each file a candidate (may it contain a match)?
+   */
+  uchar *candidates;
+};
+
+/*!
+   \struct sidecar_headerT
+   \brief Block filters file header data structure.
+
+   This data structure is the header of a block filters file (the
+   sidecar of a large file). The file is cut in blocks which end at a
+   new line, and each block has a Bloom filter of its trigrams. The
+   header keeps the identity, the size and the modification time of
+   the file as it was read, so the sidecar is used only for the same
+   file, not changed since.
+*/
+struct sidecar_headerT
+{
+  /*!
+     \var magic
+     \brief The magic characters of a block filters file.
+   */
+  char magic[8];
+
+  /*!
+     \var word
+     \brief A known number (checks the byte order and the word size).
+   */
+  ulong word;
+
+  /*!
+     \var dev
+     \brief The device of the file.
+   */
+  ulong dev;
+
+  /*!
+     \var ino
+     \brief The inode of the file.
+   */
+  ulong ino;
+
+  /*!
+     \var data_size
+     \brief The size of the file.
+   */
+  ulong data_size;
+
+  /*!
+     \var mtime
+     \brief The modification time of the file (seconds).
+   */
+  long mtime;
+
+  /*!
+     \var mtime_nsec
+     \brief The modification time of the file (nanoseconds).
+   */
+  long mtime_nsec;
+
+  /*!
+     \var tail
+     \brief Not used (zero, it keeps the layout of older sidecars).
+   */
+  ulong tail;
+
+  /*!
+     \var num_blocks
+     \brief The number of the blocks.
+   */
+  ulong num_blocks;
+
+  /*!
+     \var blocks
+     \brief The offset of the blocks.
+   */
+  ulong blocks;
+
+  /*!
+     \var filters
+     \brief The offset of the Bloom filters.
+   */
+  ulong filters;
+
+  /*!
+     \var size
+     \brief The size of the block filters file.
+   */
+  ulong size;
+};
+
+/*!
+   \struct sidecar_blockT
+   \brief Filtered block data structure.
+
+   This data structure keeps a block of a file: its start, the
+   number of the new lines before it (so the line numbers of a
+   block are known without reading the blocks before it) and the
+   offset of its Bloom filter. The last block is a sentinel whose
+   start is the size of the file and whose offset is the end of the
+   filters.
+*/
+struct sidecar_blockT
+{
+  /*!
+     \var start
+     \brief The offset of the first character of the block.
+   */
+  ulong start;
+
+  /*!
+     \var lines
+     \brief The number of the new lines before the block.
+   */
+  ulong lines;
+
+  /*!
+     \var filter
+     \brief The offset of the Bloom filter in the filters.
+   */
+  ulong filter;
+};
+
+/*!
+   \struct sidecarT
+   \brief Block filters data structure.
+
+   This data structure keeps a mapped block filters file and the
+   admitted blocks of a run (the blocks which may contain a match).
+*/
+struct sidecarT
+{
+  /*!
+     \var map
+     \brief The mapped block filters file.
+   */
+  void *map;
+
+  /*!
+     \var map_size
+     \brief The size of the mapped block filters file.
+   */
+  size_t map_size;
+
+  /*!
+     \var header
+     \brief The header of the block filters file.
+   */
+  const struct sidecar_headerT *header;
+
+  /*!
+     \var blocks
+     \brief The blocks (and the sentinel).
+   */
+  const struct sidecar_blockT *blocks;
+
+  /*!
+     \var filters
+     \brief The Bloom filters.
+   */
+  const uchar *filters;
+
+  /*!
+     \var num_blocks
+     \brief The number of the filtered blocks of the file.
+   */
+  ulong num_blocks;
+
+  /*!
+     \var admitted
+     \brief Is each block admitted (may it contain a match)?
+   */
+  uchar *admitted;
+};
+
+/*
+ * type definitions.
+ */
+
+/*!
+   \typedef INDEX_HEADER
+   \brief Index file header data structure type definition.
+
+   This type definition is a synonym for
+   the index file header data structure.
+*/
+typedef struct index_headerT INDEX_HEADER;
+
+/*!
+   \typedef INDEX_FILE
+   \brief Indexed file data structure type definition.
+
+   This type definition is a synonym for
+   the indexed file data structure.
+*/
+typedef struct index_fileT INDEX_FILE;
+
+/*!
+   \typedef INDEX_GRAM
+   \brief Index trigram data structure type definition.
+
+   This type definition is a synonym for
+   the index trigram data structure.
+*/
+typedef struct index_gramT INDEX_GRAM;
+
+/*!
+   \typedef INDEX
+   \brief Trigram index data structure type definition.
+
+   This type definition is a synonym for
+   the trigram index data structure.
+*/
+typedef struct indexT INDEX;
+
+/*!
+   \typedef SIDECAR_HEADER
+   \brief Block filters file header data structure type definition.
+
+   This type definition is a synonym for
+   the block filters file header data structure.
+*/
+typedef struct sidecar_headerT SIDECAR_HEADER;
+
+/*!
+   \typedef SIDECAR_BLOCK
+   \brief Filtered block data structure type definition.
+
+   This type definition is a synonym for
+   the filtered block data structure.
+*/
+typedef struct sidecar_blockT SIDECAR_BLOCK;
+
+/*!
+   \typedef SIDECAR
+   \brief Block filters data structure type definition.
+
+   This type definition is a synonym for
+   the block filters data structure.
+*/
+typedef struct sidecarT SIDECAR;
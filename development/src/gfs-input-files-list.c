@@ -1,7 +1,7 @@
 /*
  *  `gfs-input-files-list.c'.
  *
- *  This interface deals with the input files linked list.
+ *  This interface deals with the input files list.
  *
  *  Copyright (C) 2008  Efstathios Chatzikyriakidis (stathis.chatzikyriakidis@gmail.com).
  *
@@ -21,39 +21,96 @@
 
 /*!
    \file gfs-input-files-list.c
-   \brief This interface deals with the input files linked list.
+   \brief This interface deals with the input files list.
 */
 
 /* standard includes. */
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/types.h>
 
 /* basic includes. */
 #include "gfs-defines.h"
 #include "gfs-typedefs.h"
 #include "gfs-input-files-list.h"
+#include "gfs-arena.h"
+
+/* enumeration constants. */
+
+/*!
+   \brief Constants used from the interface.
+
+   This anonymous enumeration is used from the
+   interface in order to specify some constants.
+*/
+enum
+{
+  MIN_FILES = 16                /*!< Initial size of the input files array. */
+};
 
 /* function prototypes. */
+INPUT_FILES *new_input_files (void);
 INPUT_FILE *new_input_file (const char *filepath);
-INPUT_FILE *add_input_file (INPUT_FILE * listp, INPUT_FILE * newp);
+BOOL add_input_file (INPUT_FILES * listp, const char *filepath);
 
 void print_input_files (FILE * stream, INPUT_FILES * listp);
 void free_input_files (INPUT_FILES * listp);
+void free_input_file (INPUT_FILE * node);
 
-BOOL input_file_exists (INPUT_FILES * listp, cstring filepath);
+BOOL input_file_seen (INPUT_FILES * listp, INPUT_FILE * node);
 ulong count_input_files (INPUT_FILES * listp);
+ulong input_files_memory (INPUT_FILES * listp);
+
+static void init_input_file (INPUT_FILE * node, char *path);
+static void grow_sets (INPUT_FILES * listp);
+static ulong *find_slot (INPUT_FILES * listp, ulong * set, const ulong hash,
+                         const char *filepath, const INPUT_FILE * node);
+static ulong hash_path (const char *filepath);
+static ulong hash_id (const INPUT_FILE * node);
 
 /* functions. */
 
+/*!
+   \fn INPUT_FILES * new_input_files (void)
+
+   \brief A function that creates a new empty input files list.
+
+   \return A pointer to a `INPUT_FILES' data structure.
+*/
+INPUT_FILES *
+new_input_files (void)
+{
+  /* externs. */
+
+  /* function externs. */
+  extern void *emalloc (size_t);
+  extern ARENA *new_arena (void);
+
+  INPUT_FILES *newp;
+
+  /* allocate enough memory space. */
+  newp = (INPUT_FILES *) emalloc (sizeof (INPUT_FILES));
+
+  newp->files = NULL;
+  newp->num_files = newp->max_files = 0L;
+  newp->paths = newp->ids = NULL;
+  newp->set_size = 0L;
+  newp->arena = new_arena ();
+
+  /* return the new list. */
+  return newp;
+}
+
 /*!
    \fn INPUT_FILE * new_input_file (const char *)
 
-   \brief A function that creates a new node for the input files linked list.
+   \brief A function that creates a new input file outside of a list.
 
    This function allocates enough memory for a new `INPUT_FILE' data
-   structure and then initializes it with `filepath'. After that, it
-   returns that new `INPUT_FILE' data structure.
+   structure and its path (in one block) and then initializes it with
+   `filepath'. After that, it returns that new `INPUT_FILE' data
+   structure (the caller releases it with `free_input_file').
 
    \param filepath a pointer to a constant character.
 
@@ -65,65 +122,84 @@ new_input_file (const char *filepath)
   /* externs. */
 
   /* function externs. */
-  extern char *estrdup (const char *);
   extern void *emalloc (size_t);
 
   INPUT_FILE *newp;
 
-  /* allocate enough memory space. */
-  newp = (INPUT_FILE *) emalloc (sizeof (INPUT_FILE));
+  /* the size of the path. */
+  const size_t n = strlen (filepath) + 1;
 
-  /* init the node list and store the string. */
-  newp->ptr = NULL;
-  newp->path = estrdup (filepath);
-  newp->next = NULL;
+  /* allocate enough memory space (the path follows the node). */
+  newp = (INPUT_FILE *) emalloc (sizeof (INPUT_FILE) + n);
 
-  /* return the new node item. */
+  init_input_file (newp, (char *) memcpy (newp + 1, filepath, n));
+
+  /* return the new input file. */
   return newp;
 }
 
 /*!
-   \fn INPUT_FILE * add_input_file (INPUT_FILE *, INPUT_FILE *)
+   \fn BOOL add_input_file (INPUT_FILES *, const char *)
 
-   \brief A function that adds a new node to the input files linked list.
+   \brief A function that adds an input file to the input files list.
 
-   This function adds to the end of the linked list `listp'
-   the node `newp' and then returns the head of the linked
-   list `listp'.
+   This function adds to the end of the list `listp' the input file
+   `filepath' in constant (amortized) time, unless the same path is
+   already in the list. It returns `true' if the input file is added.
+   Otherwise, it returns `false'.
 
-   \param listp a pointer to a `INPUT_FILE' data structure.
-   \param newp a pointer to a `INPUT_FILE' data structure.
+   \param listp a pointer to a `INPUT_FILES' data structure.
+   \param filepath a pointer to a constant character.
 
-   \return A pointer to a `INPUT_FILE' data structure.
+   \return A `BOOL' enumeration value (`false', `true').
 */
-INPUT_FILE *
-add_input_file (INPUT_FILE * listp, INPUT_FILE * newp)
+BOOL
+add_input_file (INPUT_FILES * listp, const char *filepath)
 {
-  INPUT_FILE *p;
+  /* externs. */
 
-  /* if the list is empty. */
-  if (listp == NULL)
-    return newp;
+  /* function externs. */
+  extern void *erealloc (void *, size_t);
+  extern char *arena_strdup (ARENA *, const char *);
 
-  /* go to the end of the list. */
-  for (p = listp; p->next != NULL; p = p->next)
-    continue;
+  /* the slot of the path. */
+  ulong *slot;
 
-  /* add to the end of the list `newp'. */
-  p->next = newp;
+  /* keep the hash sets at most half full. */
+  if (2 * (listp->num_files + 1) > listp->set_size)
+    grow_sets (listp);
 
-  /* return the list. */
-  return listp;
+  slot = find_slot (listp, listp->paths, hash_path (filepath), filepath,
+                    NULL);
+
+  /* has already occurred. */
+  if (*slot != 0)
+    return false;
+
+  /* grow the input files array. */
+  if (listp->num_files == listp->max_files)
+    {
+      listp->max_files = (listp->max_files ? 2 * listp->max_files
+                          : MIN_FILES);
+      listp->files = (INPUT_FILE *) erealloc (listp->files,
+                                              listp->max_files
+                                              * sizeof (INPUT_FILE));
+    }
+
+  init_input_file (&listp->files[listp->num_files],
+                   arena_strdup (listp->arena, filepath));
+  *slot = ++listp->num_files;
+
+  return true;
 }
 
 /*!
    \fn void print_input_files (FILE *, INPUT_FILES *)
 
-   \brief A function that prints the linked list input files.
+   \brief A function that prints the input files list.
 
    This function tries to print all the input files of the
-   list `listp' to the output `stream'. When it reaches the
-   end of the linked list it returns.
+   list `listp' to the output `stream'.
 
    \param stream a pointer to a `FILE' data structure.
    \param listp a pointer to a `INPUT_FILES' data structure.
@@ -131,76 +207,91 @@ add_input_file (INPUT_FILE * listp, INPUT_FILE * newp)
 void
 print_input_files (FILE * stream, INPUT_FILES * listp)
 {
-  /* walk through the linked list. */
-  while (listp != NULL)
-    {
-      /* print the input file path. */
-      fprintf (stream, " * [%s]%s", listp->path, NEW_LINE);
+  /* is used for the loop. */
+  register ulong i;
 
-      /* move to the next list node. */
-      listp = listp->next;
-    }
+  /* print the input file paths. */
+  for (i = 0L; i < count_input_files (listp); i++)
+    fprintf (stream, " * [%s]%s", listp->files[i].path, NEW_LINE);
 }
 
 /*!
    \fn void free_input_files (INPUT_FILES *)
 
-   \brief A function that deallocates the input files linked list.
+   \brief A function that deallocates the input files list.
 
-   This function tries to deallocate all the nodes from the
-   list `listp'. When all nodes are deallocated it returns.
+   This function deallocates the input files list `listp' (the
+   paths are released at once with their arena).
 
    \param listp a pointer to a `INPUT_FILES' data structure.
 */
 void
 free_input_files (INPUT_FILES * listp)
 {
-  /* walk through the linked list. */
-  while (listp != NULL)
-    {
-      INPUT_FILE *nextp = listp->next;
-      free (listp->path);
-      free (listp);
-      listp = nextp;
-    }
+  /* externs. */
+
+  /* function externs. */
+  extern void free_arena (ARENA *);
+
+  if (listp == NULL)
+    return;
+
+  free_arena (listp->arena);
+  free (listp->files);
+  free (listp->paths);
+  free (listp->ids);
+  free (listp);
 }
 
 /*!
-   \fn BOOL input_file_exists (INPUT_FILES *, cstring)
+   \fn void free_input_file (INPUT_FILE *)
 
-   \brief A function that look for an entry in the input files linked list.
+   \brief A function that deallocates an input file outside of a list.
 
-   This function parses all the input files linked list (`listp') and
-   checks if there is a previous entry of `filepath'. If it does, it
-   returns `true'. Otherwise, it returns `false'.
+   \param node a pointer to a `INPUT_FILE' data structure.
+*/
+void
+free_input_file (INPUT_FILE * node)
+{
+  /* the path is in the same block. */
+  free (node);
+}
+
+/*!
+   \fn BOOL input_file_seen (INPUT_FILES *, INPUT_FILE *)
+
+   \brief A function that checks if an opened input file is seen before.
+
+   This function checks if the opened input file `node' of the list
+   `listp' is the same file (the same device and inode) as a previous
+   opened input file of the list, under another path. If it is, it
+   returns `true'. Otherwise, the input file is remembered and it
+   returns `false'.
 
    \param listp a pointer to a `INPUT_FILES' data structure.
-   \param filepath a `cstring' type definition.
+   \param node a pointer to a `INPUT_FILE' data structure.
 
    \return A `BOOL' enumeration value (`false', `true').
 */
 BOOL
-input_file_exists (INPUT_FILES * listp, cstring filepath)
+input_file_seen (INPUT_FILES * listp, INPUT_FILE * node)
 {
-  /* walk through the linked list. */
-  while (listp != NULL)
-    {
-      /* has already occurred. */
-      if (!strcmp (filepath, listp->path))
-        return true;
+  /* the slot of the identity. */
+  ulong *slot = find_slot (listp, listp->ids, hash_id (node), NULL, node);
 
-      /* move to the next list node. */
-      listp = listp->next;
-    }
+  /* has already occurred. */
+  if (*slot != 0)
+    return true;
+
+  *slot = (ulong) (node - listp->files) + 1;
 
-  /* it is the first occurrence. */
   return false;
 }
 
 /*!
    \fn ulong count_input_files (INPUT_FILES *)
 
-   \brief A function that counts the length of the input files linked list.
+   \brief A function that counts the input files of the list.
    \param listp a pointer to a `INPUT_FILES' data structure.
 
    \return An unsigned long integer.
@@ -208,13 +299,175 @@ input_file_exists (INPUT_FILES * listp, cstring filepath)
 ulong
 count_input_files (INPUT_FILES * listp)
 {
-  /* the sum of nodes in the list. */
-  register ulong cnt;
+  return (listp != NULL ? listp->num_files : 0L);
+}
+
+/*!
+   \fn ulong input_files_memory (INPUT_FILES *)
+
+   \brief A function that returns the memory of the input files list.
+
+   This function returns the number of characters which the input
+   files list `listp' has allocated (the array, the hash sets and the
+   blocks of the paths).
+
+   \param listp a pointer to a `INPUT_FILES' data structure.
+
+   \return An unsigned long integer.
+*/
+ulong
+input_files_memory (INPUT_FILES * listp)
+{
+  if (listp == NULL)
+    return 0L;
+
+  return (ulong) (sizeof (INPUT_FILES) + sizeof (ARENA)
+                  + listp->max_files * sizeof (INPUT_FILE)
+                  + 2 * listp->set_size * sizeof (ulong)
+                  + listp->arena->reserved);
+}
+
+/*!
+   \fn static void init_input_file (INPUT_FILE *, char *)
+
+   \brief A function that initializes an input file with a path.
+
+   \param node a pointer to a `INPUT_FILE' data structure.
+   \param path a pointer to a character (the stored path).
+*/
+static void
+init_input_file (INPUT_FILE * node, char *path)
+{
+  /* init the input file and store the path. */
+  node->fd = -1;
+  node->size = 0;
+  node->path = path;
+  node->dev = 0;
+  node->ino = 0;
+}
+
+/*!
+   \fn static void grow_sets (INPUT_FILES *)
+
+   \brief A function that doubles the hash sets of the input files list.
+
+   \param listp a pointer to a `INPUT_FILES' data structure.
+*/
+static void
+grow_sets (INPUT_FILES * listp)
+{
+  /* externs. */
+
+  /* function externs. */
+  extern void *emalloc (size_t);
+
+  /* the old hash sets. */
+  ulong *paths = listp->paths, *ids = listp->ids;
+  const ulong old_size = listp->set_size;
+
+  /* is used for the loop. */
+  register ulong i;
+
+  listp->set_size = (old_size ? 2 * old_size : 2 * MIN_FILES);
+  listp->paths = (ulong *) emalloc (listp->set_size * sizeof (ulong));
+  listp->ids = (ulong *) emalloc (listp->set_size * sizeof (ulong));
+  memset (listp->paths, 0, listp->set_size * sizeof (ulong));
+  memset (listp->ids, 0, listp->set_size * sizeof (ulong));
+
+  /* insert again the indexes (all of them are distinct). */
+  for (i = 0L; i < old_size; i++)
+    {
+      if (paths[i] != 0)
+        *find_slot (listp, listp->paths,
+                    hash_path (listp->files[paths[i] - 1].path), NULL,
+                    NULL) = paths[i];
+
+      if (ids[i] != 0)
+        *find_slot (listp, listp->ids, hash_id (&listp->files[ids[i] - 1]),
+                    NULL, NULL) = ids[i];
+    }
+
+  free (paths);
+  free (ids);
+}
+
+/*!
+   \fn static ulong * find_slot (INPUT_FILES *, ulong *, const ulong, const char *, const INPUT_FILE *)
+
+   \brief A function that looks up a hash set of the input files list.
+
+   This function probes (linearly) the hash set `set' of the list
+   `listp' from the `hash' slot. It returns the slot of the input file
+   with the path `filepath' (if it is not NULL) or with the identity
+   of `node' (if it is not NULL), or the first empty slot. If both are
+   NULL, the first empty slot is returned.
+
+   \param listp a pointer to a `INPUT_FILES' data structure.
+   \param set a pointer to an unsigned long integer.
+   \param hash a constant unsigned long integer.
+   \param filepath a pointer to a constant character.
+   \param node a pointer to a constant `INPUT_FILE' data structure.
+
+   \return A pointer to an unsigned long integer.
+*/
+static ulong *
+find_slot (INPUT_FILES * listp, ulong * set, const ulong hash,
+           const char *filepath, const INPUT_FILE * node)
+{
+  /* the mask of the slots. */
+  const ulong mask = listp->set_size - 1;
+
+  /* the current slot and its input file. */
+  register ulong i;
+  const INPUT_FILE *p;
+
+  for (i = hash & mask; set[i] != 0; i = (i + 1) & mask)
+    {
+      p = &listp->files[set[i] - 1];
+
+      if (filepath != NULL && !strcmp (p->path, filepath))
+        break;
+
+      if (node != NULL && p->dev == node->dev && p->ino == node->ino)
+        break;
+    }
+
+  return &set[i];
+}
+
+/*!
+   \fn static ulong hash_path (const char *)
 
-  /* count the nodes of the list. */
-  for (cnt = 0L; listp != NULL; cnt++)
-    listp = listp->next;
+   \brief A function that hashes a path (FNV-1a).
+
+   \param filepath a pointer to a constant character.
+
+   \return An unsigned long integer.
+*/
+static ulong
+hash_path (const char *filepath)
+{
+  register ulong h = 2166136261UL;
+
+  while (*filepath != '\0')
+    h = (h ^ (uchar) * filepath++) * 16777619UL;
+
+  return h;
+}
+
+/*!
+   \fn static ulong hash_id (const INPUT_FILE *)
+
+   \brief A function that hashes the identity of an input file.
+
+   \param node a pointer to a constant `INPUT_FILE' data structure.
+
+   \return An unsigned long integer.
+*/
+static ulong
+hash_id (const INPUT_FILE * node)
+{
+  register ulong h = (ulong) node->ino * 2654435761UL;
 
-  /* return nodes list counter. */
-  return cnt;
+  return (h ^ (h >> 16)) + (ulong) node->dev;
 }
@@ -63,20 +63,29 @@ enum file_infoT
    \struct input_fileT
    \brief Input file node data structure.
 
-   This data structure is used for the
-   input files linked list as a node.
+   This data structure is used for
+   an input file of the input files list.
 */
 struct input_fileT
 {
   /*!
-     \var ptr
-     \brief Input file pointer.
+     \var fd
+     \brief Input file descriptor.
 
-     This is a pointer to an input file. The program
-     uses this pointer in order to open and read the
-     contents of an input file.
+     This is the descriptor of an open input file (or -1).
+     The program uses this descriptor in order to classify
+     and read the contents of an input file.
    */
-  FILE *ptr;
+  int fd;
+
+  /*!
+     \var size
+     \brief Input file size.
+
+     This is the size of an open regular input file. The
+     program uses this size in order to map the input file.
+   */
+  off_t size;
 
   /*!
      \var path
@@ -89,13 +98,93 @@ struct input_fileT
   char *path;
 
   /*!
-     \var next
-     \brief Next input file node.
+     \var dev
+     \brief Input file device.
+
+     This is the device of an opened input file. The program
+     uses it (with the inode) in order to search the same file
+     under different paths only once.
+   */
+  dev_t dev;
+
+  /*!
+     \var ino
+     \brief Input file inode.
+
+     This is the inode of an opened input file.
+   */
+  ino_t ino;
+
+  /*!
+     \var mtime
+     \brief Input file modification time (seconds).
+
+     This is the modification time of an open regular input
+     file. The program uses it (with the size) in order to know
+     if an indexed input file is changed.
+   */
+  long mtime;
+
+  /*!
+     \var mtime_nsec
+     \brief Input file modification time (nanoseconds).
+   */
+  long mtime_nsec;
+};
+
+/*!
+   \struct input_filesT
+   \brief Input files list data structure.
+
+   This data structure keeps the input files in a dynamic array (in
+   the order of the command line) and two open addressing hash sets
+   of their indexes: one by path and one by identity (device and
+   inode, for the input files which are opened). The paths are packed
+   in an arena, so the whole list is a few large blocks.
+*/
+struct input_filesT
+{
+  /*!
+     \var files
+     \brief The input files.
+   */
+  struct input_fileT *files;
+
+  /*!
+     \var num_files
+     \brief The number of the input files.
+   */
+  ulong num_files;
+
+  /*!
+     \var max_files
+     \brief The size of the input files array.
+   */
+  ulong max_files;
+
+  /*!
+     \var paths
+     \brief The hash set by path (index + 1, or 0 for an empty slot).
+   */
+  ulong *paths;
+
+  /*!
+     \var ids
+     \brief The hash set by identity (index + 1, or 0 for an empty slot).
+   */
+  ulong *ids;
 
-     This is a pointer to the next input
-     file in the input files linked list.
+  /*!
+     \var set_size
+     \brief The size of the hash sets (a power of two).
+   */
+  ulong set_size;
+
+  /*!
+     \var arena
+     \brief The arena of the paths of the input files.
    */
-  struct input_fileT *next;
+  struct arenaT *arena;
 };
 
 /*
@@ -118,7 +207,7 @@ typedef enum file_infoT FILE_INFO;
    This type definition is a synonym
    for the input file data structure.
 
-   `INPUT_FILE' (seems to be a node of a linked list).
+   `INPUT_FILE' (seems to be an element of the input files list).
 */
 typedef struct input_fileT INPUT_FILE;
 
@@ -129,6 +218,6 @@ typedef struct input_fileT INPUT_FILE;
    This type definition is a synonym
    for the input file data structure.
 
-   `INPUT_FILES' (seems to be the head of a linked list).
+   `INPUT_FILES' (seems to be the whole input files list).
 */
-typedef struct input_fileT INPUT_FILES;
+typedef struct input_filesT INPUT_FILES;
@@ -27,7 +27,9 @@
 /* standard includes. */
 #include <stdio.h>
 #include <unistd.h>
+#include <fcntl.h>
 #include <ctype.h>
+#include <sys/types.h>
 #include <sys/stat.h>
 #include <errno.h>
 
@@ -35,198 +37,180 @@
 #include "gfs-typedefs.h"
 #include "gfs-input-files-list.h"
 
+/*!
+   \brief Constants used from the interface.
+
+   This anonymous enumeration is used from the
+   interface in order to specify some constants.
+*/
+enum
+{
+  BIN_BUF_LEN = 512                /*!< Binary buffer length. */
+};
+
 /* function prototypes. */
-FILE_INFO check_input_file (cstring filepath);
-static FILE_INFO get_file_type (cstring filepath);
-static FILE_INFO file_regular (cstring filepath);
+FILE_INFO open_input_file (INPUT_FILE * node);
+void close_input_file (INPUT_FILE * node);
+FILE_INFO sniff_input_file (const uchar * p, size_t n);
+static FILE_INFO get_file_type (const mode_t mode);
 
 /* functions. */
 
 /*!
-   \fn FILE_INFO check_input_file (cstring)
+   \fn FILE_INFO open_input_file (INPUT_FILE *)
 
-   \brief A function that checks if a file is acceptable.
+   \brief A function that opens an input file and checks if it is acceptable.
 
-   This function checks if a file (`filepath') is acceptable.
-   That means, that it is a readable and regular ascii file.
+   This function opens an input file (`node') and checks its type on
+   the open descriptor, so the file is looked up only once. If it is
+   a regular file, the descriptor and the size of the file are kept
+   in `node' and it returns `f_regular' (the caller sniffs the first
+   block for binary data). Otherwise, the file is closed and its info
+   is returned. The files which do not exist or we cannot access are
+   silently skipped, but the other errors are reported.
 
-   \param filepath a `cstring' type definition.
+   \param node a pointer to a `INPUT_FILE' data structure.
 
    \return A `FILE_INFO' enumeration value.
 */
 FILE_INFO
-check_input_file (cstring filepath)
+open_input_file (INPUT_FILE * node)
 {
-  /* is used for system's routine `access'. */
-  register int aval;
+  /* externs. */
+
+  /* function externs. */
+  extern void weprintf (char *, ...);
+
+  /* buffer for keeping file info. */
+  struct stat stbuf;
 
   /* is used in order to know the info of the file. */
   FILE_INFO finfo;
 
-  /* check if the file exists. */
-  aval = access (filepath, F_OK);
-  if (aval != 0)
+  /* a named pipe must not block the open. */
+  node->fd = open (node->path, O_RDONLY | O_NOCTTY | O_NONBLOCK);
+
+  if (node->fd == -1)
     {
       if (errno == ENOENT)
         return f_unknown;        /* file doesn't exist. */
       else if (errno == EACCES)
         return f_inaccessible;        /* we cannot access it. */
-      else
-        return f_io_error;        /* an i/o problem occured. */
+
+      /* print a warning why the file can't open. */
+      weprintf ("open(\"%.500s\") failed:", node->path);
+
+      return f_io_error;        /* an i/o problem occured. */
     }
 
-  /* check if the file is readable. */
-  aval = access (filepath, R_OK);
-  if (aval != 0)
-    /* we cannot read it. */
-    return f_inaccessible;
+  /* get the info of the open file. */
+  if (fstat (node->fd, &stbuf) == -1)
+    finfo = f_io_error;
   else
     {
-      /* get the info of the file. */
-      finfo = get_file_type (filepath);
-
-      /* if it is a regular file. */
-      if (finfo == f_regular)
-        {
-          /* get the type of regular
-             file (ascii or binary). */
-          finfo = file_regular (filepath);
-          if (finfo == f_ascii)
-            /* we accept the input file. */
-            return f_accessible;
-          else
-            /* return the info of the file. */
-            return finfo;
-        }
-      else
-        /* return the info of the file. */
-        return finfo;
+      finfo = get_file_type (stbuf.st_mode);
+
+      /* the identity of the file. */
+      node->dev = stbuf.st_dev;
+      node->ino = stbuf.st_ino;
     }
 
-  /* if the control flow reaches
-     here do not accept the file. */
-  return f_inaccessible;
+  /* accept only regular files. */
+  if (finfo != f_regular)
+    {
+      close_input_file (node);
+      return finfo;
+    }
+
+  node->size = stbuf.st_size;
+  node->mtime = (long) stbuf.st_mtim.tv_sec;
+  node->mtime_nsec = stbuf.st_mtim.tv_nsec;
+
+  return f_regular;
 }
 
 /*!
-   \brief Constants used from the interface.
+   \fn void close_input_file (INPUT_FILE *)
 
-   This anonymous enumeration is used from the
-   interface in order to specify some constants.
+   \brief A function that closes an open input file.
+
+   \param node a pointer to a `INPUT_FILE' data structure.
 */
-enum
+void
+close_input_file (INPUT_FILE * node)
 {
-  BIN_BUF_LEN = 512                /*!< Binary buffer length. */
-};
+  if (node->fd != -1)
+    {
+      close (node->fd);
+      node->fd = -1;
+    }
+}
 
 /*!
-   \fn static FILE_INFO file_regular (cstring)
+   \fn FILE_INFO sniff_input_file (const uchar *, size_t)
 
    \brief A function that checks if a file is binary or not.
 
-   This function checks if an input file (`filepath') is binary or
-   ascii. Specifically, it reads the first `BIN_BUF_LEN' characters
-   of the file and checks if there are any non ascii characters. If
-   there is at least one, then returns that the file is binary. But,
-   if there aren't any non-ascii characters then, returns that the
-   file is ascii.
+   This function checks if the first block (`p' of `n' characters)
+   of an input file is binary or ascii. Specifically, it checks the
+   first `BIN_BUF_LEN' characters of the block and if there are any
+   non ascii characters. If there is at least one, then returns that
+   the file is binary. But, if there aren't any non-ascii characters
+   then, returns that the file is ascii. The block may be shorter
+   (small files).
 
-   \param filepath a `cstring' type definition.
+   \param p a pointer to a constant unsigned character.
+   \param n a `size_t' type definition.
 
    \return A `FILE_INFO' enumeration value.
 */
-static FILE_INFO
-file_regular (cstring filepath)
+FILE_INFO
+sniff_input_file (const uchar * p, size_t n)
 {
-  /* externs. */
-
-  /* function externs. */
-  extern FILE *efopen (const char *, const char *);
-
-  /* the buffer of characters. */
-  static uchar buf[BIN_BUF_LEN];
-
   /* temporary help variables. */
-  register ulong i, n;
-
-  /* this is a pointer to the file. */
-  FILE *fp = NULL;
+  register size_t i;
 
-  /* try to open the file. */
-  if ((fp = efopen (filepath, "r")) == NULL)
-    /* an error occured. */
-    return f_io_error;
-
-  /* try to read from the file. */
-  n = fread (buf, sizeof (buf[0]), sizeof (buf), fp);
-
-  /* there was a problem with the reading. */
-  if (n < BIN_BUF_LEN)
-    {
-      /* close the file. */
-      if (fp != NULL)
-        fclose (fp);
-
-      /* an error occured. */
-      return f_io_error;
-    }
+  if (n > BIN_BUF_LEN)
+    n = BIN_BUF_LEN;
 
   /* check each character if it is binary. */
-  for (i = 0L; i < n; i++)
-    if (!isprint (buf[i]) &&        /* is not printable character. */
-        !isspace (buf[i]) &&        /* is not a space character. */
-        !ispunct (buf[i]) &&        /* is not a punctuation character. */
-        !isalnum (buf[i]) &&        /* is not an alphabetic, digit character. */
-        iscntrl (buf[i]))        /* is a control character. */
-      {
-        /* close the file. */
-        if (fp != NULL)
-          fclose (fp);
-
-        /* the file is a regular binary file. */
-        return f_binary;
-      }
-
-  /* close the file. */
-  if (fp != NULL)
-    fclose (fp);
+  for (i = 0; i < n; i++)
+    if (!isprint (p[i]) &&        /* is not printable character. */
+        !isspace (p[i]) &&        /* is not a space character. */
+        !ispunct (p[i]) &&        /* is not a punctuation character. */
+        !isalnum (p[i]) &&        /* is not an alphabetic, digit character. */
+        iscntrl (p[i]))        /* is a control character. */
+      /* the file is a regular binary file. */
+      return f_binary;
 
   /* the file is a regular ascii file. */
   return f_ascii;
 }
 
 /*!
-   \fn static FILE_INFO get_file_type (cstring)
+   \fn static FILE_INFO get_file_type (const mode_t)
 
    \brief A function that gets the type of a file.
 
-   This function tries to get the type of a file
-   (`filepath'). After that, it returns the type.
+   This function returns the type of a file from its `mode'.
 
-   \param filepath a `cstring' type definition.
+   \param mode a constant `mode_t' type definition.
 
    \return A `FILE_INFO' enumeration value.
 */
 static FILE_INFO
-get_file_type (cstring filepath)
+get_file_type (const mode_t mode)
 {
-  /* buffer for keeping file info. */
-  struct stat stbuf;
-
-  /* get the information of the file. */
-  if (stat (filepath, &stbuf) == -1)
-    return f_io_error;
-
   /* return the appropriate type of the file. */
-  if (S_ISREG (stbuf.st_mode))
+  if (S_ISREG (mode))
     return f_regular;
-  else if (S_ISDIR (stbuf.st_mode))
+  else if (S_ISDIR (mode))
     return f_directory;
-  else if (S_ISBLK (stbuf.st_mode))
+  else if (S_ISBLK (mode))
     return f_block;
-  else if (S_ISCHR (stbuf.st_mode))
+  else if (S_ISCHR (mode))
     return f_character;
-  else if (S_ISFIFO (stbuf.st_mode))
+  else if (S_ISFIFO (mode))
     return f_fifo;
 
   /* if the control flow reaches
@@ -0,0 +1,145 @@
+/*
+ *  `gfs-map-guard.c'.
+ *
+ *  This interface deals with the bus errors of the mapped files.
+ *
+ *  Copyright (C) 2008  Efstathios Chatzikyriakidis (stathis.chatzikyriakidis@gmail.com).
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*!
+   \file gfs-map-guard.c
+   \brief This interface deals with the bus errors of the mapped files.
+*/
+
+/* standard includes. */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <setjmp.h>
+#include <pthread.h>
+
+/* basic includes. */
+#include "gfs-typedefs.h"
+
+/* static variables. */
+
+/*!
+   \var guard_once
+   \brief The once control of the guard.
+*/
+static pthread_once_t guard_once = PTHREAD_ONCE_INIT;
+
+/*!
+   \var guard_key
+   \brief The key of the jump buffer of each guarded thread.
+*/
+static pthread_key_t guard_key;
+
+/* function prototypes. */
+BOOL run_guarded (void (*func) (void *), void *arg);
+static void init_guard (void);
+static void map_fault (int sig);
+
+/* functions. */
+
+/*!
+   \fn BOOL run_guarded (void (*) (void *), void *)
+
+   \brief A function that runs a reader of mapped files on this thread.
+
+   This function calls `func' with `arg'. If a mapped file shrinks
+   while it is read (a truncated file, or a rotated log which is
+   rewritten in place), its pages past the new end fault with a bus
+   error. Then, the reader is cut short at the fault (the rest of the
+   file is taken as its end) and it returns `false'. Otherwise, it
+   returns `true'. A bus error out of a guarded reader kills the
+   program as before.
+
+   \param func a pointer to a function.
+   \param arg a pointer to void.
+
+   \return A `BOOL' enumeration value (`false', `true').
+*/
+BOOL
+run_guarded (void (*func) (void *), void *arg)
+{
+  /* the jump buffer of the reader. */
+  sigjmp_buf fault;
+
+  /* the jump buffer of an outer reader. */
+  void *outer;
+
+  pthread_once (&guard_once, init_guard);
+  outer = pthread_getspecific (guard_key);
+
+  if (sigsetjmp (fault, 1) != 0)
+    {
+      pthread_setspecific (guard_key, outer);
+      return false;
+    }
+
+  pthread_setspecific (guard_key, (void *) &fault);
+  func (arg);
+  pthread_setspecific (guard_key, outer);
+
+  return true;
+}
+
+/*!
+   \fn static void init_guard (void)
+
+   \brief A function that catches the bus errors (once).
+*/
+static void
+init_guard (void)
+{
+  /* the action of the bus errors. */
+  struct sigaction sa;
+
+  pthread_key_create (&guard_key, NULL);
+
+  memset (&sa, 0, sizeof (sa));
+  sa.sa_handler = map_fault;
+  sigemptyset (&sa.sa_mask);
+  sigaction (SIGBUS, &sa, NULL);
+}
+
+/*!
+   \fn static void map_fault (int)
+
+   \brief A function that handles a bus error.
+
+   This function jumps back to the reader of this thread. Out of a
+   reader, it restores the default action, so the faulting access
+   kills the program when it runs again.
+
+   \param sig an integer value.
+*/
+static void
+map_fault (int sig)
+{
+  /* the jump buffer of the reader. */
+  sigjmp_buf *fault = (sigjmp_buf *) pthread_getspecific (guard_key);
+
+  if (fault == NULL)
+    {
+      signal (sig, SIG_DFL);
+      return;
+    }
+
+  siglongjmp (*fault, 1);
+}
@@ -92,6 +92,144 @@ cstring license_part_c =
 cstring usage_specify_pattern = N_(
  "You must specify a search pattern. See `--help' for details.");
 
+/*!
+   \var usage_unknown_kernel
+   \brief An unknown search kernel informative message.
+*/
+cstring usage_unknown_kernel = N_(
+ "Unknown or unsupported search kernel `%s'.");
+
+/*!
+   \var usage_too_many_patterns
+   \brief A too many patterns informative message.
+*/
+cstring usage_too_many_patterns = N_(
+ "The patterns are too many or too long.");
+
+/*!
+   \var usage_invalid_jobs
+   \brief An invalid number of jobs informative message.
+*/
+cstring usage_invalid_jobs = N_(
+ "Invalid number of jobs `%s'.");
+
+/*!
+   \var usage_invalid_count
+   \brief An invalid max count informative message.
+*/
+cstring usage_invalid_count = N_(
+ "Invalid max count `%s'.");
+
+/*!
+   \var usage_invalid_bytes
+   \brief An invalid max line bytes informative message.
+*/
+cstring usage_invalid_bytes = N_(
+ "Invalid max line bytes `%s'.");
+
+/*!
+   \var usage_invalid_context
+   \brief An invalid context length informative message.
+*/
+cstring usage_invalid_context = N_(
+ "Invalid context length `%s'.");
+
+/*!
+   \var usage_invalid_regex
+   \brief An invalid regular expression informative message.
+*/
+cstring usage_invalid_regex = N_(
+ "Invalid regular expression `%.500s': %s.");
+
+/*!
+   \var regex_unmatched_paren
+   \brief A reason of an invalid regular expression.
+*/
+cstring regex_unmatched_paren = N_("Unmatched (");
+
+/*!
+   \var regex_unmatched_bracket
+   \brief A reason of an invalid regular expression.
+*/
+cstring regex_unmatched_bracket = N_("Unmatched [ or [^");
+
+/*!
+   \var regex_invalid_class
+   \brief A reason of an invalid regular expression.
+*/
+cstring regex_invalid_class = N_("Invalid character class name");
+
+/*!
+   \var regex_invalid_range
+   \brief A reason of an invalid regular expression.
+*/
+cstring regex_invalid_range = N_("Invalid range end");
+
+/*!
+   \var regex_invalid_interval
+   \brief A reason of an invalid regular expression.
+*/
+cstring regex_invalid_interval = N_("Invalid content of {}");
+
+/*!
+   \var regex_trailing_backslash
+   \brief A reason of an invalid regular expression.
+*/
+cstring regex_trailing_backslash = N_("Trailing backslash");
+
+/*!
+   \var regex_back_reference
+   \brief A reason of an invalid regular expression.
+*/
+cstring regex_back_reference = N_("Back-references are not supported");
+
+/*!
+   \var regex_word_anchor
+   \brief A reason of an invalid regular expression.
+*/
+cstring regex_word_anchor = N_("Word and buffer anchors are not supported");
+
+/*!
+   \var regex_too_big
+   \brief A reason of an invalid regular expression.
+*/
+cstring regex_too_big = N_("Regular expression too big");
+
+/*!
+   \var usage_index_command
+   \brief An invalid index command informative message.
+*/
+cstring usage_index_command = N_(
+ "Invalid index command. See `--help' for details.");
+
+/*!
+   \var usage_not_directory
+   \brief A not a directory informative message.
+*/
+cstring usage_not_directory = N_(
+ "`%.500s' is not a directory.");
+
+/*!
+   \var usage_not_regular
+   \brief A not a regular file informative message.
+*/
+cstring usage_not_regular = N_(
+ "`%.500s' is not a regular file.");
+
+/*!
+   \var usage_invalid_index
+   \brief An invalid index file informative message.
+*/
+cstring usage_invalid_index = N_(
+ "Invalid index file `%.500s'.");
+
+/*!
+   \var usage_too_many_files
+   \brief A too many files informative message.
+*/
+cstring usage_too_many_files = N_(
+ "The files of the index are too many.");
+
 /*!
    \var usage_part_a
    \brief A long usage informative message (part a).
@@ -104,6 +242,18 @@ cstring usage_part_a = N_("Usage:");
 */
 cstring usage_part_b = N_("[OPTIONS] -e PATTERN [FILE...]");
 
+/*!
+   \var usage_part_g
+   \brief A long usage informative message (part g).
+*/
+cstring usage_part_g = N_("index build|update DIR [INDEX]");
+
+/*!
+   \var usage_part_h
+   \brief A long usage informative message (part h).
+*/
+cstring usage_part_h = N_("index blocks FILE...");
+
 /*!
    \var usage_part_c
    \brief A long usage informative message (part c).
@@ -113,14 +263,54 @@ cstring usage_part_c = N_(
  "  -m, --max-matches       Show the max number of matches.     \n"
  "  -n, --line-number       Prefix each line with a number.     \n"
  "  -i, --ignore-case       Ignore case distinctions.           \n"
- "  -e, --pattern=PATTERN   Input matching pattern.             \n");
+ "  -e, --pattern=PATTERN   Input matching pattern (repeatable).\n"
+ "  -f, --file=FILE         Input matching patterns from FILE.  \n"
+ "  -E, --extended-regexp   The patterns are extended regexps.  \n");
 
 /*!
    \var usage_part_d
    \brief A long usage informative message (part d).
 */
 cstring usage_part_d = N_(
+ "  -q, --quiet             Print nothing, stop at first match. \n"
+ "  -l, --files-with-matches                                    \n"
+ "                          Print only the paths with matches.  \n"
+ "  -M, --max-count=N       Stop a file after N selected lines. \n"
+ "  -c, --count             Print only the number of the lines. \n"
+ "  -A, --after-context=N   Print N lines after selected lines. \n"
+ "  -B, --before-context=N  Print N lines before selected lines.\n"
+ "  -C, --context=N         Print N lines around selected lines.\n");
+
+/*!
+   \var usage_part_e
+   \brief A long usage informative message (part e).
+*/
+cstring usage_part_e = N_(
+ "  -j, --jobs=N            Search N input files in parallel.   \n"
+ "  -R, --recursive         Search the files under directories. \n"
+ "      --files-from=FILE   Read the input file names from FILE.\n"
+ "  -0, --null              The names of FILE end with a null.  \n"
+ "      --max-line-bytes=N  Search longer lines in parts.       \n");
+
+/*!
+   \var usage_part_i
+   \brief A long usage informative message (part i).
+*/
+cstring usage_part_i = N_(
+ "      --index=INDEX       Skip the files INDEX rules out.     \n"
+ "      --blocks            Read only the blocks which the      \n"
+ "                          FILE.gfs-blocks filters admit.      \n"
+ "      --cache=DIR         Keep the results in DIR for the     \n"
+ "                          unchanged files.                    \n");
+
+/*!
+   \var usage_part_f
+   \brief A long usage informative message (part f).
+*/
+cstring usage_part_f = N_(
  "  -v, --verbose           Explain what is being done.         \n"
+ "      --kernel=NAME       Use a search kernel (auto, libc,    \n"
+ "                          sse2, avx2).                        \n"
  "                                                              \n"
  "      --help, --usage     Display this help and exit.         \n"
  "      --version           Print version information and exit. \n"
@@ -148,3 +338,33 @@ cstring show_search_files = N_("Search files:");
    \brief A message for number of matches.
 */
 cstring show_max_matches  = N_("Number of matches:");
+
+/*!
+   \var show_num_lines
+   \brief A message for number of selected lines.
+*/
+cstring show_num_lines    = N_("Number of selected lines:");
+
+/*!
+   \var show_total_lines
+   \brief A message for total number of selected lines.
+*/
+cstring show_total_lines  = N_("Total selected lines:");
+
+/*!
+   \var show_standard_input
+   \brief A name for the standard input.
+*/
+cstring show_standard_input = N_("(standard input)");
+
+/*!
+   \var show_peak_memory
+   \brief A message for the peak memory.
+*/
+cstring show_peak_memory  = N_("Peak memory (Kbytes):");
+
+/*!
+   \var show_list_memory
+   \brief A message for the memory of the input files list.
+*/
+cstring show_list_memory  = N_("Input files list memory (Kbytes):");
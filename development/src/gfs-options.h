@@ -84,13 +84,199 @@ struct optionsT
   BOOL ignore_case;
 
   /*!
-     \var pattern
-     \brief Input pattern variable.
+     \var patterns
+     \brief Input patterns variable.
 
-     This variable is used in order
-     to input the matching pattern.
+     This variable is used in order to input the
+     matching patterns (a line matches if any of
+     them occurs in it).
+   */
+  char **patterns;
+
+  /*!
+     \var pattern_lens
+     \brief Input patterns lengths variable.
+
+     This variable is used in order to keep the
+     lengths of the matching patterns.
+   */
+  size_t *pattern_lens;
+
+  /*!
+     \var num_patterns
+     \brief Number of input patterns variable.
+
+     This variable is used in order to keep
+     the number of the matching patterns.
+   */
+  ulong num_patterns;
+
+  /*!
+     \var pattern_file
+     \brief Patterns file variable.
+
+     This variable is used in order to know if the
+     patterns were read from a file (maybe none).
+   */
+  BOOL pattern_file;
+
+  /*!
+     \var regex
+     \brief Regular expressions variable.
+
+     This variable is used in order to match the patterns
+     as extended regular expressions (instead of strings).
+   */
+  BOOL regex;
+
+  /*!
+     \var kernel
+     \brief Substring search kernel variable.
+
+     This variable is used in order to select the substring
+     search kernel by name (NULL selects it at runtime).
+   */
+  char *kernel;
+
+  /*!
+     \var jobs
+     \brief Number of jobs variable.
+
+     This variable is used in order to search many input files
+     in parallel (0 follows the processors of the program).
+   */
+  ulong jobs;
+
+  /*!
+     \var recursive
+     \brief Recursive search variable.
+
+     This variable is used in order to search
+     the files under the directory operands.
+   */
+  BOOL recursive;
+
+  /*!
+     \var files_from
+     \brief File list variable.
+
+     This variable is used in order to read the names of
+     the input files from a file ("-" is the standard input).
+   */
+  char *files_from;
+
+  /*!
+     \var null_names
+     \brief Null delimited names variable.
+
+     This variable is used in order to delimit the names
+     of the file list with null characters.
+   */
+  BOOL null_names;
+
+  /*!
+     \var quiet
+     \brief Quiet variable.
+
+     This variable is used in order to print nothing and to
+     stop the search at the first match (the exit status).
+   */
+  BOOL quiet;
+
+  /*!
+     \var list_files
+     \brief Print only the paths variable.
+
+     This variable is used in order to print only the paths of
+     the input files with matches (each one stops at its first).
+   */
+  BOOL list_files;
+
+  /*!
+     \var max_count
+     \brief Max selected lines variable.
+
+     This variable is used in order to stop the search of an
+     input after a number of selected lines (0 for no limit).
+   */
+  ulong max_count;
+
+  /*!
+     \var count_only
+     \brief Count only variable.
+
+     This variable is used in order to print only the number of
+     the selected lines of each input (and their total).
+   */
+  BOOL count_only;
+
+  /*!
+     \var max_line_bytes
+     \brief Max line bytes variable.
+
+     This variable is used in order to search the longer lines
+     of a stream in parts (0 for no limit), so their memory is
+     bounded.
+   */
+  ulong max_line_bytes;
+
+  /*!
+     \var after_context
+     \brief After context variable.
+
+     This variable is used in order to print a number
+     of lines after each selected line.
+   */
+  ulong after_context;
+
+  /*!
+     \var before_context
+     \brief Before context variable.
+
+     This variable is used in order to print a number
+     of lines before each selected line.
+   */
+  ulong before_context;
+
+  /*!
+     \var context
+     \brief Context variable.
+
+     This variable is used in order to print the lines around
+     the selected lines (even none, then only the separators
+     of the groups of lines are printed).
+   */
+  BOOL context;
+
+  /*!
+     \var index
+     \brief Index file variable.
+
+     This variable is used in order to skip the input files which
+     the trigrams of an index file rule out (NULL for no index).
+   */
+  char *index;
+
+  /*!
+     \var blocks
+     \brief Block filters variable.
+
+     This variable is used in order to read only the blocks of the
+     input files which their block filters (`FILE.gfs-blocks', if
+     they are up to date) admit.
+   */
+  BOOL blocks;
+
+  /*!
+     \var cache
+     \brief Result cache directory variable.
+
+     This variable is used in order to keep the results of the
+     searches in a directory, so the input files which are not
+     changed (or only appended) since are not searched again (NULL
+     for no result cache).
    */
-  char *pattern;
+  char *cache;
 };
 
 /*
@@ -0,0 +1,381 @@
+/*
+ *  `gfs-output-buffer.c'.
+ *
+ *  This interface deals with the buffered output.
+ *
+ *  Copyright (C) 2008  Efstathios Chatzikyriakidis (stathis.chatzikyriakidis@gmail.com).
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*!
+   \file gfs-output-buffer.c
+   \brief This interface deals with the buffered output.
+*/
+
+/* standard includes. */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+
+/* basic includes. */
+#include "gfs-typedefs.h"
+#include "gfs-output-buffer.h"
+
+/* enumeration constants. */
+
+/*!
+   \brief Constants used from the interface.
+
+   This anonymous enumeration is used from the
+   interface in order to specify some constants.
+*/
+enum
+{
+  OUTPUT_SIZE = 256 * 1024,     /*!< Output buffer characters (256Kbytes). */
+  MEMORY_SIZE = 4 * 1024,       /*!< Initial memory buffer characters. */
+  MAX_DIGITS = 24               /*!< Max digits of an unsigned long. */
+};
+
+/* function prototypes. */
+OUTPUT_BUFFER *new_output_buffer (const int fd);
+void free_output_buffer (OUTPUT_BUFFER * out);
+void output_write (OUTPUT_BUFFER * out, const void *p, size_t n);
+void output_string (OUTPUT_BUFFER * out, const char *str);
+void output_number (OUTPUT_BUFFER * out, ulong num);
+void output_commit (OUTPUT_BUFFER * out);
+void output_flush (OUTPUT_BUFFER * out);
+static void reserve (OUTPUT_BUFFER * out, size_t n);
+static void write_all (const int fd, struct iovec *iov, int cnt);
+static void touch_pages (const struct iovec *iov, int cnt);
+
+/* functions. */
+
+/*!
+   \fn OUTPUT_BUFFER * new_output_buffer (const int)
+
+   \brief A function that returns a new `OUTPUT_BUFFER' data structure.
+
+   This function allocates a new output buffer for the file descriptor
+   `fd' (or a growing memory buffer if `fd' is -1). If `fd' is the
+   standard output, the pending output of the standard I/O library is
+   flushed first, so that the order of the output is kept.
+
+   \param fd a constant integer value.
+
+   \return A pointer to a `OUTPUT_BUFFER' data structure.
+*/
+OUTPUT_BUFFER *
+new_output_buffer (const int fd)
+{
+  /* externs. */
+
+  /* function externs. */
+  extern void *emalloc (size_t);
+
+  OUTPUT_BUFFER *newp;
+
+  /* allocate enough memory space. */
+  newp = (OUTPUT_BUFFER *) emalloc (sizeof (OUTPUT_BUFFER));
+
+  newp->fd = fd;
+  newp->line_buffered = (fd >= 0 && isatty (fd) ? true : false);
+  newp->size = (fd >= 0 ? OUTPUT_SIZE : MEMORY_SIZE);
+  newp->buf = (char *) emalloc (newp->size);
+  newp->len = 0;
+
+  if (fd == STDOUT_FILENO)
+    fflush (stdout);
+
+  /* return the buffer pointer. */
+  return newp;
+}
+
+/*!
+   \fn void free_output_buffer (OUTPUT_BUFFER *)
+
+   \brief A function that deallocates an `OUTPUT_BUFFER' data structure.
+
+   This function writes the pending output of the buffer (`out') and
+   deallocates it.
+
+   \param out a pointer to a `OUTPUT_BUFFER' data structure.
+*/
+void
+free_output_buffer (OUTPUT_BUFFER * out)
+{
+  if (out != NULL)
+    {
+      output_flush (out);
+      free (out->buf);
+      free (out);
+    }
+}
+
+/*!
+   \fn void output_write (OUTPUT_BUFFER *, const void *, size_t)
+
+   \brief A function that appends characters to the output.
+
+   This function appends the `n' characters of `p' to the buffer
+   (`out'). If they do not fit, the buffer and the characters are
+   written together with one `writev' system call, so the large
+   lines are never copied.
+
+   \param out a pointer to a `OUTPUT_BUFFER' data structure.
+   \param p a pointer to a constant void.
+   \param n a `size_t' type definition.
+*/
+void
+output_write (OUTPUT_BUFFER * out, const void *p, size_t n)
+{
+  /* the buffer and the characters. */
+  struct iovec iov[2];
+
+  /* the characters (`writev' does not change them). */
+  union
+  {
+    const void *cp;
+    void *p;
+  } data;
+
+  if (n <= out->size - out->len)
+    {
+      memcpy (out->buf + out->len, p, n);
+      out->len += n;
+      return;
+    }
+
+  if (out->fd < 0)
+    {
+      reserve (out, n);
+      memcpy (out->buf + out->len, p, n);
+      out->len += n;
+      return;
+    }
+
+  iov[0].iov_base = out->buf;
+  iov[0].iov_len = out->len;
+  data.cp = p;
+  iov[1].iov_base = data.p;
+  iov[1].iov_len = n;
+
+  /* the buffer is written before the characters (if they
+     fault, the write does not return). */
+  out->len = 0;
+  write_all (out->fd, iov, 2);
+}
+
+/*!
+   \fn void output_string (OUTPUT_BUFFER *, const char *)
+
+   \brief A function that appends a string to the output.
+
+   \param out a pointer to a `OUTPUT_BUFFER' data structure.
+   \param str a pointer to a constant character.
+*/
+void
+output_string (OUTPUT_BUFFER * out, const char *str)
+{
+  output_write (out, str, strlen (str));
+}
+
+/*!
+   \fn void output_number (OUTPUT_BUFFER *, ulong)
+
+   \brief A function that appends a decimal number to the output.
+
+   This function formats the number `num' into the buffer (`out')
+   directly, without the format parsing of the standard I/O library.
+
+   \param out a pointer to a `OUTPUT_BUFFER' data structure.
+   \param num an unsigned long integer.
+*/
+void
+output_number (OUTPUT_BUFFER * out, ulong num)
+{
+  /* the digits (backwards). */
+  char digits[MAX_DIGITS];
+  char *p = digits + MAX_DIGITS;
+
+  do
+    {
+      *--p = (char) ('0' + num % 10);
+      num /= 10;
+    }
+  while (num > 0);
+
+  output_write (out, p, (size_t) (digits + MAX_DIGITS - p));
+}
+
+/*!
+   \fn void output_commit (OUTPUT_BUFFER *)
+
+   \brief A function that ends a line of the output.
+
+   This function writes the buffer (`out') if the output is line
+   buffered (a terminal), so that the user sees each line at once.
+
+   \param out a pointer to a `OUTPUT_BUFFER' data structure.
+*/
+void
+output_commit (OUTPUT_BUFFER * out)
+{
+  if (out->line_buffered)
+    output_flush (out);
+}
+
+/*!
+   \fn void output_flush (OUTPUT_BUFFER *)
+
+   \brief A function that writes the pending output.
+
+   This function writes the buffer (`out') to its file descriptor.
+   A memory buffer is kept as it is.
+
+   \param out a pointer to a `OUTPUT_BUFFER' data structure.
+*/
+void
+output_flush (OUTPUT_BUFFER * out)
+{
+  /* the buffer. */
+  struct iovec iov;
+
+  if (out->fd < 0 || out->len == 0)
+    return;
+
+  iov.iov_base = out->buf;
+  iov.iov_len = out->len;
+
+  write_all (out->fd, &iov, 1);
+  out->len = 0;
+}
+
+/*!
+   \fn static void reserve (OUTPUT_BUFFER *, size_t)
+
+   \brief A function that grows a memory buffer.
+
+   This function grows the memory buffer (`out') so that `n' more
+   characters fit (at least doubling it).
+
+   \param out a pointer to a `OUTPUT_BUFFER' data structure.
+   \param n a `size_t' type definition.
+*/
+static void
+reserve (OUTPUT_BUFFER * out, size_t n)
+{
+  /* externs. */
+
+  /* function externs. */
+  extern void *erealloc (void *, size_t);
+
+  while (out->size - out->len < n)
+    out->size *= 2;
+
+  out->buf = (char *) erealloc (out->buf, out->size);
+}
+
+/*!
+   \fn static void write_all (const int, struct iovec *, int)
+
+   \brief A function that writes an I/O vector completely.
+
+   This function writes the `cnt' buffers of `iov' to the file
+   descriptor `fd', restarting the interrupted and partial writes.
+   If the output fails, it exits.
+
+   \param fd a constant integer value.
+   \param iov a pointer to a `iovec' data structure.
+   \param cnt an integer value.
+*/
+static void
+write_all (const int fd, struct iovec *iov, int cnt)
+{
+  /* externs. */
+
+  /* function externs. */
+  extern void eprintf (char *, ...);
+
+  /* the characters of the last write. */
+  ssize_t n;
+
+  while (cnt > 0)
+    {
+      /* skip the empty buffers. */
+      if (iov->iov_len == 0)
+        {
+          iov++;
+          cnt--;
+          continue;
+        }
+
+      if ((n = writev (fd, iov, cnt)) < 0)
+        {
+          if (errno == EINTR)
+            continue;
+
+          /* the characters of a mapped input file which shrinks
+             can not be read (reading them raises a bus error). */
+          if (errno == EFAULT)
+            touch_pages (iov, cnt);
+
+          eprintf ("write() failed:");
+        }
+
+      /* consume the written buffers. */
+      while (cnt > 0 && (size_t) n >= iov->iov_len)
+        {
+          n -= (ssize_t) iov->iov_len;
+          iov++;
+          cnt--;
+        }
+
+      if (cnt > 0)
+        {
+          iov->iov_base = (char *) iov->iov_base + n;
+          iov->iov_len -= (size_t) n;
+        }
+    }
+}
+
+/*!
+   \fn static void touch_pages (const struct iovec *, int)
+
+   \brief A function that reads a character of each page of the buffers.
+
+   This function reads the `cnt' buffers (`iov') page by page. The lost
+   pages of a mapped input file which shrinks raise a bus error, which
+   the reader of the input file handles (see `run_guarded').
+
+   \param iov a pointer to a constant `struct iovec' data structure.
+   \param cnt an integer value.
+*/
+static void
+touch_pages (const struct iovec *iov, int cnt)
+{
+  /* the page size. */
+  const size_t page = (size_t) sysconf (_SC_PAGESIZE);
+
+  /* the offset in the current buffer. */
+  size_t off;
+
+  for (; cnt > 0; iov++, cnt--)
+    for (off = 0; off < iov->iov_len; off += page)
+      (void) ((volatile const uchar *) iov->iov_base)[off];
+}
@@ -0,0 +1,85 @@
+/*
+ *  `gfs-output-buffer.h'.
+ *
+ *  This header contains the output buffer struct and typedef.
+ *
+ *  Copyright (C) 2008  Efstathios Chatzikyriakidis (stathis.chatzikyriakidis@gmail.com).
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*!
+   \file gfs-output-buffer.h
+   \brief This header contains the output buffer struct and typedef.
+*/
+
+/*
+ * structure data types.
+ */
+
+/*!
+   \struct output_bufferT
+   \brief Output buffer data structure.
+
+   This data structure keeps the output of the selected lines. The
+   fields of a line are appended to a large buffer, which is written
+   to a file descriptor only when it is full (or the output ends). If
+   there is no file descriptor, the buffer grows in memory (the output
+   of a job which is flushed later).
+*/
+struct output_bufferT
+{
+  /*!
+     \var fd
+     \brief The file descriptor of the output (or -1 for memory).
+   */
+  int fd;
+
+  /*!
+     \var line_buffered
+     \brief Is the output written at the end of each line (a terminal)?
+   */
+  BOOL line_buffered;
+
+  /*!
+     \var buf
+     \brief The buffer.
+   */
+  char *buf;
+
+  /*!
+     \var len
+     \brief The characters of the buffer.
+   */
+  size_t len;
+
+  /*!
+     \var size
+     \brief The size of the buffer.
+   */
+  size_t size;
+};
+
+/*
+ * type definitions.
+ */
+
+/*!
+   \typedef OUTPUT_BUFFER
+   \brief Output buffer data structure type definition.
+
+   This type definition is a synonym
+   for the output buffer data structure.
+*/
+typedef struct output_bufferT OUTPUT_BUFFER;
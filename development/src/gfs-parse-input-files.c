@@ -26,6 +26,7 @@
 
 /* standard includes. */
 #include <stdio.h>
+#include <sys/types.h>
 
 /* basic includes. */
 #include "gfs-typedefs.h"
@@ -42,10 +43,11 @@ INPUT_FILES *parse_input_files (INPUT_FILES * listp, cint argc, char *argv[]);
    \brief A function that parses the command line input files arguments.
 
    This function parses all the command line arguments that seems to be
-   input files (by using `argc', `argv', `optind'). For each input file
-   checks if it is acceptable (necessary conditions). If it does, adds
-   it to the input files linked list `listp'. At the end, it returns the
-   input files linked list `listp'.
+   input files (by using `argc', `argv', `optind'). Each input file (only
+   once) is added to the input files list `listp' (a new one if `listp'
+   is NULL). The input files are checked when they are opened for the
+   search, so each one is looked up only once. At the end, it returns
+   the input files list `listp'.
 
    \param listp a pointer to a `INPUT_FILES' data structure.
    \param argc a constant integer value.
@@ -59,29 +61,27 @@ parse_input_files (INPUT_FILES * listp, cint argc, char *argv[])
   /* externs. */
 
   /* function externs. */
-  extern INPUT_FILE *new_input_file (const char *);
-  extern INPUT_FILE *add_input_file (INPUT_FILE *, INPUT_FILE *);
-  extern BOOL input_file_exists (INPUT_FILES *, cstring);
-  extern FILE_INFO check_input_file (cstring);
+  extern INPUT_FILES *new_input_files (void);
+  extern BOOL add_input_file (INPUT_FILES *, const char *);
 
   /* variable externs. */
 
   /* starting input files position. */
   extern int optind;
 
+  if (listp == NULL)
+    listp = new_input_files ();
+
   /* if there are possible input files check them. */
   if (argc > optind)
     {
       /* is used for the loop. */
       register int i;
 
-      /* parse possible input files (accept only
-         regular ascii files and add them to the
-         list. */
+      /* parse possible input files (add them
+         to the list only once). */
       for (i = optind; i < argc; i++)
-        if (!input_file_exists (listp, argv[i]))
-          if (check_input_file (argv[i]) == f_accessible)
-            listp = add_input_file (listp, new_input_file (argv[i]));
+        add_input_file (listp, argv[i]);
     }
 
   /* return the input files list. */
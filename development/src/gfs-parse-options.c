@@ -27,16 +27,22 @@
 /* standard includes. */
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <getopt.h>
+#include <libintl.h>
 
 /* basic includes. */
 #include "gfs-defines.h"
+#include "gfs-i18n-macros.h"
 #include "gfs-typedefs.h"
 #include "gfs-options.h"
+#include "gfs-search-kernels.h"
 
 /* function prototypes. */
 OPTIONS *parse_options (OPTIONS * cop, cint argc, char *argv[]);
 static OPTIONS *new_options (void);
+static void add_patterns (OPTIONS * cop, const char *str, size_t len);
+static void read_patterns (OPTIONS * cop, const char *filepath);
 
 /* functions. */
 
@@ -67,12 +73,27 @@ parse_options (OPTIONS * cop, cint argc, char *argv[])
   extern void print_version (FILE *, cint);
   extern void print_author (FILE *, cint);
   extern void print_license (FILE *, cint);
+  extern void eprintf (char *, ...);
+  extern SEARCH_KERNEL select_search_kernel (const char *, const BOOL);
+
+  /* variable externs. */
+  extern cstring usage_unknown_kernel;
+  extern cstring usage_invalid_jobs;
+  extern cstring usage_invalid_count;
+  extern cstring usage_invalid_bytes;
+  extern cstring usage_invalid_context;
+
+  /* the end of a number argument. */
+  char *endp;
+
+  /* a number argument. */
+  ulong num;
 
   /* next option in command line. */
   register int next_option;
 
   /* short options. */
-  cstring short_options = "rmnie:v";
+  cstring short_options = "rmnie:f:Ej:R0qlM:cA:B:C:v";
 
   /* long options. */
   const struct option long_options[] = {
@@ -81,8 +102,26 @@ parse_options (OPTIONS * cop, cint argc, char *argv[])
     {"line-number", 0, NULL, 'n'},
     {"ignore-case", 0, NULL, 'i'},
     {"pattern", 1, NULL, 'e'},
+    {"file", 1, NULL, 'f'},
+    {"extended-regexp", 0, NULL, 'E'},
+    {"jobs", 1, NULL, 'j'},
+    {"recursive", 0, NULL, 'R'},
+    {"files-from", 1, NULL, 'F'},
+    {"null", 0, NULL, '0'},
+    {"quiet", 0, NULL, 'q'},
+    {"files-with-matches", 0, NULL, 'l'},
+    {"max-count", 1, NULL, 'M'},
+    {"count", 0, NULL, 'c'},
+    {"max-line-bytes", 1, NULL, 'W'},
+    {"after-context", 1, NULL, 'A'},
+    {"before-context", 1, NULL, 'B'},
+    {"context", 1, NULL, 'C'},
     {"verbose", 0, NULL, 'v'},
-    {"copyleft", 0, NULL, 'c'},
+    {"kernel", 1, NULL, 'k'},
+    {"index", 1, NULL, 'X'},
+    {"blocks", 0, NULL, 'b'},
+    {"cache", 1, NULL, 'K'},
+    {"copyleft", 0, NULL, 'g'},
     {"author", 0, NULL, 'a'},
     {"version", 0, NULL, 'V'},
     {"help", 0, NULL, 'h'},
@@ -117,7 +156,7 @@ parse_options (OPTIONS * cop, cint argc, char *argv[])
           print_author (stdout, EXIT_SUCCESS);
 
           /* print license and exit. */
-        case 'c':
+        case 'g':
           print_license (stdout, EXIT_SUCCESS);
 
           /* invert the sence of matching. */
@@ -140,9 +179,87 @@ parse_options (OPTIONS * cop, cint argc, char *argv[])
           cop->ignore_case = true;
           break;
 
-          /* input matching pattern. */
+          /* input matching pattern (repeatable). */
         case 'e':
-          cop->pattern = estrdup (optarg);
+          add_patterns (cop, optarg, strlen (optarg));
+          break;
+
+          /* input matching patterns from a file. */
+        case 'f':
+          read_patterns (cop, optarg);
+          cop->pattern_file = true;
+          break;
+
+          /* the patterns are extended regular expressions. */
+        case 'E':
+          cop->regex = true;
+          break;
+
+          /* search the input files with many jobs. */
+        case 'j':
+          cop->jobs = strtoul (optarg, &endp, 10);
+          if (*optarg == '\0' || *endp != '\0' || cop->jobs == 0
+              || cop->jobs > MAX_JOBS)
+            eprintf (_(usage_invalid_jobs), optarg);
+          break;
+
+          /* search the directories recursively. */
+        case 'R':
+          cop->recursive = true;
+          break;
+
+          /* read the names of the input files from a file. */
+        case 'F':
+          cop->files_from = estrdup (optarg);
+          break;
+
+          /* the names of the file list are null delimited. */
+        case '0':
+          cop->null_names = true;
+          break;
+
+          /* print nothing, the exit status is enough. */
+        case 'q':
+          cop->quiet = true;
+          break;
+
+          /* print only the paths of the input files with matches. */
+        case 'l':
+          cop->list_files = true;
+          break;
+
+          /* stop an input after a number of selected lines. */
+        case 'M':
+          cop->max_count = strtoul (optarg, &endp, 10);
+          if (*optarg == '\0' || *endp != '\0' || cop->max_count == 0)
+            eprintf (_(usage_invalid_count), optarg);
+          break;
+
+          /* print only the number of the selected lines. */
+        case 'c':
+          cop->count_only = true;
+          break;
+
+          /* bound the memory of a long line. */
+        case 'W':
+          cop->max_line_bytes = strtoul (optarg, &endp, 10);
+          if (*optarg == '\0' || *endp != '\0' || cop->max_line_bytes == 0)
+            eprintf (_(usage_invalid_bytes), optarg);
+          break;
+
+          /* print lines around the selected lines. */
+        case 'A':
+        case 'B':
+        case 'C':
+          num = strtoul (optarg, &endp, 10);
+          if (*optarg == '\0' || *endp != '\0' || num > MAX_CONTEXT)
+            eprintf (_(usage_invalid_context), optarg);
+
+          if (next_option != 'B')
+            cop->after_context = num;
+          if (next_option != 'A')
+            cop->before_context = num;
+          cop->context = true;
           break;
 
           /* explain what is being done. */
@@ -150,6 +267,28 @@ parse_options (OPTIONS * cop, cint argc, char *argv[])
           cop->verbose = true;
           break;
 
+          /* select the substring search kernel. */
+        case 'k':
+          if (select_search_kernel (optarg, false) == NULL)
+            eprintf (_(usage_unknown_kernel), optarg);
+          cop->kernel = estrdup (optarg);
+          break;
+
+          /* skip the input files which an index rules out. */
+        case 'X':
+          cop->index = estrdup (optarg);
+          break;
+
+          /* read only the blocks which the block filters admit. */
+        case 'b':
+          cop->blocks = true;
+          break;
+
+          /* keep the results of the searches in a directory. */
+        case 'K':
+          cop->cache = estrdup (optarg);
+          break;
+
           /* unknown option. */
         case '?':
           print_usage (stderr, EXIT_ERROR);
@@ -198,8 +337,135 @@ new_options (void)
   newp->max_matches = false;
   newp->line_number = false;
   newp->ignore_case = false;
-  newp->pattern = NULL;
+  newp->patterns = NULL;
+  newp->pattern_lens = NULL;
+  newp->num_patterns = 0L;
+  newp->pattern_file = false;
+  newp->regex = false;
+  newp->kernel = NULL;
+  newp->jobs = 0L;
+  newp->recursive = false;
+  newp->files_from = NULL;
+  newp->null_names = false;
+  newp->quiet = false;
+  newp->list_files = false;
+  newp->max_count = 0L;
+  newp->count_only = false;
+  newp->max_line_bytes = 0L;
+  newp->after_context = newp->before_context = 0L;
+  newp->context = false;
+  newp->index = NULL;
+  newp->blocks = false;
+  newp->cache = NULL;
 
   /* return the options pointer. */
   return newp;
 }
+
+/*!
+   \fn static void add_patterns (OPTIONS *, const char *, size_t)
+
+   \brief A function that adds matching patterns to the options.
+
+   This function adds to the options (`cop') the matching patterns of
+   the `len' characters of `str'. Each line of `str' is a pattern (as
+   the lines of the input are matched one by one, a pattern can not
+   contain a new line).
+
+   \param cop a pointer to a `OPTIONS' data structure.
+   \param str a pointer to a constant character.
+   \param len a `size_t' type definition.
+*/
+static void
+add_patterns (OPTIONS * cop, const char *str, size_t len)
+{
+  /* externs. */
+
+  /* function externs. */
+  extern void *emalloc (size_t);
+  extern void *erealloc (void *, size_t);
+
+  /* the end of the current pattern. */
+  const char *nl;
+
+  /* the length of the current pattern. */
+  size_t n;
+
+  for (;;)
+    {
+      nl = (const char *) memchr (str, '\n', len);
+      n = (nl != NULL ? (size_t) (nl - str) : len);
+
+      /* grow the patterns arrays. */
+      cop->patterns = (char **) erealloc (cop->patterns,
+                                          (cop->num_patterns + 1)
+                                          * sizeof (char *));
+      cop->pattern_lens = (size_t *) erealloc (cop->pattern_lens,
+                                               (cop->num_patterns + 1)
+                                               * sizeof (size_t));
+
+      /* store the pattern. */
+      cop->patterns[cop->num_patterns] = (char *) emalloc (n + 1);
+      memcpy (cop->patterns[cop->num_patterns], str, n);
+      cop->patterns[cop->num_patterns][n] = '\0';
+      cop->pattern_lens[cop->num_patterns++] = n;
+
+      /* no more lines. */
+      if (nl == NULL)
+        break;
+
+      len -= n + 1;
+      str = nl + 1;
+    }
+}
+
+/*!
+   \fn static void read_patterns (OPTIONS *, const char *)
+
+   \brief A function that reads matching patterns from a file.
+
+   This function reads the matching patterns of the file `filepath'
+   (one per line, "-" is the standard input) and adds them to the
+   options (`cop'). If the file can not be read, it exits.
+
+   \param cop a pointer to a `OPTIONS' data structure.
+   \param filepath a pointer to a constant character.
+*/
+static void
+read_patterns (OPTIONS * cop, const char *filepath)
+{
+  /* externs. */
+
+  /* function externs. */
+  extern void eprintf (char *, ...);
+
+  /* the patterns file. */
+  FILE *fp;
+
+  /* the current line and its buffer size. */
+  char *line = NULL;
+  size_t size = 0;
+
+  /* the length of the current line. */
+  ssize_t len;
+
+  if (!strcmp (filepath, "-"))
+    fp = stdin;
+  else if ((fp = fopen (filepath, "r")) == NULL)
+    eprintf ("fopen(\"%.500s\") failed:", filepath);
+
+  /* read the patterns line by line. */
+  while ((len = getline (&line, &size, fp)) != -1)
+    {
+      /* drop the new line. */
+      if (len > 0 && line[len - 1] == '\n')
+        --len;
+
+      add_patterns (cop, line, (size_t) len);
+    }
+
+  free (line);
+
+  if (fp != stdin)
+    fclose (fp);
+}
@@ -65,13 +65,23 @@ print_usage (FILE * stream, cint exit_code)
   /* variable externs. */
   extern cstring usage_part_a, usage_part_b;
   extern cstring usage_part_c, usage_part_d;
+  extern cstring usage_part_e, usage_part_f;
+  extern cstring usage_part_g, usage_part_h;
+  extern cstring usage_part_i;
   extern cstring send_bugs_mail;
 
   /* print usage information. */
   fprintf (stream, "%s %s", _(usage_part_a), get_prog_name ());
   fprintf (stream, " %s%s", _(usage_part_b), NEW_LINE);
+  fprintf (stream, "%s %s", _(usage_part_a), get_prog_name ());
+  fprintf (stream, " %s%s", _(usage_part_g), NEW_LINE);
+  fprintf (stream, "%s %s", _(usage_part_a), get_prog_name ());
+  fprintf (stream, " %s%s", _(usage_part_h), NEW_LINE);
   fprintf (stream, "%s%s", NEW_LINE, _(usage_part_c));
-  fprintf (stream, "%s%s%s", NEW_LINE, _(usage_part_d), NEW_LINE);
+  fprintf (stream, "%s", _(usage_part_d));
+  fprintf (stream, "%s", _(usage_part_e));
+  fprintf (stream, "%s", _(usage_part_i));
+  fprintf (stream, "%s%s%s", NEW_LINE, _(usage_part_f), NEW_LINE);
   fprintf (stream, "%s%s", _(send_bugs_mail), NEW_LINE);
 
   /* exit the program. */
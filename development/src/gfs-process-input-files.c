@@ -26,8 +26,16 @@
 
 /* standard includes. */
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
+#include <errno.h>
+#include <limits.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <pthread.h>
 #include <libintl.h>
 
 /* basic includes. */
@@ -36,6 +44,14 @@
 #include "gfs-typedefs.h"
 #include "gfs-options.h"
 #include "gfs-input-files-list.h"
+#include "gfs-search-kernels.h"
+#include "gfs-aho-corasick.h"
+#include "gfs-regex.h"
+#include "gfs-thread-pool.h"
+#include "gfs-output-buffer.h"
+#include "gfs-walk.h"
+#include "gfs-index.h"
+#include "gfs-cache.h"
 
 /* enumeration constants. */
 
@@ -47,26 +63,760 @@
 */
 enum
 {
-  MAX_LINE = 1024 * 1024 /*!< Max line characters (1Mbyte). */
+  LINE_ROOM = 1024 * 1024,      /*!< Initial room for a line (1Mbyte). */
+  SCAN_BLOCK = 1024 * 1024,     /*!< Read block characters (1Mbyte). */
+  MMAP_MIN = 128 * 1024,        /*!< Min file size for mapping (128Kbytes). */
+  CHUNK_SIZE = 8 * 1024 * 1024, /*!< Parallel chunk characters (8Mbytes). */
+  JOBS_WINDOW = 4,              /*!< Jobs in flight per worker. */
+  SNIFF_BLOCK = 4096,           /*!< Sniffed characters of a skipped file. */
+  MAX_RECORDS = 1024 * 1024,    /*!< Max cached selected lines of a file. */
+  MAX_WALKERS = 4               /*!< Max directory walker threads. */
+};
+
+/* type definitions. */
+
+/*!
+   \typedef SCANNER
+   \brief Scanner data structure type definition.
+
+   This type definition is a synonym
+   for the scanner data structure.
+*/
+typedef struct scannerT SCANNER;
+
+/*!
+   \typedef JOB
+   \brief Input file job data structure type definition.
+
+   This type definition is a synonym
+   for the input file job data structure.
+*/
+typedef struct jobT JOB;
+
+/*!
+   \typedef MATCH
+   \brief Selected line record data structure type definition.
+
+   This type definition is a synonym
+   for the selected line record data structure.
+*/
+typedef struct matchT MATCH;
+
+/*!
+   \typedef EMITTER
+   \brief Ordered output data structure type definition.
+
+   This type definition is a synonym
+   for the ordered output data structure.
+*/
+typedef struct emitterT EMITTER;
+
+/*!
+   \typedef SOURCE
+   \brief Input files source data structure type definition.
+
+   This type definition is a synonym
+   for the input files source data structure.
+*/
+typedef struct sourceT SOURCE;
+
+/*!
+   \typedef REGION
+   \brief Mapped region data structure type definition.
+
+   This type definition is a synonym
+   for the mapped region data structure.
+*/
+typedef struct regionT REGION;
+
+/*!
+   \typedef FINDER
+   \brief Pattern finding function type definition.
+
+   This type definition is a synonym for a pointer to a function
+   that looks for the pattern in a region of `n' characters (`p')
+   of the scanner's block. It returns a pointer to the first hit
+   or NULL if there is not any.
+*/
+typedef const uchar *(*FINDER) (SCANNER * sp, const uchar * p, size_t n);
+
+/*!
+   \typedef SELECTOR
+   \brief Line selecting function type definition.
+
+   This type definition is a synonym for a pointer to a function
+   that prints the selected lines of a region of complete lines
+   (from `p' up to `end') of the scanner's block.
+*/
+typedef void (*SELECTOR) (SCANNER * sp, const uchar * p, const uchar * end);
+
+/*
+ * structure data types.
+ */
+
+/*!
+   \struct scannerT
+   \brief Scanner data structure.
+
+   This data structure keeps the state of the scan core. The
+   matching mode is resolved into its functions once per run,
+   so the scanning loop does not have to test the options.
+*/
+struct scannerT
+{
+  /*!
+     \var cop
+     \brief Command line options.
+   */
+  OPTIONS *cop;
+
+  /*!
+     \var pattern
+     \brief The single pattern (lowercase if case insensitive).
+   */
+  const char *pattern;
+
+  /*!
+     \var pattern_len
+     \brief The length of the single pattern.
+   */
+  size_t pattern_len;
+
+  /*!
+     \var acp
+     \brief The automaton of many patterns (or NULL).
+   */
+  AHO_CORASICK *acp;
+
+  /*!
+     \var rxp
+     \brief The regular expression of the patterns (or NULL).
+   */
+  REGEX *rxp;
+
+  /*!
+     \var dfa
+     \brief The lazy automaton of the regular expression (or NULL).
+   */
+  LAZY_DFA *dfa;
+
+  /*!
+     \var shared
+     \brief Are the automata owned by another scanner?
+   */
+  BOOL shared;
+
+  /*!
+     \var kernel
+     \brief The substring search kernel of the run.
+   */
+  SEARCH_KERNEL kernel;
+
+  /*!
+     \var counter
+     \brief The new line counting kernel of the run.
+   */
+  COUNT_KERNEL counter;
+
+  /*!
+     \var find
+     \brief The pattern finding function of the run.
+   */
+  FINDER find;
+
+  /*!
+     \var select
+     \brief The line selecting function of the run.
+   */
+  SELECTOR select;
+
+  /*!
+     \var overlap
+     \brief The overlap of the parts of a too long line.
+   */
+  size_t overlap;
+
+  /*!
+     \var buf
+     \brief The block buffer.
+   */
+  uchar *buf;
+
+  /*!
+     \var size
+     \brief The size of the block buffer.
+   */
+  size_t size;
+
+  /*!
+     \var map
+     \brief The mapping of the loaded input file (or NULL).
+   */
+  void *map;
+
+  /*!
+     \var map_size
+     \brief The size of the mapping.
+   */
+  size_t map_size;
+
+  /*!
+     \var sidecar
+     \brief The block filters of the mapped input file (or NULL).
+   */
+  SIDECAR *sidecar;
+
+  /*!
+     \var cache
+     \brief The result cache of the run (or NULL).
+   */
+  RESULT_CACHE *cache;
+
+  /*!
+     \var result
+     \brief The cached result of the mapped input file (or NULL).
+   */
+  CACHED_RESULT *result;
+
+  /*!
+     \var node
+     \brief The mapped input file (for its cached result).
+   */
+  const INPUT_FILE *node;
+
+  /*!
+     \var keep
+     \brief Are the selected lines kept for the result cache?
+   */
+  BOOL keep;
+
+  /*!
+     \var recs
+     \brief The kept selected lines of the mapped input file.
+   */
+  RESULT_RECORD *recs;
+
+  /*!
+     \var num_recs
+     \brief Number of the kept selected lines.
+   */
+  ulong num_recs;
+
+  /*!
+     \var max_recs
+     \brief The size of the kept selected lines array.
+   */
+  ulong max_recs;
+
+  /*!
+     \var carry
+     \brief The characters of the loaded first block (not mapped).
+   */
+  size_t carry;
+
+  /*!
+     \var whole
+     \brief Is the whole input file loaded in the first block?
+   */
+  BOOL whole;
+
+  /*!
+     \var out
+     \brief The output buffer of the selected lines.
+   */
+  OUTPUT_BUFFER *out;
+
+  /*!
+     \var job
+     \brief The chunk job which records the selected lines (or NULL).
+   */
+  JOB *job;
+
+  /*!
+     \var path
+     \brief The path of the current input file (or NULL).
+   */
+  const char *path;
+
+  /*!
+     \var named
+     \brief Prefix the selected lines with the path.
+   */
+  BOOL named;
+
+  /*!
+     \var tabbed
+     \brief Prefix the selected lines with a tab space (verbose).
+   */
+  BOOL tabbed;
+
+  /*!
+     \var curr_line
+     \brief Number of lines before `line_pos'.
+   */
+  ulong curr_line;
+
+  /*!
+     \var line_pos
+     \brief Position of the block up to which the lines are counted.
+   */
+  const uchar *line_pos;
+
+  /*!
+     \var num_match
+     \brief Number of matches in the current input.
+   */
+  ulong num_match;
+
+  /*!
+     \var limit
+     \brief Max selected lines of an input (or 0 for no limit).
+   */
+  ulong limit;
+
+  /*!
+     \var stop
+     \brief Is the limit of the current input reached?
+   */
+  BOOL stop;
+
+  /*!
+     \var count
+     \brief Are the selected lines only counted?
+   */
+  BOOL count;
+
+  /*!
+     \var context
+     \brief Are lines printed around the selected lines?
+   */
+  BOOL context;
+
+  /*!
+     \var ctx_pos
+     \brief Position of the block from which no line is printed yet.
+   */
+  const uchar *ctx_pos;
+
+  /*!
+     \var after
+     \brief Lines still to print after the last selected line.
+   */
+  ulong after;
+
+  /*!
+     \var gap
+     \brief Are lines skipped since the last printed line?
+   */
+  BOOL gap;
+
+  /*!
+     \var grouped
+     \brief Is a group of lines printed (so the next is separated)?
+   */
+  BOOL grouped;
+
+  /*!
+     \var shown
+     \brief Is a line of the current input written?
+   */
+  BOOL shown;
+};
+
+/*!
+   \struct matchT
+   \brief Selected line record data structure.
+
+   This data structure keeps a selected line of a chunk, relative
+   to the chunk, until the emitter prints it.
+*/
+struct matchT
+{
+  /*!
+     \var off
+     \brief The offset of the line in the chunk.
+   */
+  size_t off;
+
+  /*!
+     \var len
+     \brief The length of the line.
+   */
+  size_t len;
+
+  /*!
+     \var line
+     \brief Number of lines of the chunk before the line.
+   */
+  ulong line;
+};
+
+/*!
+   \struct jobT
+   \brief Input file job data structure.
+
+   This data structure keeps the search of an input file (or of a
+   chunk of a large mapped input file) by a worker thread. The output
+   of the search is kept in memory until all the previous jobs are
+   flushed. A chunk job keeps records of its selected lines instead,
+   because the line numbers depend on the previous chunks.
+*/
+struct jobT
+{
+  /*!
+     \var node
+     \brief The input file.
+   */
+  INPUT_FILE *node;
+
+  /*!
+     \var begin
+     \brief The start of the chunk (or NULL for a whole input file).
+   */
+  const uchar *begin;
+
+  /*!
+     \var end
+     \brief The end of the chunk.
+   */
+  const uchar *end;
+
+  /*!
+     \var first
+     \brief Is this the first job of the input file?
+   */
+  BOOL first;
+
+  /*!
+     \var last
+     \brief Is this the last job of the input file?
+   */
+  BOOL last;
+
+  /*!
+     \var map
+     \brief The mapping of the chunk, released after the last one (or NULL).
+   */
+  void *map;
+
+  /*!
+     \var map_size
+     \brief The size of the mapping.
+   */
+  size_t map_size;
+
+  /*!
+     \var recs
+     \brief The records of the selected lines of the chunk.
+   */
+  MATCH *recs;
+
+  /*!
+     \var max_recs
+     \brief The size of the records array.
+   */
+  ulong max_recs;
+
+  /*!
+     \var num_lines
+     \brief Number of lines of the chunk (for the line numbers).
+   */
+  ulong num_lines;
+
+  /*!
+     \var skip_lines
+     \brief Number of lines of the blocks skipped before the chunk.
+   */
+  ulong skip_lines;
+
+  /*!
+     \var skipped
+     \brief Is the input file binary (not searched)?
+   */
+  BOOL skipped;
+
+  /*!
+     \var cut
+     \brief Is the chunk cut short (the input file shrinks under it)?
+   */
+  BOOL cut;
+
+  /*!
+     \var result
+     \brief The cached result of the whole input file (or NULL).
+   */
+  CACHED_RESULT *result;
+
+  /*!
+     \var pruned
+     \brief Does the index rule out a match in the input file?
+   */
+  BOOL pruned;
+
+  /*!
+     \var emp
+     \brief The ordered output of the job.
+   */
+  EMITTER *emp;
+
+  /*!
+     \var out
+     \brief The output of the search (a memory buffer).
+   */
+  OUTPUT_BUFFER *out;
+
+  /*!
+     \var num_match
+     \brief Number of matches in the input file.
+   */
+  ulong num_match;
+
+  /*!
+     \var release
+     \brief Is the input file outside of the list (released at the end)?
+   */
+  BOOL release;
+
+  /*!
+     \var done
+     \brief Is the search finished?
+   */
+  BOOL done;
+};
+
+/*!
+   \struct emitterT
+   \brief Ordered output data structure.
+
+   This data structure keeps the jobs in flight (a ring of at most
+   `JOBS_WINDOW' jobs per worker) and the scanners of the workers.
+   The output of the jobs is flushed in the order of the input files,
+   so it does not depend on the number of the workers.
+*/
+struct emitterT
+{
+  /*!
+     \var jobs
+     \brief The ring of the jobs in flight.
+   */
+  JOB *jobs;
+
+  /*!
+     \var size
+     \brief The size of the ring.
+   */
+  ulong size;
+
+  /*!
+     \var scanners
+     \brief The scanner of each worker.
+   */
+  SCANNER **scanners;
+
+  /*!
+     \var lock
+     \brief The lock of the job states.
+   */
+  pthread_mutex_t lock;
+
+  /*!
+     \var finished
+     \brief Signals a finished job.
+   */
+  pthread_cond_t finished;
+
+  /*!
+     \var quit
+     \brief Is the exit status known (the rest is not searched)?
+   */
+  BOOL quit;
+};
+
+/*!
+   \struct sourceT
+   \brief Input files source data structure.
+
+   This data structure yields the input files to search: the
+   operands in order, then the names of a file list (read one by one)
+   and, if the search is recursive, the regular files under each
+   directory (found by a walk).
+*/
+struct sourceT
+{
+  /*!
+     \var listp
+     \brief The operands.
+   */
+  INPUT_FILES *listp;
+
+  /*!
+     \var next
+     \brief The index of the next operand.
+   */
+  ulong next;
+
+  /*!
+     \var walk
+     \brief The walk of the current directory operand (or NULL).
+   */
+  WALK *walk;
+
+  /*!
+     \var num_walkers
+     \brief The number of the walker threads of a walk.
+   */
+  ulong num_walkers;
+
+  /*!
+     \var recursive
+     \brief Are the directories walked?
+   */
+  BOOL recursive;
+
+  /*!
+     \var from
+     \brief The file list (or NULL).
+   */
+  FILE *from;
+
+  /*!
+     \var delim
+     \brief The delimiter of the names of the file list.
+   */
+  int delim;
+
+  /*!
+     \var name
+     \brief The current name of the file list.
+   */
+  char *name;
+
+  /*!
+     \var name_size
+     \brief The size of the buffer of the name.
+   */
+  size_t name_size;
+};
+
+/*!
+   \struct regionT
+   \brief Mapped region data structure.
+
+   This data structure keeps a region of a mapped input file which is
+   read on its own under guard (see `run_guarded'), and what is found
+   in it.
+*/
+struct regionT
+{
+  /*!
+     \var begin
+     \brief The start of the region.
+   */
+  const uchar *begin;
+
+  /*!
+     \var end
+     \brief The end of the region.
+   */
+  const uchar *end;
+
+  /*!
+     \var info
+     \brief The kind of the data of the region.
+   */
+  FILE_INFO info;
+
+  /*!
+     \var line_end
+     \brief The first new line of the region (or NULL).
+   */
+  const uchar *line_end;
 };
 
 /* function prototypes. */
 BOOL process_input_files (INPUT_FILES * listp, OPTIONS * cop);
 BOOL process_input_file (FILE * input, OPTIONS * cop);
-static char *strlwr (char *str);
+static BOOL search_parallel (INPUT_FILES * listp, OPTIONS * cop,
+                             const ulong num_jobs);
+static JOB *new_job (EMITTER * emp, const ulong index, INPUT_FILE * node);
+static void init_source (SOURCE * src, INPUT_FILES * listp, OPTIONS * cop,
+                         const ulong num_jobs);
+static void close_source (SOURCE * src);
+static INPUT_FILE *next_input_file (SOURCE * src, BOOL * release);
+static char *read_file_name (SOURCE * src);
+static void flush_job (JOB * jp, SCANNER * printer);
+static void print_file_path (OPTIONS * cop, OUTPUT_BUFFER * out,
+                             const char *path, const ulong prev_match);
+static void search_job (void *arg, const ulong worker);
+static void search_chunk (void *arg);
+static void write_chunk (void *arg);
+static void sniff_region (void *arg);
+static void find_line_end (void *arg);
+static SCANNER *new_scanner (OPTIONS * cop, const SCANNER * proto);
+static void free_scanner (SCANNER * sp);
+static BOOL load_input (SCANNER * sp, INPUT_FILE * node);
+static BOOL sniff_input (SCANNER * sp, INPUT_FILE * node);
+static INDEX *open_candidates (OPTIONS * cop, const SCANNER * sp);
+static ulong match_strings (OPTIONS * cop, const SCANNER * sp,
+                            char *const **strs, const size_t ** lens);
+static SIDECAR *load_sidecar (const SCANNER * sp, INPUT_FILE * node);
+static BOOL next_region (const SIDECAR * scp, ulong * blk, const size_t size,
+                         size_t * start, size_t * end, ulong * lines);
+static void scan_blocks (SCANNER * sp);
+static void scan_cached (SCANNER * sp);
+static void store_results (SCANNER * sp);
+static ulong scan_input (SCANNER * sp, const int fd, const char *path);
+static void scan_mapped (void *arg);
+static void *map_input (const int fd, const off_t size);
+static void scan_stream (SCANNER * sp, const int fd);
+static BOOL find_part (SCANNER * sp, const uchar * p, size_t n,
+                       const BOOL first, const BOOL last);
+static void select_long_line (SCANNER * sp, const size_t kept,
+                              const BOOL hit);
+static void grow_buffer (SCANNER * sp, const size_t kept);
+static size_t keep_context (SCANNER * sp, const size_t end);
+static void select_lines (SCANNER * sp, const uchar * p, const uchar * end);
+static void reject_lines (SCANNER * sp, const uchar * p, const uchar * end);
+static void count_selected (SCANNER * sp, const uchar * p, const uchar * end);
+static void count_rejected (SCANNER * sp, const uchar * p, const uchar * end);
+static void print_line (SCANNER * sp, const uchar * line, const uchar * next);
+static void keep_line (SCANNER * sp, const uchar * line, const uchar * next,
+                       const ulong line_num);
+static void print_context (SCANNER * sp, const uchar * line,
+                           const BOOL before);
+static void write_context (SCANNER * sp, const uchar * line,
+                           const uchar * next);
+static void write_separator (SCANNER * sp);
+static ulong line_number (SCANNER * sp, const uchar * line);
+static void write_line (SCANNER * sp, const uchar * line, const uchar * next,
+                        const ulong line_num, const BOOL context);
+static void print_num_matches (OPTIONS * cop, OUTPUT_BUFFER * out,
+                               const char *path, ulong num_match);
+static void print_num_lines (OPTIONS * cop, OUTPUT_BUFFER * out,
+                             const char *path, ulong num_lines);
+static void print_total_lines (OPTIONS * cop, OUTPUT_BUFFER * out,
+                               ulong total);
+static const uchar *find_pattern (SCANNER * sp, const uchar * p, size_t n);
+static const uchar *find_patterns (SCANNER * sp, const uchar * p, size_t n);
+static const uchar *find_regex (SCANNER * sp, const uchar * p, size_t n);
+static const uchar *find_nothing (SCANNER * sp, const uchar * p, size_t n);
+static ulong count_lines (SCANNER * sp, const uchar * p, const uchar * end);
+static char *memlwr (char *str, size_t n);
 
 /* functions. */
 
 /*!
    \fn BOOL process_input_files (INPUT_FILES *, OPTIONS *)
 
-   \brief A function that process the linked list input files.
+   \brief A function that process the input files list.
 
-   This function process the linked list input files (`listp'). For each
-   input file, reads data (line by line) and checks if the current line
-   matches to the pattern that user has given. Also, this function keeps
-   in mind all the command line arguments (`cop'). At the end, if there
-   is no match found it returns `true'. Otherwise, it returns `false'.
+   This function process the input files list (`listp'). For each
+   input file, reads data (block by block) and prints the lines which
+   match to the pattern that user has given. Also, this function keeps
+   in mind all the command line arguments (`cop'). If the user wants
+   more than one job, the input files are searched in parallel. At the
+   end, if there is no match found it returns `true'. Otherwise, it
+   returns `false'.
 
    \param listp a pointer to a `INPUT_FILES' data structure.
    \param cop a pointer to a `OPTIONS' data structure.
@@ -78,251 +828,110 @@ process_input_files (INPUT_FILES * listp, OPTIONS * cop)
 {
   /* externs. */
 
-  /* variable externs. */
-  extern cstring show_max_matches;
-
   /* function externs. */
-  extern FILE *efopen (const char *, const char *);
+  extern OUTPUT_BUFFER *new_output_buffer (const int);
+  extern void free_output_buffer (OUTPUT_BUFFER *);
+  extern void close_input_file (INPUT_FILE *);
+  extern void free_input_file (INPUT_FILE *);
+  extern ulong count_input_files (INPUT_FILES *);
+  extern ulong default_num_jobs (void);
+  extern BOOL index_skips (const INDEX *, const INPUT_FILE *);
+  extern void free_index (INDEX *);
+  extern RESULT_CACHE *open_result_cache (OPTIONS *);
+  extern void free_result_cache (RESULT_CACHE *);
 
   /* local variables. */
 
-  /* current line of chars within a file. */
-  char data_line_init[MAX_LINE] = { '\0' };
-  char data_line_case[MAX_LINE] = { '\0' };
-
   /* do we have at least one match? */
   BOOL found_match = false;
 
-  /* current line in the input file. */
-  register ulong curr_line = 0L;
+  /* number of matches in the previous input file. */
+  ulong prev_match = 0L;
 
-  /* number of matches in the input file. */
-  register ulong num_match = 0L;
+  /* number of matches in all the input files. */
+  ulong total = 0L;
 
-  /* if user wants case insensitive string search. */
-  if (cop->ignore_case)
-    strlwr (cop->pattern);
+  /* the number of the jobs. */
+  const ulong num_jobs = (cop->jobs ? cop->jobs : default_num_jobs ());
 
-  /* process input files. */
+  /* the scanner of this run. */
+  SCANNER *sp;
 
-  /* walk through the input files linked list. */
-  while (listp != NULL)
-    {
-      if ((listp->ptr = efopen (listp->path, "r")) == NULL)
-        {
-          /* move to the next list node. */
-          listp = listp->next;
-          continue;
-        }
+  /* the input files to search. */
+  SOURCE src;
+  INPUT_FILE *node;
+  BOOL release;
 
-      /* if verbose option is enabled 
-         print now the input file path. */
-      if (cop->verbose)
-        fprintf (stdout, " * [%s]%s", listp->path, NEW_LINE);
+  /* the index of the input files. */
+  INDEX *ip;
+  BOOL pruned;
 
-      /* start fetching lines from file until EOF found. */
-      while (fgets (data_line_init, MAX_LINE, listp->ptr) != NULL)
-        {
-          /* get current line number. */
-          ++curr_line;
+  /* search the input files in parallel. */
+  if (num_jobs > 1
+      && (count_input_files (listp) > 0 || cop->files_from != NULL))
+    return search_parallel (listp, cop, num_jobs);
 
-          /* user wants case insensitive keep
-             a lowercase version of the line. */
-          if (cop->ignore_case)
-            strlwr (strcpy (data_line_case, data_line_init));
+  sp = new_scanner (cop, NULL);
+  sp->out = new_output_buffer (STDOUT_FILENO);
+  ip = open_candidates (cop, sp);
 
-          /* if user wants to display the lines
-             that do not match with the pattern. */
-          if (cop->reverse_match)
-            {
-              /* if user wants to ignore case distinctions. */
-              if (cop->ignore_case)
-                {
-                  if (strstr (data_line_case, cop->pattern) == NULL)
-                    {
-                      /* if verbose option is enabled. */
-                      if (cop->verbose)
-                        {
-                          /* print only when we are in the first line. */
-                          if (!num_match)
-                            fprintf (stdout, "%s", NEW_LINE);
-
-                          /* print tab space. */
-                          fprintf (stdout, "%s", TAB_SPACE);
-                        }
-
-                      /* print the filepath. */
-                      if (!cop->verbose)
-                        fprintf (stdout, "%s:", listp->path);
-
-                      /* user wants to print the line number. */
-                      if (cop->line_number)
-                        fprintf (stdout, "%lu:", curr_line);
-
-                      /* print the data line. */
-                      fprintf (stdout, "%s", data_line_init);
-
-                      /* increase the cnt of max
-                         matches within the file. */
-                      ++num_match;
-
-                      /* this is for informing the caller
-                         that at least one match occurred. */
-                      found_match = true;
-                    }
-                }
-              else
-                {
-                  if (strstr (data_line_init, cop->pattern) == NULL)
-                    {
-                      /* if verbose option is enabled. */
-                      if (cop->verbose)
-                        {
-                          /* print only when we are in the first line. */
-                          if (!num_match)
-                            fprintf (stdout, "%s", NEW_LINE);
-
-                          /* print tab space. */
-                          fprintf (stdout, "%s", TAB_SPACE);
-                        }
-
-                      /* print the filepath. */
-                      if (!cop->verbose)
-                        fprintf (stdout, "%s:", listp->path);
-
-                      /* user wants to print the line number. */
-                      if (cop->line_number)
-                        fprintf (stdout, "%lu:", curr_line);
-
-                      /* print the data line. */
-                      fprintf (stdout, "%s", data_line_init);
-
-                      /* increase the cnt of max
-                         matches within the file. */
-                      ++num_match;
-
-                      /* this is for informing the caller
-                         that at least one match occurred. */
-                      found_match = true;
-                    }
-                }
-            }
-          /* otherwise, print the line
-             that matches with pattern. */
-          else
-            {
-              /* if user wants to ignore case distinctions. */
-              if (cop->ignore_case)
-                {
-                  if (strstr (data_line_case, cop->pattern) != NULL)
-                    {
-                      /* if verbose option is enabled. */
-                      if (cop->verbose)
-                        {
-                          /* print only when we are in the first line. */
-                          if (!num_match)
-                            fprintf (stdout, "%s", NEW_LINE);
-
-                          /* print tab space. */
-                          fprintf (stdout, "%s", TAB_SPACE);
-                        }
-
-                      /* print the filepath. */
-                      if (!cop->verbose)
-                        fprintf (stdout, "%s:", listp->path);
-
-                      /* user wants to print the line number. */
-                      if (cop->line_number)
-                        fprintf (stdout, "%lu:", curr_line);
-
-                      /* print the data line. */
-                      fprintf (stdout, "%s", data_line_init);
-
-                      /* increase the cnt of max
-                         matches within the file. */
-                      ++num_match;
-
-                      /* this is for informing the caller
-                         that at least one match occurred. */
-                      found_match = true;
-                    }
-                }
-              else
-                {
-                  if (strstr (data_line_init, cop->pattern) != NULL)
-                    {
-                      /* if verbose option is enabled. */
-                      if (cop->verbose)
-                        {
-                          /* print only when we are in the first line. */
-                          if (!num_match)
-                            fprintf (stdout, "%s", NEW_LINE);
-
-                          /* print tab space. */
-                          fprintf (stdout, "%s", TAB_SPACE);
-                        }
-
-                      /* print the filepath. */
-                      if (!cop->verbose)
-                        fprintf (stdout, "%s:", listp->path);
-
-                      /* user wants to print the line number. */
-                      if (cop->line_number)
-                        fprintf (stdout, "%lu:", curr_line);
-
-                      /* print the data line. */
-                      fprintf (stdout, "%s", data_line_init);
-
-                      /* increase the cnt of max
-                         matches within the file. */
-                      ++num_match;
-
-                      /* this is for informing the caller
-                         that at least one match occurred. */
-                      found_match = true;
-                    }
-                }
-            }
-        }
+  /* the lines around the selected ones are not cached. */
+  sp->cache = (sp->context ? NULL : open_result_cache (cop));
+
+  /* process input files. */
 
-      /* now print a newline only if at least one
-         match found and this isn't the last file. */
-      if (cop->verbose && num_match)
-        if (listp->next != NULL)
-          fprintf (stdout, "%s", NEW_LINE);
+  /* walk through the regular input files. */
+  init_source (&src, listp, cop, num_jobs);
+  while ((node = next_input_file (&src, &release)) != NULL)
+    {
+      /* an input file which the index rules out has no match. */
+      pruned = (ip != NULL && index_skips (ip, node)) ? true : false;
 
-      /* if user wants to print the number of matches. */
-      if (cop->max_matches && num_match)
+      /* accept only ascii files (the first
+         block of the input file is sniffed). */
+      if (pruned ? sniff_input (sp, node) : load_input (sp, node))
         {
           /* if verbose option is enabled
-             and this is the last file. */
-          if (cop->verbose && (listp->next == NULL))
-            fprintf (stdout, "%s", NEW_LINE);
+             print now the input file path. */
+          print_file_path (cop, sp->out, node->path, prev_match);
 
-          /* if verbose option is enabled. */
-          if (cop->verbose)
-            fprintf (stdout, "%s", "   ");
+          /* search the whole input file. */
+          prev_match = (pruned ? 0L : scan_input (sp, node->fd, node->path));
 
-          fprintf (stdout, "%s %lu.%s", _(show_max_matches), num_match,
-                   NEW_LINE);
+          /* if user wants to print the number of matches. */
+          print_num_matches (cop, sp->out, node->path, prev_match);
+          print_num_lines (cop, sp->out, node->path, prev_match);
+          total += prev_match;
 
-          /* if verbose option is enabled
-             and this isn't the last file. */
-          if (cop->verbose && (listp->next != NULL))
-            fprintf (stdout, "%s", NEW_LINE);
+          /* this is for informing the caller
+             that at least one match occurred. */
+          if (prev_match)
+            found_match = true;
         }
 
-      /* zero counters. */
-      curr_line = num_match = 0L;
+      /* close input file descriptor. */
+      close_input_file (node);
 
-      /* close input file pointer. */
-      if (listp->ptr != NULL)
-        fclose (listp->ptr);
+      /* a walked or a listed input file is not kept. */
+      if (release)
+        free_input_file (node);
 
-      /* move to the next list node. */
-      listp = listp->next;
+      /* the exit status is known at the first match. */
+      if (found_match && cop->quiet)
+        break;
     }
 
+  close_source (&src);
+
+  /* if user wants to print the number of the selected lines. */
+  print_total_lines (cop, sp->out, total);
+
+  /* release the output, the index, the cache and the scanner. */
+  free_output_buffer (sp->out);
+  free_index (ip);
+  free_result_cache (sp->cache);
+  free_scanner (sp);
+
   /* return status to the caller. */
   return found_match;
 }
@@ -332,9 +941,9 @@ process_input_files (INPUT_FILES * listp, OPTIONS * cop)
 
    \brief A function that process the data from an input stream.
 
-   This function process the `input' stream. It reads data (line by
-   line) and checks if the current line matches to the pattern that
-   user has given. Also, it keeps in mind all the command line args
+   This function process the `input' stream. It reads data (block by
+   block) and prints the lines which match to the pattern that user
+   has given. Also, it keeps in mind all the command line arguments
    (`cop'). At the end, if there isn't any match found it returns
    `true'. Otherwise, it returns `false'.
 
@@ -348,159 +957,3043 @@ process_input_file (FILE * input, OPTIONS * cop)
 {
   /* externs. */
 
-  /* variable externs. */
-  extern cstring show_max_matches;
+  /* function externs. */
+  extern OUTPUT_BUFFER *new_output_buffer (const int);
+  extern void free_output_buffer (OUTPUT_BUFFER *);
 
-  /* local variables. */
+  /* number of matches in the input stream. */
+  ulong num_match;
+
+  /* the scanner of this run. */
+  SCANNER *sp = new_scanner (cop, NULL);
+
+  sp->out = new_output_buffer (STDOUT_FILENO);
+
+  /* search the whole input stream. */
+  num_match = scan_input (sp, fileno (input), NULL);
+
+  /* if user wants to print the number of matches. */
+  print_num_matches (cop, sp->out, NULL, num_match);
+  print_num_lines (cop, sp->out, NULL, num_match);
+
+  /* release the output and the scanner. */
+  free_output_buffer (sp->out);
+  free_scanner (sp);
 
-  /* current line of chars within a file. */
-  char data_line_init[MAX_LINE] = { '\0' };
-  char data_line_case[MAX_LINE] = { '\0' };
+  /* return status to the caller. */
+  return (num_match ? true : false);
+}
+
+/*!
+   \fn static BOOL search_parallel (INPUT_FILES *, OPTIONS *, const ulong)
+
+   \brief A function that searches the input files in parallel.
+
+   This function searches the input files list (`listp') with
+   a pool of `num_jobs' worker threads. The input files are opened
+   and submitted in order, while at most `JOBS_WINDOW' jobs per worker
+   are in flight. A large regular input file is mapped in memory and
+   split in chunks of about `CHUNK_SIZE' characters (which end at a new
+   line), so that a single input file is searched by all the workers
+   (only in the admitted blocks, if it has block filters), unless it
+   has a cached result, then it is a single job (the printer keeps the
+   records of the chunks of the other ones for the result cache).
+   The output of each job is flushed as soon as all the previous ones
+   are flushed, so it is the same as the output of a serial search.
+   At the end, if there is no match found it returns `true'. Otherwise,
+   it returns `false'.
+
+   \param listp a pointer to a `INPUT_FILES' data structure.
+   \param cop a pointer to a `OPTIONS' data structure.
+   \param num_jobs a constant unsigned long integer.
+
+   \return A `BOOL' enumeration value (`false', `true').
+*/
+static BOOL
+search_parallel (INPUT_FILES * listp, OPTIONS * cop, const ulong num_jobs)
+{
+  /* externs. */
+
+  /* function externs. */
+  extern OUTPUT_BUFFER *new_output_buffer (const int);
+  extern void free_output_buffer (OUTPUT_BUFFER *);
+  extern void *emalloc (size_t);
+  extern void close_input_file (INPUT_FILE *);
+  extern void free_input_file (INPUT_FILE *);
+  extern THREAD_POOL *new_thread_pool (const ulong);
+  extern void free_thread_pool (THREAD_POOL *);
+  extern void thread_pool_submit (THREAD_POOL *, TASK_FUNC, void *);
+  extern BOOL index_skips (const INDEX *, const INPUT_FILE *);
+  extern void free_index (INDEX *);
+  extern void free_sidecar (SIDECAR *);
+  extern RESULT_CACHE *open_result_cache (OPTIONS *);
+  extern void free_result_cache (RESULT_CACHE *);
+  extern CACHED_RESULT *find_result (const RESULT_CACHE *,
+                                     const INPUT_FILE *);
+  extern BOOL run_guarded (void (*) (void *), void *);
+
+  /* local variables. */
 
   /* do we have at least one match? */
   BOOL found_match = false;
 
-  /* current line in the input file. */
-  register ulong curr_line = 0L;
+  /* number of matches in the previous input file. */
+  ulong prev_match = 0L;
 
-  /* number of matches in the input file. */
-  register ulong num_match = 0L;
+  /* number of matches in all the input files. */
+  ulong total = 0L;
 
-  /* if user wants case insensitive string search. */
-  if (cop->ignore_case)
-    strlwr (cop->pattern);
+  /* the submitted and the flushed jobs. */
+  ulong submitted = 0L, flushed = 0L;
 
-  /* process input. */
+  /* the ordered output. */
+  EMITTER em;
 
-  /* start fetching lines from file until EOF found. */
-  while (fgets (data_line_init, MAX_LINE, input) != NULL)
-    {
-      /* get current line number. */
-      ++curr_line;
+  /* the worker threads. */
+  THREAD_POOL *pool;
+
+  /* the printer of the chunk records. */
+  SCANNER *printer;
+
+  /* the current job and input file. */
+  JOB *jp;
+  INPUT_FILE *node = NULL;
+
+  /* the input files to search. */
+  SOURCE src;
+  BOOL release = false;
+
+  /* the index of the input files. */
+  INDEX *ip;
+  BOOL pruned;
+
+  /* the result cache of the workers and the printer, and the
+     cached result of the input file. */
+  RESULT_CACHE *cache;
+  CACHED_RESULT *result;
+
+  /* is the exit status known? */
+  BOOL quit = false;
+
+  /* the mapped input file which is split in chunks. */
+  void *map = NULL;
+  size_t map_size = 0;
+  const uchar *pos = NULL, *map_end = NULL, *end;
+  BOOL first = false;
+
+  /* the region of the mapped input file which is read. */
+  REGION region;
+
+  /* the block filters of the mapped input file, its next block and
+     its region of the admitted blocks (the chunks are split in it). */
+  SIDECAR *scp = NULL;
+  ulong blk = 0L, lines, done_lines = 0L, skip_lines = 0L;
+  size_t start, stop;
+
+  /* is used for the loops. */
+  register ulong i;
+
+  /* one scanner per worker (sharing the automaton). */
+  em.scanners = (SCANNER **) emalloc (num_jobs * sizeof (SCANNER *));
+  em.scanners[0] = new_scanner (cop, NULL);
+  for (i = 1L; i < num_jobs; i++)
+    em.scanners[i] = new_scanner (cop, em.scanners[0]);
+
+  printer = new_scanner (cop, em.scanners[0]);
+  printer->out = new_output_buffer (STDOUT_FILENO);
+  ip = open_candidates (cop, em.scanners[0]);
+
+  /* the lines around the selected ones are not cached. */
+  cache = (printer->context ? NULL : open_result_cache (cop));
+  for (i = 0L; i < num_jobs; i++)
+    em.scanners[i]->cache = cache;
+  printer->cache = cache;
+
+  em.size = num_jobs * JOBS_WINDOW;
+  em.jobs = (JOB *) emalloc (em.size * sizeof (JOB));
+  pthread_mutex_init (&em.lock, NULL);
+  pthread_cond_init (&em.finished, NULL);
+  em.quit = false;
+
+  pool = new_thread_pool (num_jobs);
+  init_source (&src, listp, cop, num_jobs);
 
-      /* user wants case insensitive keep
-         a lowercase version of the line. */
-      if (cop->ignore_case)
-        strlwr (strcpy (data_line_case, data_line_init));
+  for (;;)
+    {
+      /* the exit status is known (no more jobs). */
+      pthread_mutex_lock (&em.lock);
+      quit = em.quit;
+      pthread_mutex_unlock (&em.lock);
 
-      /* if user wants to display the lines
-         that do not match with the pattern. */
-      if (cop->reverse_match)
+      /* keep the window of the jobs full. */
+      while (!quit && submitted - flushed < em.size)
         {
-          /* if user wants to ignore case distinctions. */
-          if (cop->ignore_case)
+          if (pos == NULL)
             {
-              if (strstr (data_line_case, cop->pattern) == NULL)
+              /* there are no more regular input files. */
+              if ((node = next_input_file (&src, &release)) == NULL)
+                break;
+
+              /* an input file which the index rules out has
+                 no match. */
+              pruned = (ip != NULL && index_skips (ip, node)) ? true
+                : false;
+
+              /* a small input file is a single job (the worker
+                 sniffs its first block), and so is any input
+                 file if lines are printed around the selected
+                 ones, or if it is ruled out. */
+              if (pruned || node->size <= CHUNK_SIZE || printer->context
+                  || (map = map_input (node->fd, node->size)) == NULL)
                 {
-                  /* user wants to print the line number. */
-                  if (cop->line_number)
-                    fprintf (stdout, "%lu:", curr_line);
+                  jp = new_job (&em, submitted++, node);
+                  jp->release = release;
+                  jp->pruned = pruned;
+                  thread_pool_submit (pool, search_job, jp);
+                  continue;
+                }
 
-                  /* print the data line. */
-                  fprintf (stdout, "%s", data_line_init);
+              map_size = (size_t) node->size;
 
-                  /* increase the cnt of max
-                     matches within the file. */
-                  ++num_match;
+              /* an input file which shrinks at once is a single
+                 job (which reads what is left of it). */
+              region.begin = (const uchar *) map;
+              region.end = region.begin + map_size;
+              if (!run_guarded (sniff_region, &region))
+                {
+                  munmap (map, map_size);
 
-                  /* this is for informing the caller
-                     that at least one match occurred. */
-                  found_match = true;
+                  jp = new_job (&em, submitted++, node);
+                  jp->release = release;
+                  thread_pool_submit (pool, search_job, jp);
+                  continue;
                 }
-            }
-          else
-            {
-              if (strstr (data_line_init, cop->pattern) == NULL)
+
+              /* accept only ascii files. */
+              if (region.info == f_binary)
                 {
-                  /* user wants to print the line number. */
-                  if (cop->line_number)
-                    fprintf (stdout, "%lu:", curr_line);
+                  munmap (map, map_size);
+                  close_input_file (node);
+
+                  /* a walked or a listed input file is not kept. */
+                  if (release)
+                    free_input_file (node);
+                  continue;
+                }
 
-                  /* print the data line. */
-                  fprintf (stdout, "%s", data_line_init);
+              /* an input file which has a cached result is not
+                 searched, the worker prints it as a single job. */
+              if (cache != NULL
+                  && (result = find_result (cache, node)) != NULL)
+                {
+                  munmap (map, map_size);
 
-                  /* increase the cnt of max
-                     matches within the file. */
-                  ++num_match;
+                  jp = new_job (&em, submitted++, node);
+                  jp->release = release;
+                  jp->result = result;
+                  thread_pool_submit (pool, search_job, jp);
+                  continue;
+                }
 
-                  /* this is for informing the caller
-                     that at least one match occurred. */
-                  found_match = true;
+              /* the chunks are only in the admitted blocks. */
+              start = 0;
+              stop = map_size;
+              lines = 0L;
+              blk = 0L;
+              scp = load_sidecar (printer, node);
+              if (scp != NULL
+                  && !next_region (scp, &blk, map_size, &start, &stop,
+                                   &lines))
+                {
+                  /* the block filters rule out the input file. */
+                  munmap (map, map_size);
+                  free_sidecar (scp);
+                  scp = NULL;
+
+                  jp = new_job (&em, submitted++, node);
+                  jp->release = release;
+                  jp->pruned = true;
+                  thread_pool_submit (pool, search_job, jp);
+                  continue;
                 }
+
+              /* the mapping outlives the input file descriptor. */
+              close_input_file (node);
+
+              pos = (const uchar *) map + start;
+              map_end = (const uchar *) map + stop;
+              first = true;
+              skip_lines = lines;
+              done_lines = (scp != NULL && blk <= scp->num_blocks
+                            ? scp->blocks[blk].lines : 0L);
             }
-        }
-      /* otherwise, print the line
-         that matches with pattern. */
-      else
-        {
-          /* if user wants to ignore case distinctions. */
-          if (cop->ignore_case)
+
+          /* the chunk ends at the first new line after its size
+             (or at the end of its region, also if the input file
+             shrinks under it). */
+          end = ((size_t) (map_end - pos) > CHUNK_SIZE ? pos + CHUNK_SIZE
+                 : map_end);
+          region.begin = end;
+          region.end = map_end;
+          if (end < map_end && run_guarded (find_line_end, &region)
+              && region.line_end != NULL)
+            end = region.line_end + 1;
+          else
+            end = map_end;
+
+          jp = new_job (&em, submitted++, node);
+          jp->release = release;
+          jp->first = first;
+          jp->begin = pos;
+          jp->end = end;
+          jp->map = map;
+          jp->map_size = map_size;
+          jp->skip_lines = skip_lines;
+          first = false;
+          skip_lines = 0L;
+          pos = end;
+
+          /* the next region of the admitted blocks. */
+          if (end == map_end && scp != NULL
+              && next_region (scp, &blk, map_size, &start, &stop, &lines))
             {
-              if (strstr (data_line_case, cop->pattern) != NULL)
-                {
-                  /* user wants to print the line number. */
-                  if (cop->line_number)
-                    fprintf (stdout, "%lu:", curr_line);
+              pos = (const uchar *) map + start;
+              map_end = (const uchar *) map + stop;
+              skip_lines = lines - done_lines;
+              done_lines = (blk <= scp->num_blocks
+                            ? scp->blocks[blk].lines : 0L);
+            }
+
+          /* the last chunk releases the mapping. */
+          jp->last = (pos == map_end ? true : false);
+          if (jp->last)
+            {
+              pos = NULL;
+              free_sidecar (scp);
+              scp = NULL;
+            }
 
-                  /* print the data line. */
-                  fprintf (stdout, "%s", data_line_init);
+          thread_pool_submit (pool, search_job, jp);
+        }
 
-                  /* increase the cnt of max
-                     matches within the file. */
-                  ++num_match;
+      /* all the jobs are flushed. */
+      if (flushed == submitted)
+        break;
 
-                  /* this is for informing the caller
-                     that at least one match occurred. */
-                  found_match = true;
-                }
+      /* wait for the oldest job. */
+      jp = &em.jobs[flushed++ % em.size];
+
+      pthread_mutex_lock (&em.lock);
+      while (!jp->done)
+        pthread_cond_wait (&em.finished, &em.lock);
+      pthread_mutex_unlock (&em.lock);
+
+      /* the records of the chunks of an input file are kept for
+         the result cache (unless a chunk is cut short or skipped). */
+      if (jp->begin != NULL && cache != NULL)
+        {
+          if (jp->first)
+            {
+              printer->keep = true;
+              printer->num_recs = 0L;
             }
-          else
+          if (jp->skipped || jp->cut)
+            printer->keep = false;
+        }
+
+      /* a binary input file is not listed at all. */
+      if (!jp->skipped)
+        {
+          if (jp->first)
             {
-              if (strstr (data_line_init, cop->pattern) != NULL)
-                {
-                  /* user wants to print the line number. */
-                  if (cop->line_number)
-                    fprintf (stdout, "%lu:", curr_line);
+              /* if verbose option is enabled
+                 print now the input file path. */
+              print_file_path (cop, printer->out, jp->node->path,
+                               prev_match);
+
+              /* the printer starts the input file. */
+              printer->path = jp->node->path;
+              printer->named = (cop->verbose ? false : true);
+              printer->tabbed = (cop->verbose ? true : false);
+              printer->curr_line = printer->num_match = 0L;
+              printer->shown = false;
+            }
 
-                  /* print the data line. */
-                  fprintf (stdout, "%s", data_line_init);
+          /* flush the output of the job. */
+          flush_job (jp, printer);
 
-                  /* increase the cnt of max
-                     matches within the file. */
-                  ++num_match;
+          if (jp->last)
+            {
+              prev_match = printer->num_match;
+              total += prev_match;
 
-                  /* this is for informing the caller
-                     that at least one match occurred. */
-                  found_match = true;
-                }
+              /* this is for informing the caller
+                 that at least one match occurred. */
+              if (prev_match)
+                found_match = true;
             }
         }
+
+      /* a skipped chunk releases the mapping too. */
+      else if (jp->last && jp->map != NULL)
+        munmap (jp->map, jp->map_size);
+
+      /* a walked or a listed input file is not kept. */
+      if (jp->last && jp->release)
+        free_input_file (jp->node);
     }
 
-  /* print only if at least one match found and
-     user wants to print the number of matches. */
-  if (cop->max_matches && num_match)
-    fprintf (stdout, "%s %lu.%s", _(show_max_matches), num_match, NEW_LINE);
+  /* the rest of a split input file is not submitted. */
+  if (pos != NULL)
+    {
+      munmap (map, map_size);
+      free_sidecar (scp);
+      if (release)
+        free_input_file (node);
+    }
+
+  /* release the workers, the index, the cache and the scanners. */
+  free_thread_pool (pool);
+  close_source (&src);
+  free_index (ip);
+  free_result_cache (cache);
+
+  /* a match is known even if its chunks were skipped. */
+  if (em.quit)
+    found_match = true;
+
+  /* if user wants to print the number of the selected lines. */
+  print_total_lines (cop, printer->out, total);
+
+  free_output_buffer (printer->out);
+  free_scanner (printer);
+  for (i = num_jobs; i > 0; i--)
+    free_scanner (em.scanners[i - 1]);
+
+  pthread_cond_destroy (&em.finished);
+  pthread_mutex_destroy (&em.lock);
+  free (em.scanners);
+  free (em.jobs);
 
   /* return status to the caller. */
   return found_match;
 }
 
 /*!
-   \fn static char * strlwr (char *)
+   \fn static JOB * new_job (EMITTER *, const ulong, INPUT_FILE *)
+
+   \brief A function that returns the next job of the ordered output.
+
+   This function initializes the `index' job of the ring of the
+   ordered output (`emp') as the whole input file job of `node'.
+
+   \param emp a pointer to a `EMITTER' data structure.
+   \param index a constant unsigned long integer.
+   \param node a pointer to a `INPUT_FILE' data structure.
+
+   \return A pointer to a `JOB' data structure.
+*/
+static JOB *
+new_job (EMITTER * emp, const ulong index, INPUT_FILE * node)
+{
+  JOB *jp = &emp->jobs[index % emp->size];
+
+  jp->node = node;
+  jp->emp = emp;
+  jp->begin = jp->end = NULL;
+  jp->first = jp->last = true;
+  jp->map = NULL;
+  jp->map_size = 0;
+  jp->recs = NULL;
+  jp->max_recs = 0L;
+  jp->num_lines = jp->skip_lines = 0L;
+  jp->skipped = false;
+  jp->cut = false;
+  jp->result = NULL;
+  jp->pruned = false;
+  jp->out = NULL;
+  jp->num_match = 0L;
+  jp->release = false;
+  jp->done = false;
+
+  return jp;
+}
+
+/*!
+   \fn static void init_source (SOURCE *, INPUT_FILES *, OPTIONS *, const ulong)
+
+   \brief A function that initializes the source of the input files.
+
+   This function initializes the source (`src') of the input files,
+   which starts from the operands (`listp') and continues with the
+   file list of the command line arguments (`cop'), if any (it exits
+   if the file list can not be opened). The directories are walked
+   (with at most `num_jobs' walker threads) if the command line
+   arguments ask for a recursive search.
+
+   \param src a pointer to a `SOURCE' data structure.
+   \param listp a pointer to a `INPUT_FILES' data structure.
+   \param cop a pointer to a `OPTIONS' data structure.
+   \param num_jobs a constant unsigned long integer.
+*/
+static void
+init_source (SOURCE * src, INPUT_FILES * listp, OPTIONS * cop,
+             const ulong num_jobs)
+{
+  /* externs. */
+
+  /* function externs. */
+  extern void eprintf (char *, ...);
+
+  src->listp = listp;
+  src->next = 0L;
+  src->walk = NULL;
+  src->num_walkers = (num_jobs < MAX_WALKERS ? num_jobs : MAX_WALKERS);
+  src->recursive = cop->recursive;
+  src->from = NULL;
+  src->delim = (cop->null_names ? '\0' : '\n');
+  src->name = NULL;
+  src->name_size = 0;
+
+  /* open the file list ("-" is the standard input). */
+  if (cop->files_from == NULL)
+    return;
+
+  if (!strcmp (cop->files_from, "-"))
+    src->from = stdin;
+  else if ((src->from = fopen (cop->files_from, "r")) == NULL)
+    eprintf ("fopen(\"%.500s\") failed:", cop->files_from);
+}
+
+/*!
+   \fn static void close_source (SOURCE *)
+
+   \brief A function that releases the source of the input files.
+
+   This function stops the walk and closes the file list
+   of the source (`src'), even if they are not finished.
+
+   \param src a pointer to a `SOURCE' data structure.
+*/
+static void
+close_source (SOURCE * src)
+{
+  /* externs. */
+
+  /* function externs. */
+  extern void free_walk (WALK *);
+
+  if (src->walk != NULL)
+    free_walk (src->walk);
+
+  if (src->from != NULL && src->from != stdin)
+    fclose (src->from);
+
+  free (src->name);
+
+  src->walk = NULL;
+  src->from = NULL;
+  src->name = NULL;
+}
+
+/*!
+   \fn static INPUT_FILE * next_input_file (SOURCE *, BOOL *)
+
+   \brief A function that returns the next regular input file.
+
+   This function returns the next regular input file of the source
+   (`src') opened, or NULL if there are not any more. The names of the
+   file list are read only when they are needed, so the search starts
+   before the whole list is read. The regular files under a directory
+   come in the order of its walk, while the walker threads list the
+   directories ahead. A walked or a listed input file is a new node
+   (`release' is set to `true') which the caller releases. An operand
+   which is the same file (or directory) as a previous one, under
+   another path, is skipped.
+
+   \param src a pointer to a `SOURCE' data structure.
+   \param release a pointer to a `BOOL' enumeration value.
+
+   \return A pointer to a `INPUT_FILE' data structure.
+*/
+static INPUT_FILE *
+next_input_file (SOURCE * src, BOOL * release)
+{
+  /* externs. */
+
+  /* function externs. */
+  extern INPUT_FILE *new_input_file (const char *);
+  extern void free_input_file (INPUT_FILE *);
+  extern FILE_INFO open_input_file (INPUT_FILE *);
+  extern void close_input_file (INPUT_FILE *);
+  extern ulong count_input_files (INPUT_FILES *);
+  extern BOOL input_file_seen (INPUT_FILES *, INPUT_FILE *);
+  extern WALK *new_walk (const char *, const ulong);
+  extern void free_walk (WALK *);
+  extern char *walk_next (WALK *);
+
+  /* the next input file. */
+  INPUT_FILE *node;
+  char *path;
+
+  /* the type of the input file. */
+  FILE_INFO type;
+
+  for (;;)
+    {
+      /* the next file of the walk. */
+      if (src->walk != NULL)
+        {
+          if ((path = walk_next (src->walk)) != NULL)
+            {
+              node = new_input_file (path);
+              free (path);
+
+              *release = true;
+              if (open_input_file (node) == f_regular)
+                return node;
+
+              free_input_file (node);
+              continue;
+            }
+
+          /* the walk is finished. */
+          free_walk (src->walk);
+          src->walk = NULL;
+        }
+
+      if (src->next < count_input_files (src->listp))
+        {
+          node = &src->listp->files[src->next++];
+
+          *release = false;
+          type = open_input_file (node);
+
+          /* the same file under another path is searched once. */
+          if ((type == f_regular || type == f_directory)
+              && input_file_seen (src->listp, node))
+            {
+              close_input_file (node);
+              continue;
+            }
+        }
+      else if ((path = read_file_name (src)) != NULL)
+        {
+          node = new_input_file (path);
+
+          *release = true;
+          type = open_input_file (node);
+        }
+      else
+        /* there are no more input files. */
+        return NULL;
+
+      if (type == f_regular)
+        return node;
+
+      /* walk the directory. */
+      if (type == f_directory && src->recursive)
+        src->walk = new_walk (node->path, src->num_walkers);
+
+      if (*release)
+        free_input_file (node);
+    }
+}
+
+/*!
+   \fn static char * read_file_name (SOURCE *)
+
+   \brief A function that reads the next name of the file list.
+
+   This function reads the next name of the file list of the source
+   (`src'), delimited by a new line or by a null character. The empty
+   names are skipped. At the end of the file list, it closes the file
+   list and it returns NULL.
+
+   \param src a pointer to a `SOURCE' data structure.
+
+   \return A pointer to a character.
+*/
+static char *
+read_file_name (SOURCE * src)
+{
+  /* externs. */
+
+  /* function externs. */
+  extern void weprintf (char *, ...);
+
+  /* the length of the name. */
+  ssize_t len;
+
+  while (src->from != NULL)
+    {
+      if ((len = getdelim (&src->name, &src->name_size, src->delim,
+                           src->from)) == -1)
+        {
+          if (ferror (src->from))
+            weprintf ("getdelim() failed:");
+
+          if (src->from != stdin)
+            fclose (src->from);
+          src->from = NULL;
+          break;
+        }
+
+      /* drop the delimiter. */
+      if (len > 0 && src->name[len - 1] == (char) src->delim)
+        src->name[--len] = '\0';
+
+      if (len > 0)
+        return src->name;
+    }
+
+  return NULL;
+}
+
+/*!
+   \fn static void flush_job (JOB *, SCANNER *)
+
+   \brief A function that flushes the output of a finished job.
+
+   This function writes the output of a finished job (`jp') to the
+   output of the `printer'. The selected lines of a chunk are printed by the
+   `printer', which keeps the number of the lines and the matches of
+   the previous chunks of the input file (so the line numbers are the
+   sums of the lines of the chunks), and their records for the result
+   cache, which are cached after the last chunk.
+
+   \param jp a pointer to a `JOB' data structure.
+   \param printer a pointer to a `SCANNER' data structure.
+*/
+static void
+flush_job (JOB * jp, SCANNER * printer)
+{
+  /* externs. */
+
+  /* function externs. */
+  extern void free_output_buffer (OUTPUT_BUFFER *);
+  extern void output_write (OUTPUT_BUFFER *, const void *, size_t);
+  extern void output_commit (OUTPUT_BUFFER *);
+  extern BOOL run_guarded (void (*) (void *), void *);
+
+  /* a whole input file. */
+  if (jp->begin == NULL)
+    {
+      /* separate the groups of lines of the input files. */
+      if (printer->context && jp->num_match)
+        {
+          if (printer->grouped && !printer->cop->verbose)
+            write_separator (printer);
+          printer->grouped = true;
+        }
+
+      output_write (printer->out, jp->out->buf, jp->out->len);
+      output_commit (printer->out);
+      free_output_buffer (jp->out);
+
+      printer->num_match = jp->num_match;
+      return;
+    }
+
+  /* the counted lines of a chunk (up to the limit of the file). */
+  if (printer->count)
+    {
+      printer->num_match += jp->num_match;
+      if (printer->limit && printer->num_match > printer->limit)
+        printer->num_match = printer->limit;
+    }
+
+  /* the lines of the blocks which the block filters skip. */
+  printer->curr_line += jp->skip_lines;
+
+  /* the selected lines of a chunk (up to the limit of the file,
+     or up to the end of a file which shrinks under it). */
+  printer->job = jp;
+  printer->map = jp->map;
+  if (!run_guarded (write_chunk, printer))
+    printer->keep = false;
+  printer->job = NULL;
+  printer->map = NULL;
+
+  printer->curr_line += jp->num_lines;
+  free (jp->recs);
+
+  if (jp->last)
+    {
+      /* if user wants to print the number of matches. */
+      print_num_matches (printer->cop, printer->out, printer->path,
+                         printer->num_match);
+      print_num_lines (printer->cop, printer->out, printer->path,
+                       printer->num_match);
+
+      /* cache the results of the input file. */
+      if (printer->keep)
+        {
+          printer->node = jp->node;
+          store_results (printer);
+        }
+      printer->keep = false;
+
+      munmap (jp->map, jp->map_size);
+    }
+}
+
+/*!
+   \fn static void search_job (void *, const ulong)
+
+   \brief A function that searches an input file on a worker thread.
+
+   This function is the task of a job (`arg'). It loads the input file
+   (a binary one is skipped) and searches it with the scanner of the
+   worker (`worker') into an output buffer, or it records the selected
+   lines of a chunk. At the end, it marks the job finished. If the exit
+   status is already known, the job is skipped.
+
+   \param arg a pointer to void.
+   \param worker a constant unsigned long integer.
+*/
+static void
+search_job (void *arg, const ulong worker)
+{
+  /* externs. */
+
+  /* function externs. */
+  extern OUTPUT_BUFFER *new_output_buffer (const int);
+  extern void close_input_file (INPUT_FILE *);
+  extern BOOL run_guarded (void (*) (void *), void *);
+
+  JOB *jp = (JOB *) arg;
+  EMITTER *emp = jp->emp;
+  SCANNER *sp = emp->scanners[worker];
+
+  /* the page size. */
+  const size_t page = (size_t) sysconf (_SC_PAGESIZE);
+
+  /* the page of the start of the chunk. */
+  size_t base;
+
+  /* is the exit status known? */
+  BOOL quit;
+
+  pthread_mutex_lock (&emp->lock);
+  quit = emp->quit;
+  pthread_mutex_unlock (&emp->lock);
+
+  /* the job is not searched at all. */
+  if (quit)
+    {
+      jp->skipped = true;
+      close_input_file (jp->node);
+    }
+  else if (jp->begin != NULL)
+    {
+      /* read ahead the chunk. */
+      base = (size_t) jp->begin - (size_t) jp->begin % page;
+      madvise ((void *) base, (size_t) jp->end - base, MADV_WILLNEED);
+
+      /* record the selected lines of the chunk (the rest of
+         a file which shrinks under it is taken as its end). */
+      sp->job = jp;
+      sp->curr_line = sp->num_match = 0L;
+      sp->stop = false;
+      sp->line_pos = jp->begin;
+      if (!run_guarded (search_chunk, sp))
+        {
+          jp->num_lines = sp->curr_line;
+          jp->cut = true;
+        }
+      sp->job = NULL;
+
+      jp->num_match = sp->num_match;
+    }
+  else
+    {
+      /* the cached result which is found already (if any). */
+      sp->result = jp->result;
+
+      if (jp->pruned ? sniff_input (sp, jp->node)
+          : load_input (sp, jp->node))
+        {
+          /* the output is kept in memory. */
+          jp->out = new_output_buffer (-1);
+
+          /* search the whole input file (the emitter
+             separates its groups from the previous ones). */
+          sp->out = jp->out;
+          sp->grouped = false;
+          jp->num_match = (jp->pruned ? 0L
+                           : scan_input (sp, jp->node->fd, jp->node->path));
+
+          /* if user wants to print the number of matches. */
+          print_num_matches (sp->cop, jp->out, jp->node->path,
+                             jp->num_match);
+          print_num_lines (sp->cop, jp->out, jp->node->path,
+                           jp->num_match);
+        }
+      else
+        jp->skipped = true;
+
+      /* close input file descriptor. */
+      close_input_file (jp->node);
+    }
+
+  /* the job is finished (a match is enough if only
+     the exit status is asked for). */
+  pthread_mutex_lock (&emp->lock);
+  jp->done = true;
+  if (jp->num_match && sp->cop->quiet)
+    emp->quit = true;
+  pthread_cond_broadcast (&emp->finished);
+  pthread_mutex_unlock (&emp->lock);
+}
+
+/*!
+   \fn static void search_chunk (void *)
+
+   \brief A function that records the selected lines of a chunk.
+
+   This function searches the chunk of the job of a scanner (`arg')
+   and counts its lines (if they are numbered). It is run under
+   guard (see `run_guarded').
+
+   \param arg a pointer to void.
+*/
+static void
+search_chunk (void *arg)
+{
+  SCANNER *sp = (SCANNER *) arg;
+  JOB *jp = sp->job;
+
+  sp->select (sp, jp->begin, jp->end);
+
+  /* count the lines of the chunk. */
+  if (sp->cop->line_number && !sp->count)
+    jp->num_lines = sp->curr_line + count_lines (sp, sp->line_pos, jp->end);
+}
+
+/*!
+   \fn static void write_chunk (void *)
+
+   \brief A function that prints the selected lines of a chunk.
+
+   This function prints the recorded lines of the chunk of the job of
+   the printer (`arg'), up to the limit of the input file, and keeps
+   them for the result cache (if the printer keeps them). It is run
+   under guard (see `run_guarded').
+
+   \param arg a pointer to void.
+*/
+static void
+write_chunk (void *arg)
+{
+  SCANNER *printer = (SCANNER *) arg;
+  const JOB *jp = printer->job;
+
+  /* the recorded line. */
+  const uchar *line, *next;
+
+  /* is used for the loops. */
+  register ulong i;
+
+  for (i = 0L; !printer->count && i < jp->num_match
+       && (printer->limit == 0 || printer->num_match < printer->limit); i++)
+    {
+      line = jp->begin + jp->recs[i].off;
+      next = line + jp->recs[i].len;
+
+      write_line (printer, line, next,
+                  printer->curr_line + jp->recs[i].line + 1, false);
+      if (printer->keep)
+        keep_line (printer, line, next,
+                   printer->curr_line + jp->recs[i].line + 1);
+    }
+}
+
+/*!
+   \fn static void sniff_region (void *)
+
+   \brief A function that sniffs a region of a mapped input file.
+
+   This function keeps the kind of the data (see `sniff_input_file')
+   of a region (`arg'). It is run under guard (see `run_guarded').
+
+   \param arg a pointer to void.
+*/
+static void
+sniff_region (void *arg)
+{
+  /* externs. */
+
+  /* function externs. */
+  extern FILE_INFO sniff_input_file (const uchar *, size_t);
+
+  REGION *rp = (REGION *) arg;
+
+  rp->info = sniff_input_file (rp->begin, (size_t) (rp->end - rp->begin));
+}
+
+/*!
+   \fn static void find_line_end (void *)
+
+   \brief A function that finds the first new line of a mapped region.
+
+   This function keeps the first new line of a region (`arg'), or
+   NULL if there is not any. It is run under guard (see `run_guarded').
+
+   \param arg a pointer to void.
+*/
+static void
+find_line_end (void *arg)
+{
+  REGION *rp = (REGION *) arg;
+
+  rp->line_end = (const uchar *) memchr (rp->begin, '\n',
+                                         (size_t) (rp->end - rp->begin));
+}
+
+/*!
+   \fn static SCANNER * new_scanner (OPTIONS *, const SCANNER *)
+
+   \brief A function that returns a new `SCANNER' data structure.
+
+   This function allocates a new `SCANNER' data structure and its
+   block buffers. Also, it resolves the matching mode of the command
+   line options (`cop') into the finding and selecting functions of
+   the scanner. If the user wants case insensitive search, then the
+   patterns are lowercased (only once per run). If `proto' is not
+   NULL, then the new scanner shares its matching mode (so that the
+   workers do not compile the patterns again).
+
+   \param cop a pointer to a `OPTIONS' data structure.
+   \param proto a pointer to a constant `SCANNER' data structure.
+
+   \return A pointer to a `SCANNER' data structure.
+*/
+static SCANNER *
+new_scanner (OPTIONS * cop, const SCANNER * proto)
+{
+  /* externs. */
+
+  /* function externs. */
+  extern void *emalloc (size_t);
+  extern SEARCH_KERNEL select_search_kernel (const char *, const BOOL);
+  extern COUNT_KERNEL select_count_kernel (const char *);
+  extern AHO_CORASICK *new_aho_corasick (char *const *, const size_t *,
+                                         const ulong, const BOOL);
+  extern REGEX *new_regex (char *const *, const size_t *,
+                           const ulong, const BOOL);
+  extern LAZY_DFA *new_lazy_dfa (const REGEX *);
+
+  SCANNER *newp;
+
+  /* is used for the loops. */
+  register ulong i;
+
+  /* allocate enough memory space. */
+  newp = (SCANNER *) emalloc (sizeof (SCANNER));
+
+  /* the block buffer keeps one read block after
+     the (possibly partial) last line of the
+     previous one. It grows for a longer line. */
+  newp->size = LINE_ROOM + SCAN_BLOCK;
+  newp->buf = (uchar *) emalloc (newp->size);
+
+  newp->cop = cop;
+  newp->out = NULL;
+  newp->job = NULL;
+  newp->map = NULL;
+  newp->map_size = newp->carry = 0;
+  newp->sidecar = NULL;
+  newp->cache = NULL;
+  newp->result = NULL;
+  newp->node = NULL;
+  newp->keep = false;
+  newp->recs = NULL;
+  newp->num_recs = newp->max_recs = 0L;
+  newp->whole = false;
+  newp->path = NULL;
+  newp->named = newp->tabbed = false;
+  newp->curr_line = newp->num_match = 0L;
+  newp->line_pos = NULL;
+  newp->stop = false;
+
+  /* the search of an input stops at the first selected line if
+     only the existence of a match is asked for. */
+  newp->limit = (cop->quiet || cop->list_files ? 1L : cop->max_count);
+
+  /* the selected lines are only counted (unless
+     the paths or the exit status are asked for). */
+  newp->count = (cop->count_only && !cop->quiet && !cop->list_files
+                 ? true : false);
+
+  /* the lines around the selected ones are printed
+     only if the selected lines are printed. */
+  newp->context = (cop->context && !cop->count_only && !cop->quiet && !cop->list_files
+                   ? true : false);
+  newp->ctx_pos = NULL;
+  newp->after = 0L;
+  newp->gap = newp->grouped = newp->shown = false;
+
+  /* share the matching mode of the prototype. */
+  if (proto != NULL)
+    {
+      newp->pattern = proto->pattern;
+      newp->pattern_len = proto->pattern_len;
+      newp->acp = proto->acp;
+      newp->rxp = proto->rxp;
+      newp->shared = true;
+      newp->kernel = proto->kernel;
+      newp->counter = proto->counter;
+      newp->find = proto->find;
+      newp->select = proto->select;
+      newp->overlap = proto->overlap;
+
+      /* the lazy automaton is built while it runs. */
+      newp->dfa = (proto->rxp != NULL ? new_lazy_dfa (proto->rxp) : NULL);
+
+      return newp;
+    }
+
+  /* if user wants to ignore case distinctions,
+     lowercase the patterns once. The kernel folds
+     the data on the fly. A regular expression
+     folds its own characters. */
+  if (cop->ignore_case && !cop->regex)
+    for (i = 0L; i < cop->num_patterns; i++)
+      memlwr (cop->patterns[i], cop->pattern_lens[i]);
+
+  /* a single pattern is searched by the kernel.
+     An empty patterns file matches no lines. */
+  newp->pattern = (cop->num_patterns > 0 ? cop->patterns[0] : NULL);
+  newp->pattern_len = (cop->num_patterns > 0 ? cop->pattern_lens[0] : 0);
+  newp->acp = NULL;
+  newp->rxp = NULL;
+  newp->dfa = NULL;
+  newp->shared = false;
+  newp->find = (cop->num_patterns > 0 ? find_pattern : find_nothing);
+
+  /* an empty pattern matches all the lines. */
+  for (i = 0L; i < cop->num_patterns; i++)
+    if (cop->pattern_lens[i] == 0)
+      {
+        newp->pattern = cop->patterns[i];
+        newp->pattern_len = 0;
+        break;
+      }
+
+  /* many patterns are compiled into one automaton,
+     so the data is scanned only once. */
+  if (cop->num_patterns > 1 && newp->pattern_len > 0 && !cop->regex)
+    {
+      newp->acp = new_aho_corasick (cop->patterns, cop->pattern_lens,
+                                    cop->num_patterns, cop->ignore_case);
+      newp->find = find_patterns;
+    }
+
+  /* the regular expressions are compiled into one
+     automaton. The literals which they require are
+     searched first (by the kernel or by another
+     automaton) and the automaton runs only on the
+     lines which contain them. */
+  if (cop->regex && cop->num_patterns > 0)
+    {
+      newp->rxp = new_regex (cop->patterns, cop->pattern_lens,
+                             cop->num_patterns, cop->ignore_case);
+      newp->dfa = new_lazy_dfa (newp->rxp);
+      newp->find = find_regex;
+
+      if (newp->rxp->num_literals == 1)
+        {
+          newp->pattern = newp->rxp->literals[0];
+          newp->pattern_len = newp->rxp->literal_lens[0];
+        }
+      else if (newp->rxp->num_literals > 1)
+        newp->acp = new_aho_corasick (newp->rxp->literals,
+                                      newp->rxp->literal_lens,
+                                      newp->rxp->num_literals,
+                                      cop->ignore_case);
+    }
+
+  /* the parts of a too long line overlap by the longest pattern
+     (less one), so a pattern across two parts is found. The
+     automaton of a regular expression goes on from part to part. */
+  newp->overlap = 0;
+  if (!cop->regex)
+    for (i = 0L; i < cop->num_patterns; i++)
+      if (cop->pattern_lens[i] > newp->overlap + 1)
+        newp->overlap = cop->pattern_lens[i] - 1;
+
+  /* the kernel name is checked by the options parser. */
+  newp->kernel = select_search_kernel (cop->kernel, cop->ignore_case);
+  newp->counter = select_count_kernel (cop->kernel);
+
+  /* if user wants to display the lines
+     that do not match with the pattern. */
+  newp->select = (cop->reverse_match ? reject_lines : select_lines);
+
+  /* if user wants only the number of the lines. */
+  if (newp->count)
+    newp->select = (cop->reverse_match ? count_rejected : count_selected);
+
+  /* return the scanner pointer. */
+  return newp;
+}
+
+/*!
+   \fn static void free_scanner (SCANNER *)
+
+   \brief A function that deallocates a `SCANNER' data structure.
+
+   \param sp a pointer to a `SCANNER' data structure.
+*/
+static void
+free_scanner (SCANNER * sp)
+{
+  /* externs. */
+
+  /* function externs. */
+  extern void free_aho_corasick (AHO_CORASICK *);
+  extern void free_regex (REGEX *);
+  extern void free_lazy_dfa (LAZY_DFA *);
+
+  if (!sp->shared)
+    {
+      free_aho_corasick (sp->acp);
+      free_regex (sp->rxp);
+    }
+
+  free_lazy_dfa (sp->dfa);
+
+  free (sp->recs);
+  free (sp->buf);
+  free (sp);
+}
+
+/*!
+   \fn static BOOL load_input (SCANNER *, INPUT_FILE *)
+
+   \brief A function that loads the first block of an open input file.
+
+   This function loads an open regular input file (`node') into the
+   scanner (`sp'): a large enough file is mapped in memory (so that
+   the pattern is searched directly in the page cache), else its
+   first block is read into the block buffer. The loaded block is
+   sniffed for binary data, so the input file is read only once.
+   A mapped input file is read ahead, unless it has a cached result
+   (see `find_result', or the one of the scanner which is found
+   already), then only its selected lines are read,
+   or it has block filters (see `load_sidecar'), then only its
+   admitted blocks are read. If the input file is binary, it returns
+   `false' and nothing is kept loaded.
+
+   \param sp a pointer to a `SCANNER' data structure.
+   \param node a pointer to a `INPUT_FILE' data structure.
+
+   \return A `BOOL' enumeration value (`false', `true').
+*/
+static BOOL
+load_input (SCANNER * sp, INPUT_FILE * node)
+{
+  /* externs. */
+
+  /* function externs. */
+  extern FILE_INFO sniff_input_file (const uchar *, size_t);
+  extern CACHED_RESULT *find_result (const RESULT_CACHE *,
+                                     const INPUT_FILE *);
+  extern void free_result (CACHED_RESULT *);
+  extern BOOL run_guarded (void (*) (void *), void *);
+
+  /* characters of the first read. */
+  ssize_t n;
+
+  /* the sniffed region of the mapped file. */
+  REGION region;
+
+  sp->map = NULL;
+  sp->sidecar = NULL;
+  sp->keep = false;
+  sp->carry = 0;
+
+  /* map the file only where it saves more than it costs. */
+  if (node->size >= MMAP_MIN
+      && (sp->map = map_input (node->fd, node->size)) != NULL)
+    {
+      sp->map_size = (size_t) node->size;
+
+      /* a fault leaves the kind of the data unknown. */
+      region.begin = (const uchar *) sp->map;
+      region.end = region.begin + sp->map_size;
+      region.info = f_io_error;
+      run_guarded (sniff_region, &region);
+
+      /* the file is read soon (not at all, if it has a
+         cached result, or only its admitted blocks, if
+         it has block filters). */
+      if (region.info == f_ascii)
+        {
+          if (sp->cache != NULL)
+            {
+              sp->node = node;
+              sp->keep = true;
+              if (sp->result == NULL)
+                sp->result = find_result (sp->cache, node);
+            }
+
+          if (sp->result != NULL)
+            return true;
+
+          sp->sidecar = load_sidecar (sp, node);
+          if (sp->sidecar == NULL)
+            madvise (sp->map, sp->map_size, MADV_WILLNEED);
+
+          return true;
+        }
+
+      munmap (sp->map, sp->map_size);
+      sp->map = NULL;
+
+      /* what is left of a file which shrinks at once is read. */
+      if (region.info == f_binary)
+        {
+          free_result (sp->result);
+          sp->result = NULL;
+          return false;
+        }
+    }
+
+  /* a cached result is only of a mapped file. */
+  free_result (sp->result);
+  sp->result = NULL;
+
+  /* read the first block (there is room for more). */
+  do
+    n = read (node->fd, sp->buf, SCAN_BLOCK);
+  while (n < 0 && errno == EINTR);
+
+  sp->carry = (n > 0 ? (size_t) n : 0);
+
+  /* a small file needs no more reads. */
+  sp->whole = ((off_t) sp->carry == node->size ? true : false);
+
+  if (sniff_input_file (sp->buf, sp->carry) == f_ascii)
+    return true;
+
+  sp->carry = 0;
+  sp->whole = false;
+
+  return false;
+}
+
+/*!
+   \fn static BOOL sniff_input (SCANNER *, INPUT_FILE *)
+
+   \brief A function that sniffs an input file which is not searched.
+
+   This function reads the first characters of the input file `node'
+   into the block buffer of the scanner (`sp') and sniffs them, as
+   `load_input' does, but nothing is kept loaded. So an input file
+   which the index rules out is shown (with no match) only if it
+   would be searched. If the input file is binary, it returns
+   `false'.
+
+   \param sp a pointer to a `SCANNER' data structure.
+   \param node a pointer to a `INPUT_FILE' data structure.
+
+   \return A `BOOL' enumeration value (`false', `true').
+*/
+static BOOL
+sniff_input (SCANNER * sp, INPUT_FILE * node)
+{
+  /* externs. */
+
+  /* function externs. */
+  extern FILE_INFO sniff_input_file (const uchar *, size_t);
+
+  /* characters of the read. */
+  ssize_t n;
+
+  sp->map = NULL;
+  sp->keep = false;
+  sp->carry = 0;
+  sp->whole = false;
+
+  do
+    n = read (node->fd, sp->buf, SNIFF_BLOCK);
+  while (n < 0 && errno == EINTR);
+
+  return (sniff_input_file (sp->buf, (n > 0 ? (size_t) n : 0)) == f_ascii)
+    ? true : false;
+}
+
+/*!
+   \fn static INDEX * open_candidates (OPTIONS *, const SCANNER *)
+
+   \brief A function that opens the index of the command line arguments.
+
+   This function opens the index file of the command line arguments
+   (`cop'), if any, and selects its candidate files from the strings
+   which any matching line contains: the patterns, or the required
+   literals of the regular expressions of the scanner (`sp'). If the
+   matching is inverted, or the regular expressions have no required
+   literals, then every file is a candidate. If there is no index
+   file, it returns NULL.
+
+   \param cop a pointer to a `OPTIONS' data structure.
+   \param sp a pointer to a constant `SCANNER' data structure.
+
+   \return A pointer to a `INDEX' data structure.
+*/
+static INDEX *
+open_candidates (OPTIONS * cop, const SCANNER * sp)
+{
+  /* externs. */
+
+  /* function externs. */
+  extern INDEX *open_index (const char *);
+  extern void index_select (INDEX *, char *const *, const size_t *,
+                            const ulong, const BOOL);
+
+  /* the index of the input files. */
+  INDEX *ip;
+
+  /* the strings which any matching line contains. */
+  char *const *strs;
+  const size_t *lens;
+  ulong num;
+
+  if (cop->index == NULL)
+    return NULL;
+
+  ip = open_index (cop->index);
+
+  num = match_strings (cop, sp, &strs, &lens);
+  index_select (ip, strs, lens, num, cop->ignore_case);
+
+  return ip;
+}
+
+/*!
+   \fn static ulong match_strings (OPTIONS *, const SCANNER *, char *const **, const size_t **)
+
+   \brief A function that returns the strings of every matching line.
+
+   This function returns the number of the strings (`strs' with
+   lengths `lens') one of which any matching line contains: the
+   patterns of the command line arguments (`cop'), or the required
+   literals of the regular expressions of the scanner (`sp'). If
+   the matching is inverted, there are no such strings (0).
+
+   \param cop a pointer to a `OPTIONS' data structure.
+   \param sp a pointer to a constant `SCANNER' data structure.
+   \param strs a pointer to a pointer to a constant pointer to a character.
+   \param lens a pointer to a pointer to a constant `size_t' type definition.
+
+   \return An unsigned long integer.
+*/
+static ulong
+match_strings (OPTIONS * cop, const SCANNER * sp, char *const **strs,
+               const size_t ** lens)
+{
+  *strs = NULL;
+  *lens = NULL;
+
+  if (cop->reverse_match)
+    return 0L;
+
+  if (sp->rxp != NULL)
+    {
+      *strs = sp->rxp->literals;
+      *lens = sp->rxp->literal_lens;
+      return sp->rxp->num_literals;
+    }
+
+  *strs = cop->patterns;
+  *lens = cop->pattern_lens;
+  return cop->num_patterns;
+}
+
+/*!
+   \fn static SIDECAR * load_sidecar (const SCANNER *, INPUT_FILE *)
+
+   \brief A function that opens the block filters of a mapped input file.
+
+   This function opens the block filters (see `open_sidecar') of the
+   mapped regular input file `node', if the user wants them, and selects its blocks from the strings which
+   any matching line contains (see `match_strings'). The lines around
+   the selected lines and the inverted matching need every block, so
+   then there are no block filters. If there are none, it returns NULL.
+
+   \param sp a pointer to a constant `SCANNER' data structure.
+   \param node a pointer to a `INPUT_FILE' data structure.
+
+   \return A pointer to a `SIDECAR' data structure.
+*/
+static SIDECAR *
+load_sidecar (const SCANNER * sp, INPUT_FILE * node)
+{
+  /* externs. */
+
+  /* function externs. */
+  extern SIDECAR *open_sidecar (const char *, const INPUT_FILE *);
+  extern void sidecar_select (SIDECAR *, char *const *, const size_t *,
+                              const ulong, const BOOL);
+
+  /* the block filters of the input file. */
+  SIDECAR *scp;
+
+  /* the strings which any matching line contains. */
+  char *const *strs;
+  const size_t *lens;
+  ulong num;
+
+  if (!sp->cop->blocks || sp->context || sp->cop->reverse_match)
+    return NULL;
+
+  if ((scp = open_sidecar (node->path, node)) == NULL)
+    return NULL;
+
+  num = match_strings (sp->cop, sp, &strs, &lens);
+  sidecar_select (scp, strs, lens, num, sp->cop->ignore_case);
+
+  return scp;
+}
+
+/*!
+   \fn static BOOL next_region (const SIDECAR *, ulong *, const size_t, size_t *, size_t *, ulong *)
+
+   \brief A function that finds the next region of the admitted blocks.
+
+   This function finds the next run of the admitted blocks of the
+   block filters (`scp') of an input file of `size' characters, from
+   the block `blk' on. The region is from `start' up to `end', and there
+   are `lines' new lines before it. Then, `blk' is the block after
+   the region. If there are no more admitted blocks, it returns
+   `false'.
+
+   \param scp a pointer to a constant `SIDECAR' data structure.
+   \param blk a pointer to an unsigned long integer.
+   \param size a constant `size_t' type definition.
+   \param start a pointer to a `size_t' type definition.
+   \param end a pointer to a `size_t' type definition.
+   \param lines a pointer to an unsigned long integer.
+
+   \return A `BOOL' enumeration value (`false', `true').
+*/
+static BOOL
+next_region (const SIDECAR * scp, ulong * blk, const size_t size,
+             size_t * start, size_t * end, ulong * lines)
+{
+  /* skip the blocks which are ruled out. */
+  while (*blk <= scp->num_blocks && !scp->admitted[*blk])
+    ++*blk;
+
+  if (*blk > scp->num_blocks)
+    return false;
+
+  *start = (size_t) scp->blocks[*blk].start;
+  *lines = scp->blocks[*blk].lines;
+
+  /* the admitted blocks next to each other are one region. */
+  do
+    ++*blk;
+  while (*blk <= scp->num_blocks && scp->admitted[*blk]);
+
+  *end = (*blk <= scp->num_blocks ? (size_t) scp->blocks[*blk].start : size);
+
+  return true;
+}
+
+/*!
+   \fn static ulong scan_input (SCANNER *, const int, const char *)
+
+   \brief A function that scans an input for selected lines.
+
+   This function is the scan core of the interface. If `path' is not
+   NULL, then the input is a named input file and the selected lines
+   are prefixed with its path (or with a tab space if verbose option
+   is enabled). A mapped input file (see `load_input') is handed over
+   to the selecting function as one region, with no copies (unless
+   it has cached results), and then its results are cached, if the
+   user wants it. Otherwise
+   (pipes, FIFOs, small files, streams), the input (`fd') is read
+   block by block. At the end, it returns the number of selected
+   lines.
+
+   \param sp a pointer to a `SCANNER' data structure.
+   \param fd a constant integer value.
+   \param path a pointer to a constant character.
+
+   \return An unsigned long integer.
+*/
+static ulong
+scan_input (SCANNER * sp, const int fd, const char *path)
+{
+  /* externs. */
+
+  /* function externs. */
+  extern BOOL run_guarded (void (*) (void *), void *);
+  extern void free_result (CACHED_RESULT *);
+  extern void free_sidecar (SIDECAR *);
+
+  /* init the scanner for this input. */
+  sp->path = path;
+  sp->named = (path != NULL && !sp->cop->verbose) ? true : false;
+  sp->tabbed = (path != NULL && sp->cop->verbose) ? true : false;
+  sp->curr_line = sp->num_match = 0L;
+  sp->stop = false;
+
+  /* the groups of lines of an input are separated from the
+     previous ones (unless the inputs are listed, verbose). */
+  sp->after = 0L;
+  sp->gap = true;
+  sp->shown = false;
+  if (sp->cop->verbose)
+    sp->grouped = false;
+
+  if (sp->map != NULL)
+    {
+      /* the rest of a file which shrinks under the scan is
+         taken as its end (and its results are not cached). */
+      sp->num_recs = 0L;
+      if (!run_guarded (scan_mapped, sp))
+        {
+          free_result (sp->result);
+          sp->result = NULL;
+          free_sidecar (sp->sidecar);
+          sp->sidecar = NULL;
+          sp->keep = false;
+        }
+
+      /* cache the results of the file. */
+      if (sp->keep)
+        store_results (sp);
+      sp->keep = false;
+
+      /* release the mapping. */
+      munmap (sp->map, sp->map_size);
+      sp->map = NULL;
+    }
+  else
+    scan_stream (sp, fd);
+
+  /* return the number of matches. */
+  return sp->num_match;
+}
+
+/*!
+   \fn static void scan_mapped (void *)
+
+   \brief A function that scans a mapped input file.
+
+   This function processes the cached results, only the admitted
+   blocks, or the whole mapped input file of a scanner (`arg'). It is
+   run under guard (see `run_guarded').
+
+   \param arg a pointer to void.
+*/
+static void
+scan_mapped (void *arg)
+{
+  SCANNER *sp = (SCANNER *) arg;
+
+  if (sp->result != NULL)
+    scan_cached (sp);
+  else if (sp->sidecar != NULL)
+    scan_blocks (sp);
+  else
+    {
+      sp->line_pos = sp->ctx_pos = (const uchar *) sp->map;
+      sp->select (sp, (const uchar *) sp->map,
+                  (const uchar *) sp->map + sp->map_size);
+    }
+}
+
+/*!
+   \fn static void scan_blocks (SCANNER *)
+
+   \brief A function that scans the admitted blocks of a mapped input file.
+
+   This function hands over each region of the admitted blocks of the
+   mapped input file of the scanner (`sp') to the selecting function,
+   so the blocks which are ruled out are never read. The line numbers
+   go on from the new lines before each region (which the block
+   filters keep). At the end, it releases the block filters.
+
+   \param sp a pointer to a `SCANNER' data structure.
+*/
+static void
+scan_blocks (SCANNER * sp)
+{
+  /* externs. */
+
+  /* function externs. */
+  extern void free_sidecar (SIDECAR *);
+
+  const uchar *map = (const uchar *) sp->map;
+
+  /* the page size. */
+  const size_t page = (size_t) sysconf (_SC_PAGESIZE);
+
+  /* the next block, and the region of the admitted blocks. */
+  ulong blk = 0L, lines;
+  size_t start, end;
+
+  while (!sp->stop
+         && next_region (sp->sidecar, &blk, sp->map_size, &start, &end,
+                         &lines))
+    {
+      /* read ahead the region (from the start of its page). */
+      madvise ((char *) sp->map + (start - start % page),
+               end - (start - start % page), MADV_WILLNEED);
+
+      sp->curr_line = lines;
+      sp->line_pos = sp->ctx_pos = map + start;
+      sp->select (sp, map + start, map + end);
+    }
+
+  free_sidecar (sp->sidecar);
+  sp->sidecar = NULL;
+}
+
+/*!
+   \fn static void scan_cached (SCANNER *)
+
+   \brief A function that scans a mapped input file from its cached result.
+
+   This function prints the cached selected lines of the mapped input
+   file of the scanner (`sp') again (they are read from the mapping,
+   so only their pages are read), or only counts them. Its results
+   are not cached again. At the end, it releases the cached result.
+
+   \param sp a pointer to a `SCANNER' data structure.
+*/
+static void
+scan_cached (SCANNER * sp)
+{
+  /* externs. */
+
+  /* function externs. */
+  extern void free_result (CACHED_RESULT *);
+
+  const uchar *map = (const uchar *) sp->map;
+  const CACHED_RESULT *rp = sp->result;
+
+  /* is used for the loops. */
+  register ulong i;
+
+  /* the cached lines of the file (or their number). */
+  if (sp->count)
+    sp->num_match = rp->num_match;
+  else
+    for (i = 0L; i < rp->num_recs; i++)
+      {
+        write_line (sp, map + rp->recs[i].off,
+                    map + rp->recs[i].off + rp->recs[i].len,
+                    rp->recs[i].line, false);
+        if (sp->keep)
+          keep_line (sp, map + rp->recs[i].off,
+                     map + rp->recs[i].off + rp->recs[i].len,
+                     rp->recs[i].line);
+      }
+
+  /* stop the search of the input. */
+  if (sp->limit && sp->num_match >= sp->limit)
+    sp->stop = true;
+
+  sp->keep = false;
+
+  free_result (sp->result);
+  sp->result = NULL;
+}
+
+/*!
+   \fn static void store_results (SCANNER *)
+
+   \brief A function that caches the results of a mapped input file.
+
+   This function writes the cached result (see `store_result') of the
+   mapped input file of the scanner (`sp'): the number of its selected
+   lines and their kept records.
+
+   \param sp a pointer to a `SCANNER' data structure.
+*/
+static void
+store_results (SCANNER * sp)
+{
+  /* externs. */
+
+  /* function externs. */
+  extern void store_result (const RESULT_CACHE *, const INPUT_FILE *,
+                            const ulong, const RESULT_RECORD *, const ulong);
+
+  store_result (sp->cache, sp->node, sp->num_match, sp->recs,
+                (sp->count ? 0L : sp->num_recs));
+}
+
+/*!
+   \fn static void * map_input (const int, const off_t)
+
+   \brief A function that maps a regular input file in memory.
+
+   This function maps a regular input file (`fd') of `size' characters
+   in memory (for sequential reading). If it can not be mapped, it
+   returns NULL.
+
+   \param fd a constant integer value.
+   \param size a constant `off_t' type definition.
+
+   \return A pointer to void.
+*/
+static void *
+map_input (const int fd, const off_t size)
+{
+  /* the mapped contents of the file. */
+  void *map;
+
+  /* the size must be addressable. */
+  if (size <= 0 || (off_t) (size_t) size != size)
+    return NULL;
+
+  /* try to map the file. */
+  map = mmap (NULL, (size_t) size, PROT_READ, MAP_PRIVATE, fd, 0);
+  if (map == MAP_FAILED)
+    return NULL;
+
+  /* the file is read sequentially. */
+  madvise (map, (size_t) size, MADV_SEQUENTIAL);
+
+  return map;
+}
+
+/*!
+   \fn static void scan_stream (SCANNER *, const int)
+
+   \brief A function that scans an input stream block by block.
+
+   This function reads the input (`fd') in large blocks and hands
+   over the complete lines of each block to the selecting function
+   of the scanner (`sp'), which searches for the pattern across the
+   whole region and only locates the line boundaries around the
+   hits. The partial last line of a block is moved in front of the
+   next one. A line which fills the buffer grows it (up to the max
+   line bytes of the command line arguments, if any, then the rest of
+   the line is searched in parts after its kept head, see `find_part',
+   and the line is selected once, see `select_long_line'), and the
+   buffer shrinks again after it. A first block which is already
+   loaded is kept (and if it is the whole file, the input is not read
+   again).
+
+   \param sp a pointer to a `SCANNER' data structure.
+   \param fd a constant integer value.
+*/
+static void
+scan_stream (SCANNER * sp, const int fd)
+{
+  /* externs. */
+
+  /* function externs. */
+  extern void *erealloc (void *, size_t);
+
+  /* local variables. */
+
+  /* characters of the block buffer (the loaded first block). */
+  size_t len, end, carry = sp->carry;
+
+  /* characters of the context lines in front of the buffer. */
+  size_t kept = 0;
+
+  /* the max line bytes (the kept head of a too long line). */
+  const size_t head = (size_t) sp->cop->max_line_bytes;
+
+  /* the end of the kept head (after the context lines). */
+  size_t top = 0;
+
+  /* is the scan inside a too long line, and does it match? */
+  BOOL in_line = false, hit = false;
+
+  /* characters of the last read. */
+  ssize_t n;
+
+  /* the last new line of the block (or the end of a too long line). */
+  const uchar *nl;
+
+  sp->carry = 0;
+
+  /* start fetching blocks from file until EOF found. */
+  for (;;)
+    {
+      /* try to fill the rest of the block buffer
+         (unless the whole file is loaded). */
+      if (sp->whole)
+        {
+          sp->whole = false;
+          n = 0;
+        }
+      else
+        n = read (fd, sp->buf + carry, sp->size - carry);
+
+      /* restart an interrupted read. */
+      if (n < 0 && errno == EINTR)
+        continue;
+
+      /* an input/output error ends the input. */
+      if (n < 0)
+        n = 0;
+
+      len = carry + (size_t) n;
+
+      /* the rest of a too long line is searched in parts
+         after its head, until its new line (or EOF). */
+      if (in_line)
+        {
+          nl = (const uchar *) memchr (sp->buf + top, '\n', len - top);
+          if (nl == NULL && n > 0)
+            {
+              /* only the head and the overlap of the last
+                 part are kept of a full buffer. */
+              if (len == sp->size)
+                {
+                  if (!hit)
+                    hit = find_part (sp, sp->buf + top, len - top,
+                                     false, false);
+                  memmove (sp->buf + top, sp->buf + len - sp->overlap,
+                           sp->overlap);
+                  len = top + sp->overlap;
+                }
+
+              carry = len;
+              continue;
+            }
+
+          end = (nl != NULL ? (size_t) (nl - sp->buf) : len);
+          if (!hit)
+            hit = find_part (sp, sp->buf + top, end - top, false, true);
+
+          /* select the whole line once. */
+          select_long_line (sp, kept, hit);
+          in_line = false;
+
+          if (sp->stop)
+            break;
+
+          /* keep the last lines (the head of the line may be one of
+             them) for the context of the next selected line, and
+             move the lines after it after them. */
+          end = (nl != NULL ? end + 1 : len);
+          kept = (sp->context ? keep_context (sp, top + 1) : 0);
+          memmove (sp->buf, sp->buf + top + 1 - kept, kept);
+          memmove (sp->buf + kept, sp->buf + end, len - end);
+          carry = kept + len - end;
+
+          if (n == 0 && carry == kept)
+            break;
+          continue;
+        }
+
+      /* nothing is left. */
+      if (len == kept)
+        break;
+
+      if (n == 0)
+        /* the last line may lack a new line. */
+        end = len;
+      else if ((nl = (const uchar *) memrchr (sp->buf + kept, '\n',
+                                              len - kept)) != NULL)
+        /* search only the complete lines. */
+        end = (size_t) (nl - sp->buf) + 1;
+      else if (len == sp->size && head > 0
+               && len - kept >= head + sp->overlap + SCAN_BLOCK)
+        {
+          /* a line which is too long is searched in parts, and
+             only its head is kept after the context lines (the
+             line is printed cut). */
+          top = kept + head;
+          hit = find_part (sp, sp->buf + kept, len - kept, true, false);
+          in_line = true;
+          memmove (sp->buf + top, sp->buf + len - sp->overlap, sp->overlap);
+          carry = top + sp->overlap;
+          continue;
+        }
+      else
+        {
+          /* a line which fills the buffer grows it. */
+          if (len == sp->size)
+            grow_buffer (sp, kept);
+
+          /* read more of the current line. */
+          carry = len;
+          continue;
+        }
+
+      /* process the complete lines, after the context
+         lines of the previous ones. */
+      sp->ctx_pos = sp->buf;
+      sp->line_pos = sp->buf + kept;
+      sp->select (sp, sp->buf + kept, sp->buf + end);
+
+      /* the limit of the selected lines is reached. */
+      if (sp->stop)
+        break;
+
+      /* count the lines up to the end of the region. */
+      if (sp->cop->line_number && !sp->count)
+        sp->curr_line += count_lines (sp, sp->line_pos, sp->buf + end);
+
+      /* keep the last lines for the context of the next selected
+         line, and move the partial last line after them. */
+      kept = (sp->context ? keep_context (sp, end) : 0);
+      carry = kept + len - end;
+      memmove (sp->buf, sp->buf + end - kept, carry);
+
+      /* the buffer shrinks after a long line, and it grows
+         if the kept lines leave less than a read block. */
+      if (sp->size > LINE_ROOM + SCAN_BLOCK && carry <= LINE_ROOM)
+        {
+          sp->size = LINE_ROOM + SCAN_BLOCK;
+          sp->buf = (uchar *) erealloc (sp->buf, sp->size);
+        }
+      else if (sp->size - carry < SCAN_BLOCK)
+        {
+          sp->size = carry + SCAN_BLOCK;
+          sp->buf = (uchar *) erealloc (sp->buf, sp->size);
+        }
+
+      /* EOF found. */
+      if (n == 0)
+        break;
+    }
+}
+
+/*!
+   \fn static BOOL find_part (SCANNER *, const uchar *, size_t, const BOOL, const BOOL)
+
+   \brief A function that searches a part of a line which is too long.
+
+   This function searches the part `p' (of `n' characters) of a line
+   of a stream which is longer than the max line bytes of the command
+   line arguments (`first' and `last' mark the first and the last part
+   of the line). The automaton of a regular expression goes on from
+   the state at the end of the previous part. Otherwise, each part
+   starts with the last characters of the previous one (the overlap
+   of the scanner), so a pattern across two parts is found too. If
+   the part matches, it returns `true'. Otherwise, it returns `false'.
+
+   \param sp a pointer to a `SCANNER' data structure.
+   \param p a pointer to a constant unsigned character.
+   \param n a `size_t' type definition.
+   \param first a constant `BOOL' enumeration value.
+   \param last a constant `BOOL' enumeration value.
+
+   \return A `BOOL' enumeration value (`false', `true').
+*/
+static BOOL
+find_part (SCANNER * sp, const uchar * p, size_t n,
+           const BOOL first, const BOOL last)
+{
+  /* externs. */
+
+  /* function externs. */
+  extern const uchar *lazy_dfa_part (LAZY_DFA *, const uchar *, size_t,
+                                     const BOOL, const BOOL);
+
+  if (sp->dfa != NULL)
+    return (lazy_dfa_part (sp->dfa, p, n, first, last) != NULL
+            ? true : false);
+
+  if (n == 0)
+    return false;
+
+  return (sp->find (sp, p, n) != NULL ? true : false);
+}
+
+/*!
+   \fn static void select_long_line (SCANNER *, const size_t, const BOOL)
+
+   \brief A function that selects a line which is too long.
+
+   This function selects (or rejects, if the matching is inverted) a
+   line of a stream which is longer than the max line bytes of the
+   command line arguments, once: if `hit' is `true', one of its parts
+   matches. Only the head of the line (its first max line bytes) is
+   kept in the block buffer, after the `kept' characters of the context
+   lines before it, so the line is printed cut at its head (with a new
+   line). It is one line for the line numbers, the counts and the
+   context lines.
+
+   \param sp a pointer to a `SCANNER' data structure.
+   \param kept a constant `size_t' type definition.
+   \param hit a constant `BOOL' enumeration value.
+*/
+static void
+select_long_line (SCANNER * sp, const size_t kept, const BOOL hit)
+{
+  /* the head of the line (the new line is put after it). */
+  const uchar *line = sp->buf + kept;
+  const uchar *next = line + sp->cop->max_line_bytes + 1;
+
+  sp->buf[kept + sp->cop->max_line_bytes] = '\n';
+  sp->ctx_pos = sp->buf;
+  sp->line_pos = line;
+
+  if ((hit ? true : false) != (sp->cop->reverse_match ? true : false))
+    {
+      /* the line is selected. */
+      if (!sp->count)
+        print_line (sp, line, next);
+      else if (++sp->num_match == sp->limit)
+        sp->stop = true;
+    }
+  else if (sp->context)
+    /* the line is an after context line (or it
+       is kept for the before context of the next). */
+    print_context (sp, next, false);
+
+  /* the line is counted. */
+  if (sp->cop->line_number && !sp->count)
+    ++sp->curr_line;
+}
+
+/*!
+   \fn static void grow_buffer (SCANNER *, const size_t)
+
+   \brief A function that grows the block buffer of a scanner.
+
+   This function doubles the block buffer of the scanner (`sp') for
+   a line which fills it, but the buffer keeps at most one read block
+   after the `kept' characters of the context lines, the max line
+   bytes of the command line arguments (if any) and the overlap of
+   the parts of the line.
+
+   \param sp a pointer to a `SCANNER' data structure.
+   \param kept a constant `size_t' type definition.
+*/
+static void
+grow_buffer (SCANNER * sp, const size_t kept)
+{
+  /* externs. */
+
+  /* function externs. */
+  extern void *erealloc (void *, size_t);
+
+  /* the new size of the buffer. */
+  size_t size = 2 * sp->size;
+
+  /* the most which a too long line needs. */
+  const size_t most = (kept + (size_t) sp->cop->max_line_bytes
+                       + sp->overlap + SCAN_BLOCK);
+
+  if (sp->cop->max_line_bytes && size > most)
+    size = most;
+
+  sp->buf = (uchar *) erealloc (sp->buf, size);
+  sp->size = size;
+}
+
+/*!
+   \fn static size_t keep_context (SCANNER *, const size_t)
+
+   \brief A function that finds the context lines to keep for a block.
+
+   This function returns the characters of the last lines of the
+   searched region of the block buffer (up to `end') which are kept
+   in front of the buffer, for the before context of the next
+   selected line: the before context lines which are not printed
+   yet (the buffer grows for long ones, as for a long line). If
+   lines are dropped, the next group of lines is separated.
+
+   \param sp a pointer to a `SCANNER' data structure.
+   \param end a constant `size_t' type definition.
+
+   \return A `size_t' type definition.
+*/
+static size_t
+keep_context (SCANNER * sp, const size_t end)
+{
+  /* the start of the kept lines and the new line before it. */
+  const uchar *q = sp->buf + end, *nl;
+
+  /* is used for the loops. */
+  register ulong i;
+
+  for (i = 0L; i < sp->cop->before_context && q > sp->ctx_pos; i++)
+    {
+      nl = (const uchar *) memrchr (sp->ctx_pos, '\n',
+                                    (size_t) (q - 1 - sp->ctx_pos));
+      q = (nl != NULL ? nl + 1 : sp->ctx_pos);
+    }
+
+  if (q > sp->ctx_pos)
+    sp->gap = true;
+
+  return (size_t) (sp->buf + end - q);
+}
+
+/*!
+   \fn static void select_lines (SCANNER *, const uchar *, const uchar *)
+
+   \brief A function that prints the lines that match with the pattern.
+
+   This function searches for the pattern across the whole region
+   (from `p' up to `end') and prints only the lines of the hits.
+
+   \param sp a pointer to a `SCANNER' data structure.
+   \param p a pointer to a constant unsigned character.
+   \param end a pointer to a constant unsigned character.
+*/
+static void
+select_lines (SCANNER * sp, const uchar * p, const uchar * end)
+{
+  /* the hit and its line boundaries. */
+  const uchar *hit, *line, *next;
+
+  while (p < end && !sp->stop
+         && (hit = sp->find (sp, p, (size_t) (end - p))) != NULL)
+    {
+      /* find the start of the line. */
+      line = (const uchar *) memrchr (p, '\n', (size_t) (hit - p));
+      line = (line != NULL ? line + 1 : p);
+
+      /* find the start of the next line. */
+      next = (const uchar *) memchr (hit, '\n', (size_t) (end - hit));
+      next = (next != NULL ? next + 1 : end);
+
+      /* print the line and skip the rest of it. */
+      print_line (sp, line, next);
+      p = next;
+    }
+
+  /* the lines after the last selected line. */
+  if (sp->context)
+    print_context (sp, end, false);
+}
+
+/*!
+   \fn static void reject_lines (SCANNER *, const uchar *, const uchar *)
+
+   \brief A function that prints the lines that do not match with the pattern.
+
+   This function searches for the pattern across the whole region
+   (from `p' up to `end') and prints all the lines between the hits.
+
+   \param sp a pointer to a `SCANNER' data structure.
+   \param p a pointer to a constant unsigned character.
+   \param end a pointer to a constant unsigned character.
+*/
+static void
+reject_lines (SCANNER * sp, const uchar * p, const uchar * end)
+{
+  /* the hit and the line boundaries. */
+  const uchar *hit, *stop, *next;
+
+  while (p < end)
+    {
+      hit = sp->find (sp, p, (size_t) (end - p));
+
+      /* the lines up to the line of the hit are selected. */
+      if (hit != NULL)
+        {
+          stop = (const uchar *) memrchr (p, '\n', (size_t) (hit - p));
+          stop = (stop != NULL ? stop + 1 : p);
+        }
+      else
+        stop = end;
+
+      /* print the lines between the hits. */
+      while (p < stop && !sp->stop)
+        {
+          next = (const uchar *) memchr (p, '\n', (size_t) (stop - p));
+          next = (next != NULL ? next + 1 : stop);
+
+          print_line (sp, p, next);
+          p = next;
+        }
+
+      /* there are no more hits (or lines to select). */
+      if (hit == NULL || sp->stop)
+        break;
+
+      /* skip the line of the hit. */
+      next = (const uchar *) memchr (hit, '\n', (size_t) (end - hit));
+      p = (next != NULL ? next + 1 : end);
+    }
+
+  /* the lines after the last selected line. */
+  if (sp->context)
+    print_context (sp, end, false);
+}
+
+/*!
+   \fn static void count_selected (SCANNER *, const uchar *, const uchar *)
+
+   \brief A function that counts the lines that match with the pattern.
+
+   This function searches for the pattern across the whole region
+   (from `p' up to `end') and counts the lines of the hits. It jumps
+   from a hit to the end of its line, so no line is ever copied.
+
+   \param sp a pointer to a `SCANNER' data structure.
+   \param p a pointer to a constant unsigned character.
+   \param end a pointer to a constant unsigned character.
+*/
+static void
+count_selected (SCANNER * sp, const uchar * p, const uchar * end)
+{
+  /* the hit and the start of the next line. */
+  const uchar *hit, *next;
+
+  while (p < end && !sp->stop
+         && (hit = sp->find (sp, p, (size_t) (end - p))) != NULL)
+    {
+      /* stop the search of the input. */
+      if (++sp->num_match == sp->limit)
+        sp->stop = true;
+
+      /* skip the rest of the line. */
+      next = (const uchar *) memchr (hit, '\n', (size_t) (end - hit));
+      p = (next != NULL ? next + 1 : end);
+    }
+}
+
+/*!
+   \fn static void count_rejected (SCANNER *, const uchar *, const uchar *)
+
+   \brief A function that counts the lines that do not match with the pattern.
+
+   This function counts the lines of the whole region (from `p' up to
+   `end') from its new lines, and subtracts the lines of the hits.
+
+   \param sp a pointer to a `SCANNER' data structure.
+   \param p a pointer to a constant unsigned character.
+   \param end a pointer to a constant unsigned character.
+*/
+static void
+count_rejected (SCANNER * sp, const uchar * p, const uchar * end)
+{
+  /* the hit and the start of the next line. */
+  const uchar *hit, *next;
+
+  /* the lines of the region (the last one may lack a new line). */
+  ulong num_lines = count_lines (sp, p, end);
+
+  if (p < end && end[-1] != '\n')
+    ++num_lines;
+
+  while (p < end && (hit = sp->find (sp, p, (size_t) (end - p))) != NULL)
+    {
+      --num_lines;
+
+      /* skip the rest of the line. */
+      next = (const uchar *) memchr (hit, '\n', (size_t) (end - hit));
+      p = (next != NULL ? next + 1 : end);
+    }
+
+  sp->num_match += num_lines;
+
+  /* stop the search of the input. */
+  if (sp->limit && sp->num_match >= sp->limit)
+    {
+      sp->num_match = sp->limit;
+      sp->stop = true;
+    }
+}
+
+/*!
+   \fn static void print_line (SCANNER *, const uchar *, const uchar *)
+
+   \brief A function that prints a selected line.
+
+   This function prints the selected line (from `line' up to `next')
+   with its prefixes, or records it if the scanner searches a chunk.
+   The lines are counted only when the user wants to print the line
+   number. If the user wants the lines around the selected ones, the
+   context lines before the line are printed first.
+
+   \param sp a pointer to a `SCANNER' data structure.
+   \param line a pointer to a constant unsigned character.
+   \param next a pointer to a constant unsigned character.
+*/
+static void
+print_line (SCANNER * sp, const uchar * line, const uchar * next)
+{
+  /* externs. */
+
+  /* function externs. */
+  extern void *erealloc (void *, size_t);
+
+  /* the chunk job. */
+  JOB *jp = sp->job;
+
+  /* the lines since the previous selected line. */
+  if (sp->context)
+    print_context (sp, line, true);
+
+  /* user wants to print the line number. */
+  if (sp->cop->line_number)
+    {
+      /* count the lines skipped so far. */
+      sp->curr_line += count_lines (sp, sp->line_pos, line);
+      sp->line_pos = line;
+    }
+
+  /* print the line now (and keep it for the result cache). */
+  if (jp == NULL)
+    {
+      write_line (sp, line, next, sp->curr_line + 1, false);
+      if (sp->keep)
+        keep_line (sp, line, next, sp->curr_line + 1);
+    }
+  else
+    {
+      /* grow the records array. */
+      if (sp->num_match == jp->max_recs)
+        {
+          jp->max_recs = (jp->max_recs ? 2 * jp->max_recs : 64L);
+          jp->recs = (MATCH *) erealloc (jp->recs,
+                                         jp->max_recs * sizeof (MATCH));
+        }
+
+      /* record the line for the emitter. */
+      jp->recs[sp->num_match].off = (size_t) (line - jp->begin);
+      jp->recs[sp->num_match].len = (size_t) (next - line);
+      jp->recs[sp->num_match].line = sp->curr_line;
+
+      ++sp->num_match;
+    }
+
+  /* the lines after the line are its context. */
+  if (sp->context)
+    {
+      sp->ctx_pos = next;
+      sp->after = sp->cop->after_context;
+      sp->grouped = true;
+    }
+
+  /* stop the search of the input. */
+  if (sp->num_match == sp->limit)
+    sp->stop = true;
+}
+
+/*!
+   \fn static void keep_line (SCANNER *, const uchar *, const uchar *, const ulong)
+
+   \brief A function that keeps a selected line for the result cache.
+
+   This function appends the record of the selected line (from `line'
+   up to `next', whose line number is `line_num') of the mapped input
+   file of the scanner (`sp') to its kept selected lines. If there are
+   too many of them, the results of the file are not cached.
+
+   \param sp a pointer to a `SCANNER' data structure.
+   \param line a pointer to a constant unsigned character.
+   \param next a pointer to a constant unsigned character.
+   \param line_num a constant unsigned long integer.
+*/
+static void
+keep_line (SCANNER * sp, const uchar * line, const uchar * next,
+           const ulong line_num)
+{
+  /* externs. */
+
+  /* function externs. */
+  extern void *erealloc (void *, size_t);
+
+  if (sp->num_recs == MAX_RECORDS)
+    {
+      sp->keep = false;
+      return;
+    }
+
+  /* grow the records array. */
+  if (sp->num_recs == sp->max_recs)
+    {
+      sp->max_recs = (sp->max_recs ? 2 * sp->max_recs : 64L);
+      sp->recs = (RESULT_RECORD *) erealloc (sp->recs, sp->max_recs
+                                             * sizeof (RESULT_RECORD));
+    }
+
+  sp->recs[sp->num_recs].off = (ulong) (line - (const uchar *) sp->map);
+  sp->recs[sp->num_recs].len = (ulong) (next - line);
+  sp->recs[sp->num_recs].line = line_num;
+
+  ++sp->num_recs;
+}
+
+/*!
+   \fn static void print_context (SCANNER *, const uchar *, const BOOL)
+
+   \brief A function that prints the context lines up to a line.
+
+   This function prints the context lines between the last printed
+   line and `line' (the next selected line, or the end of the region):
+   the rest of the after context of the previous selected line, and
+   then if `before' is `true', the before context of `line'. These are
+   found back from `line' with `memrchr', so the lines between the
+   hits are never looked at one by one. The overlapping contexts are
+   merged, and a group of lines is separated from the previous one if
+   lines are skipped between them.
+
+   \param sp a pointer to a `SCANNER' data structure.
+   \param line a pointer to a constant unsigned character.
+   \param before a constant `BOOL' enumeration value.
+*/
+static void
+print_context (SCANNER * sp, const uchar * line, const BOOL before)
+{
+  /* the first line which is not printed and the next one. */
+  const uchar *p = sp->ctx_pos, *next;
+
+  /* the start of the before context. */
+  const uchar *q = line;
+
+  /* is used for the loops. */
+  register ulong i;
+
+  /* the rest of the after context. */
+  for (; sp->after > 0 && p < line; p = next, --sp->after)
+    {
+      next = (const uchar *) memchr (p, '\n', (size_t) (line - p));
+      next = (next != NULL ? next + 1 : line);
+      write_context (sp, p, next);
+    }
+
+  sp->ctx_pos = p;
+  if (!before)
+    return;
+
+  /* the before context (back from the line). */
+  for (i = 0L; i < sp->cop->before_context && q > p; i++)
+    {
+      next = (const uchar *) memrchr (p, '\n', (size_t) (q - 1 - p));
+      q = (next != NULL ? next + 1 : p);
+    }
+
+  /* separate the group from the previous one. */
+  if (q > p)
+    sp->gap = true;
+  if (sp->gap && sp->grouped)
+    write_separator (sp);
+  sp->gap = false;
+
+  for (; q < line; q = next)
+    {
+      next = (const uchar *) memchr (q, '\n', (size_t) (line - q));
+      next = (next != NULL ? next + 1 : line);
+      write_context (sp, q, next);
+    }
+
+  sp->ctx_pos = line;
+}
+
+/*!
+   \fn static void write_context (SCANNER *, const uchar *, const uchar *)
+
+   \brief A function that writes a context line.
+
+   \param sp a pointer to a `SCANNER' data structure.
+   \param line a pointer to a constant unsigned character.
+   \param next a pointer to a constant unsigned character.
+*/
+static void
+write_context (SCANNER * sp, const uchar * line, const uchar * next)
+{
+  write_line (sp, line, next,
+              (sp->cop->line_number ? line_number (sp, line) : 0L), true);
+}
+
+/*!
+   \fn static void write_separator (SCANNER *)
+
+   \brief A function that writes the separator of two groups of lines.
+
+   \param sp a pointer to a `SCANNER' data structure.
+*/
+static void
+write_separator (SCANNER * sp)
+{
+  /* externs. */
+
+  /* function externs. */
+  extern void output_write (OUTPUT_BUFFER *, const void *, size_t);
+  extern void output_string (OUTPUT_BUFFER *, const char *);
+  extern void output_commit (OUTPUT_BUFFER *);
+
+  /* if verbose option is enabled. */
+  if (sp->tabbed)
+    output_write (sp->out, TAB_SPACE, 1);
+
+  output_string (sp->out, "--" NEW_LINE);
+  output_commit (sp->out);
+}
+
+/*!
+   \fn static ulong line_number (SCANNER *, const uchar *)
+
+   \brief A function that returns the number of a line of the block.
+
+   This function returns the number of the line which starts at
+   `line'. The lines are counted from the position up to which they
+   are already counted, forward (and it moves on), or back if the line
+   is a kept context line.
+
+   \param sp a pointer to a `SCANNER' data structure.
+   \param line a pointer to a constant unsigned character.
+
+   \return An unsigned long integer.
+*/
+static ulong
+line_number (SCANNER * sp, const uchar * line)
+{
+  if (line < sp->line_pos)
+    return sp->curr_line + 1 - count_lines (sp, line, sp->line_pos);
+
+  sp->curr_line += count_lines (sp, sp->line_pos, line);
+  sp->line_pos = line;
+
+  return sp->curr_line + 1;
+}
+
+/*!
+   \fn static void write_line (SCANNER *, const uchar *, const uchar *, const ulong, const BOOL)
+
+   \brief A function that writes a selected line.
+
+   This function writes the selected line (from `line' up to `next')
+   with its prefixes (`line_num' is its line number) to the output
+   stream of the scanner (`sp'). If `context' is `true', the line is
+   a context line (its prefixes end with `-' instead of `:').
+
+   \param sp a pointer to a `SCANNER' data structure.
+   \param line a pointer to a constant unsigned character.
+   \param next a pointer to a constant unsigned character.
+   \param line_num a constant unsigned long integer.
+   \param context a constant `BOOL' enumeration value.
+*/
+static void
+write_line (SCANNER * sp, const uchar * line, const uchar * next,
+            const ulong line_num, const BOOL context)
+{
+  /* externs. */
+
+  /* function externs. */
+  extern void output_write (OUTPUT_BUFFER *, const void *, size_t);
+  extern void output_string (OUTPUT_BUFFER *, const char *);
+  extern void output_number (OUTPUT_BUFFER *, ulong);
+  extern void output_commit (OUTPUT_BUFFER *);
+
+  /* variable externs. */
+  extern cstring show_standard_input;
+
+  /* the end of the prefixes. */
+  const char *sep = (context ? "-" : ":");
+
+  /* only the exit status is asked for. */
+  if (sp->cop->quiet)
+    {
+      ++sp->num_match;
+      return;
+    }
+
+  /* print only the path of the input (once). */
+  if (sp->cop->list_files)
+    {
+      if (!sp->num_match++)
+        {
+          output_string (sp->out, (sp->path != NULL ? sp->path
+                                   : _(show_standard_input)));
+          output_write (sp->out, NEW_LINE, 1);
+          output_commit (sp->out);
+        }
+      return;
+    }
+
+  /* if verbose option is enabled. */
+  if (sp->tabbed)
+    {
+      /* print only when we are in the first line. */
+      if (!sp->shown)
+        output_write (sp->out, NEW_LINE, 1);
+
+      /* print tab space. */
+      output_write (sp->out, TAB_SPACE, 1);
+    }
+
+  /* print the filepath. */
+  if (sp->named)
+    {
+      output_string (sp->out, sp->path);
+      output_write (sp->out, sep, 1);
+    }
+
+  /* user wants to print the line number. */
+  if (sp->cop->line_number)
+    {
+      output_number (sp->out, line_num);
+      output_write (sp->out, sep, 1);
+    }
+
+  /* print the data line. */
+  output_write (sp->out, line, (size_t) (next - line));
+  output_commit (sp->out);
+  sp->shown = true;
+
+  /* increase the cnt of max
+     matches within the file. */
+  if (!context)
+    ++sp->num_match;
+}
+
+/*!
+   \fn static void print_file_path (OPTIONS *, OUTPUT_BUFFER *, const char *, const ulong)
+
+   \brief A function that prints the path of an input file (verbose).
+
+   This function prints the `path' of an input file to the `out'
+   buffer, only if verbose option is enabled. The input file is
+   separated from the previous one only if that one matched (if
+   `prev_match' is not 0).
+
+   \param cop a pointer to a `OPTIONS' data structure.
+   \param out a pointer to a `OUTPUT_BUFFER' data structure.
+   \param path a pointer to a constant character.
+   \param prev_match a constant unsigned long integer.
+*/
+static void
+print_file_path (OPTIONS * cop, OUTPUT_BUFFER * out, const char *path,
+                 const ulong prev_match)
+{
+  /* externs. */
+
+  /* function externs. */
+  extern void output_write (OUTPUT_BUFFER *, const void *, size_t);
+  extern void output_string (OUTPUT_BUFFER *, const char *);
+  extern void output_commit (OUTPUT_BUFFER *);
+
+  if (!cop->verbose)
+    return;
+
+  /* separate this file from the previous one. */
+  if (prev_match)
+    output_write (out, NEW_LINE, 1);
+
+  output_string (out, " * [");
+  output_string (out, path);
+  output_string (out, "]" NEW_LINE);
+  output_commit (out);
+}
+
+/*!
+   \fn static void print_num_matches (OPTIONS *, OUTPUT_BUFFER *, const char *, ulong)
+
+   \brief A function that prints the number of matches of an input.
+
+   This function prints the number of matches (`num_match') of an
+   input, only if at least one match found and user wants to print
+   the number of matches, to the `out' buffer. If `path' is not NULL,
+   then the input is a named input file and the verbose layout is
+   respected.
+
+   \param cop a pointer to a `OPTIONS' data structure.
+   \param out a pointer to a `OUTPUT_BUFFER' data structure.
+   \param path a pointer to a constant character.
+   \param num_match an unsigned long integer.
+*/
+static void
+print_num_matches (OPTIONS * cop, OUTPUT_BUFFER * out, const char *path,
+                   ulong num_match)
+{
+  /* externs. */
+
+  /* function externs. */
+  extern void output_write (OUTPUT_BUFFER *, const void *, size_t);
+  extern void output_string (OUTPUT_BUFFER *, const char *);
+  extern void output_number (OUTPUT_BUFFER *, ulong);
+  extern void output_commit (OUTPUT_BUFFER *);
+
+  /* variable externs. */
+  extern cstring show_max_matches;
+
+  /* print only if at least one match found and
+     user wants to print the number of matches
+     (but not only the paths or the exit status). */
+  if (!cop->max_matches || !num_match || cop->quiet || cop->list_files
+      || cop->count_only)
+    return;
+
+  /* if verbose option is enabled. */
+  if (path != NULL && cop->verbose)
+    output_string (out, NEW_LINE "   ");
+
+  output_string (out, _(show_max_matches));
+  output_write (out, " ", 1);
+  output_number (out, num_match);
+  output_string (out, "." NEW_LINE);
+  output_commit (out);
+}
+
+/*!
+   \fn static void print_num_lines (OPTIONS *, OUTPUT_BUFFER *, const char *, ulong)
+
+   \brief A function that prints the number of selected lines of an input.
+
+   This function prints the number of selected lines (`num_lines') of
+   an input to the `out' buffer, only if user wants only the number
+   of the lines. If `path' is not NULL, then the input is a named
+   input file and the number is prefixed with its path (or the verbose
+   layout is respected).
+
+   \param cop a pointer to a `OPTIONS' data structure.
+   \param out a pointer to a `OUTPUT_BUFFER' data structure.
+   \param path a pointer to a constant character.
+   \param num_lines an unsigned long integer.
+*/
+static void
+print_num_lines (OPTIONS * cop, OUTPUT_BUFFER * out, const char *path,
+                 ulong num_lines)
+{
+  /* externs. */
+
+  /* function externs. */
+  extern void output_write (OUTPUT_BUFFER *, const void *, size_t);
+  extern void output_string (OUTPUT_BUFFER *, const char *);
+  extern void output_number (OUTPUT_BUFFER *, ulong);
+  extern void output_commit (OUTPUT_BUFFER *);
+
+  /* variable externs. */
+  extern cstring show_num_lines;
+
+  /* print only if user wants the number of the lines
+     (but not only the paths or the exit status). */
+  if (!cop->count_only || cop->quiet || cop->list_files)
+    return;
+
+  /* if verbose option is enabled. */
+  if (path != NULL && cop->verbose)
+    {
+      output_string (out, NEW_LINE "   ");
+      output_string (out, _(show_num_lines));
+      output_write (out, " ", 1);
+      output_number (out, num_lines);
+      output_string (out, "." NEW_LINE);
+      output_commit (out);
+      return;
+    }
+
+  /* print the filepath. */
+  if (path != NULL)
+    {
+      output_string (out, path);
+      output_write (out, ":", 1);
+    }
+
+  output_number (out, num_lines);
+  output_string (out, NEW_LINE);
+  output_commit (out);
+}
+
+/*!
+   \fn static void print_total_lines (OPTIONS *, OUTPUT_BUFFER *, ulong)
+
+   \brief A function that prints the total number of selected lines.
+
+   This function prints the number of selected lines of all the input
+   files (`total') to the `out' buffer, only if user wants only the
+   number of the lines.
+
+   \param cop a pointer to a `OPTIONS' data structure.
+   \param out a pointer to a `OUTPUT_BUFFER' data structure.
+   \param total an unsigned long integer.
+*/
+static void
+print_total_lines (OPTIONS * cop, OUTPUT_BUFFER * out, ulong total)
+{
+  /* externs. */
+
+  /* function externs. */
+  extern void output_write (OUTPUT_BUFFER *, const void *, size_t);
+  extern void output_string (OUTPUT_BUFFER *, const char *);
+  extern void output_number (OUTPUT_BUFFER *, ulong);
+  extern void output_commit (OUTPUT_BUFFER *);
+
+  /* variable externs. */
+  extern cstring show_total_lines;
+
+  if (!cop->count_only || cop->quiet || cop->list_files)
+    return;
+
+  /* if verbose option is enabled. */
+  if (cop->verbose)
+    output_string (out, NEW_LINE);
+
+  output_string (out, _(show_total_lines));
+  output_write (out, " ", 1);
+  output_number (out, total);
+  output_string (out, NEW_LINE);
+  output_commit (out);
+}
+
+/*!
+   \fn static const uchar * find_pattern (SCANNER *, const uchar *, size_t)
+
+   \brief A function that finds the pattern in a region of the block.
+
+   \param sp a pointer to a `SCANNER' data structure.
+   \param p a pointer to a constant unsigned character.
+   \param n a `size_t' type definition.
+
+   \return A pointer to a constant unsigned character.
+*/
+static const uchar *
+find_pattern (SCANNER * sp, const uchar * p, size_t n)
+{
+  return sp->kernel (p, n, (const uchar *) sp->pattern, sp->pattern_len);
+}
+
+/*!
+   \fn static const uchar * find_patterns (SCANNER *, const uchar *, size_t)
+
+   \brief A function that finds any of many patterns in a region of the block.
+
+   \param sp a pointer to a `SCANNER' data structure.
+   \param p a pointer to a constant unsigned character.
+   \param n a `size_t' type definition.
+
+   \return A pointer to a constant unsigned character.
+*/
+static const uchar *
+find_patterns (SCANNER * sp, const uchar * p, size_t n)
+{
+  /* externs. */
+
+  /* function externs. */
+  extern const uchar *aho_corasick_find (const AHO_CORASICK *,
+                                         const uchar *, size_t);
+
+  return aho_corasick_find (sp->acp, p, n);
+}
+
+/*!
+   \fn static const uchar * find_nothing (SCANNER *, const uchar *, size_t)
+
+   \brief A function that finds no match in a region of the block.
+
+   \param sp a pointer to a `SCANNER' data structure.
+   \param p a pointer to a constant unsigned character.
+   \param n a `size_t' type definition.
+
+   \return A pointer to a constant unsigned character.
+*/
+static const uchar *
+find_nothing (SCANNER * sp, const uchar * p, size_t n)
+{
+  (void) sp;
+  (void) p;
+  (void) n;
+
+  return NULL;
+}
+
+/*!
+   \fn static const uchar * find_regex (SCANNER *, const uchar *, size_t)
+
+   \brief A function that finds a line which matches the regular expression.
+
+   This function searches a region of the block for the literals
+   which the regular expression requires. The lazy automaton runs
+   only on the line of each hit, until a line matches. If there are
+   no literals, the automaton runs on the whole region.
+
+   \param sp a pointer to a `SCANNER' data structure.
+   \param p a pointer to a constant unsigned character.
+   \param n a `size_t' type definition.
+
+   \return A pointer to a constant unsigned character.
+*/
+static const uchar *
+find_regex (SCANNER * sp, const uchar * p, size_t n)
+{
+  /* externs. */
+
+  /* function externs. */
+  extern const uchar *aho_corasick_find (const AHO_CORASICK *,
+                                         const uchar *, size_t);
+  extern const uchar *lazy_dfa_find (LAZY_DFA *, const uchar *, size_t);
+
+  /* the end of the region. */
+  const uchar *const end = p + n;
+
+  /* the hit and its line boundaries. */
+  const uchar *hit, *line, *next;
+
+  if (sp->rxp->num_literals == 0)
+    return lazy_dfa_find (sp->dfa, p, n);
+
+  while (p < end)
+    {
+      if (sp->acp != NULL)
+        hit = aho_corasick_find (sp->acp, p, (size_t) (end - p));
+      else
+        hit = sp->kernel (p, (size_t) (end - p),
+                          (const uchar *) sp->pattern, sp->pattern_len);
+
+      if (hit == NULL)
+        break;
+
+      /* the line of the hit. */
+      line = (const uchar *) memrchr (p, '\n', (size_t) (hit - p));
+      line = (line != NULL ? line + 1 : p);
+
+      next = (const uchar *) memchr (hit, '\n', (size_t) (end - hit));
+      next = (next != NULL ? next : end);
+
+      if (lazy_dfa_find (sp->dfa, line, (size_t) (next - line)) != NULL)
+        return line;
+
+      /* skip the rest of the line. */
+      if (next == end)
+        break;
+
+      p = next + 1;
+    }
+
+  return NULL;
+}
+
+/*!
+   \fn static ulong count_lines (SCANNER *, const uchar *, const uchar *)
+
+   \brief A function that counts the new lines of a region.
+
+   This function counts the new lines of a region (from `p' up to
+   `end') with the counting kernel of the scanner (`sp'), which is
+   vectorized, so the lines skipped between the hits cost little.
+
+   \param sp a pointer to a `SCANNER' data structure.
+   \param p a pointer to a constant unsigned character.
+   \param end a pointer to a constant unsigned character.
+
+   \return An unsigned long integer.
+*/
+static ulong
+count_lines (SCANNER * sp, const uchar * p, const uchar * end)
+{
+  return (p < end ? sp->counter (p, (size_t) (end - p), '\n') : 0L);
+}
+
+/*!
+   \fn static char * memlwr (char *, size_t)
 
    \brief A function that gets a string and returns it in lowercase.
 
-   This function tries to lowercase each character of `s'
-   string. So, creates a new string with the new version
-   of lowercase characters. After that, it returns it.
+   This function tries to lowercase each of the `n' characters
+   of `str' string (in place). After that, it returns it.
 
    \param str a pointer to a character.
+   \param n a `size_t' type definition.
 
    \return a pointer to a character.
 */
 static char *
-strlwr (char *str)
+memlwr (char *str, size_t n)
 {
   /* if the string is not empty. */
   if (str != NULL)
@@ -508,8 +4001,8 @@ strlwr (char *str)
       char *p;
 
       /* try to lowercase all chars. */
-      for (p = str; *p != '\0'; p++)
-        *p = (char) tolower (*p);
+      for (p = str; p < str + n; p++)
+        *p = (char) tolower ((uchar) *p);
     }
 
   /* return the string. */
@@ -0,0 +1,2225 @@
+/*
+ *  `gfs-regex.c'.
+ *
+ *  This interface deals with the regular expression automata.
+ *
+ *  Copyright (C) 2008  Efstathios Chatzikyriakidis (stathis.chatzikyriakidis@gmail.com).
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*!
+   \file gfs-regex.c
+   \brief This interface deals with the regular expression automata.
+*/
+
+/* standard includes. */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <limits.h>
+#include <libintl.h>
+
+/* basic includes. */
+#include "gfs-i18n-macros.h"
+#include "gfs-typedefs.h"
+#include "gfs-regex.h"
+
+/* enumeration constants. */
+
+/*!
+   \brief Constants used from the interface.
+
+   This anonymous enumeration is used from the
+   interface in order to specify some constants.
+*/
+enum
+{
+  RX_CHAR = 0,                  /*!< A state which matches a character set. */
+  RX_SPLIT = 1,                 /*!< A state which goes to two states. */
+  RX_BOL = 2,                   /*!< A state which matches a line start. */
+  RX_EOL = 3,                   /*!< A state which matches a line end. */
+  RX_MATCH = 4,                 /*!< The accepting state. */
+  NODE_EMPTY = 0,               /*!< A node which matches the empty string. */
+  NODE_SET = 1,                 /*!< A node which matches a character set. */
+  NODE_BOL = 2,                 /*!< A node which matches a line start. */
+  NODE_EOL = 3,                 /*!< A node which matches a line end. */
+  NODE_CAT = 4,                 /*!< A node of a concatenation. */
+  NODE_ALT = 5,                 /*!< A node of an alternation. */
+  NODE_REPEAT = 6,              /*!< A node of a repetition. */
+  RX_SET_BYTES = 32,            /*!< The size of a character set bitmap. */
+  RX_MAX_REPEAT = 255,          /*!< The max count of a repetition. */
+  RX_MAX_DEPTH = 256,           /*!< The max depth of the groups. */
+  RX_MAX_STATES = 1048576,      /*!< The max number of states. */
+  DFA_START = 0,                /*!< The start state of the lazy automaton. */
+  DFA_ACCEPT = 1,               /*!< A state which has matched. */
+  DFA_EOL_ACCEPT = 2,           /*!< A state which matches at a line end. */
+  DFA_EMPTY_ACCEPT = 4,         /*!< A state which matches an empty line. */
+  DFA_MAX_STATES = 32768,       /*!< The max number of cached states. */
+  DFA_SET_ROOM = 262144,        /*!< The initial room of the cached sets. */
+  DFA_MAX_SET_ROOM = 16777216,  /*!< The max room of the cached sets. */
+  DFA_MIN_YIELD = 2             /*!< The min bytes per state between flushes. */
+};
+
+/*!
+   \def RX_NONE
+   \brief No state or node.
+
+   This define marks a missing state or node.
+*/
+#define RX_NONE UINT_MAX
+
+/*!
+   \def DFA_STOP
+   \brief Stopping transition bit.
+
+   This define marks the transitions into accepting states
+   (and the ones which are not computed yet).
+*/
+#define DFA_STOP 0x80000000U
+
+/*!
+   \def DFA_UNKNOWN
+   \brief Unknown transition.
+
+   This define marks the transitions which are not computed yet.
+*/
+#define DFA_UNKNOWN UINT_MAX
+
+/*!
+   \def RX_INFINITE
+   \brief Unbounded repetition.
+
+   This define is the max count of an unbounded repetition.
+*/
+#define RX_INFINITE UINT_MAX
+
+/*
+ * structure data types.
+ */
+
+/*!
+   \struct rx_nodeT
+   \brief Regular expression node data structure.
+
+   This data structure keeps a node of the parsed regular
+   expression. The children of a node are linked through
+   their siblings (in reverse order for a concatenation).
+*/
+struct rx_nodeT
+{
+  /*!
+     \var type
+     \brief The type of the node.
+   */
+  uchar type;
+
+  /*!
+     \var ch
+     \brief The literal character of a set (or -1).
+   */
+  int ch;
+
+  /*!
+     \var set
+     \brief The character set of a set node.
+   */
+  uint set;
+
+  /*!
+     \var min
+     \brief The min count of a repetition.
+   */
+  uint min;
+
+  /*!
+     \var max
+     \brief The max count of a repetition.
+   */
+  uint max;
+
+  /*!
+     \var child
+     \brief The first child of the node.
+   */
+  uint child;
+
+  /*!
+     \var sib
+     \brief The next sibling of the node.
+   */
+  uint sib;
+};
+
+/*!
+   \struct rx_parserT
+   \brief Regular expression parser data structure.
+
+   This data structure keeps the state of the parsing
+   and the compilation of the regular expressions.
+*/
+struct rx_parserT
+{
+  /*!
+     \var rxp
+     \brief The regular expression which is compiled.
+   */
+  REGEX *rxp;
+
+  /*!
+     \var nodes
+     \brief The nodes of the parsed regular expressions.
+   */
+  struct rx_nodeT *nodes;
+
+  /*!
+     \var num_nodes
+     \brief The number of nodes.
+   */
+  uint num_nodes;
+
+  /*!
+     \var room
+     \brief The room of the nodes.
+   */
+  uint room;
+
+  /*!
+     \var states_room
+     \brief The room of the states.
+   */
+  uint states_room;
+
+  /*!
+     \var sets_room
+     \brief The room of the character sets.
+   */
+  uint sets_room;
+
+  /*!
+     \var char_sets
+     \brief The character set of each literal character (or RX_NONE).
+   */
+  uint char_sets[UCHAR_MAX + 1];
+
+  /*!
+     \var pattern
+     \brief The regular expression which is parsed.
+   */
+  const char *pattern;
+
+  /*!
+     \var p
+     \brief The current character of the pattern.
+   */
+  const uchar *p;
+
+  /*!
+     \var end
+     \brief The end of the pattern.
+   */
+  const uchar *end;
+
+  /*!
+     \var fold
+     \brief Are case distinctions ignored?
+   */
+  BOOL fold;
+
+  /*!
+     \var depth
+     \brief The depth of the current group.
+   */
+  uint depth;
+
+  /*!
+     \var run
+     \brief The current literal run (in reverse).
+   */
+  char *run;
+
+  /*!
+     \var run_len
+     \brief The length of the current literal run.
+   */
+  size_t run_len;
+
+  /*!
+     \var best
+     \brief The longest literal run (in reverse).
+   */
+  char *best;
+
+  /*!
+     \var best_len
+     \brief The length of the longest literal run.
+   */
+  size_t best_len;
+
+  /*!
+     \var no_literal
+     \brief Has an alternative no required literal?
+   */
+  BOOL no_literal;
+};
+
+/*
+ * type definitions.
+ */
+
+/*!
+   \typedef RX_NODE
+   \brief Regular expression node data structure type definition.
+*/
+typedef struct rx_nodeT RX_NODE;
+
+/*!
+   \typedef RX_PARSER
+   \brief Regular expression parser data structure type definition.
+*/
+typedef struct rx_parserT RX_PARSER;
+
+/* function prototypes. */
+REGEX *new_regex (char *const *patterns, const size_t * lens,
+                  const ulong num, const BOOL fold);
+void free_regex (REGEX * rxp);
+LAZY_DFA *new_lazy_dfa (const REGEX * rxp);
+void free_lazy_dfa (LAZY_DFA * dp);
+const uchar *lazy_dfa_find (LAZY_DFA * dp, const uchar * p, size_t n);
+const uchar *lazy_dfa_part (LAZY_DFA * dp, const uchar * p, size_t n,
+                            const BOOL first, const BOOL last);
+static void regex_error (RX_PARSER * pp, const char *reason);
+static uint new_node (RX_PARSER * pp, const uchar type);
+static uint new_charset (RX_PARSER * pp);
+static void add_char (RX_PARSER * pp, const uint set, const int c);
+static void complement_set (RX_PARSER * pp, const uint set);
+static int single_char (RX_PARSER * pp, const uint set);
+static uint parse_alt (RX_PARSER * pp);
+static uint parse_cat (RX_PARSER * pp);
+static uint parse_atom (RX_PARSER * pp);
+static BOOL parse_interval (RX_PARSER * pp, uint * min, uint * max);
+static uint parse_bracket (RX_PARSER * pp);
+static BOOL add_class (RX_PARSER * pp, const uint set, const uchar * name,
+                       const size_t len);
+static uint new_state (RX_PARSER * pp, const uchar kind, const uint next,
+                       const uint alt, const uint set);
+static uint compile_node (RX_PARSER * pp, const uint k, uint next);
+static void find_literals (RX_PARSER * pp, const uint k);
+static void literal_run (RX_PARSER * pp, const uint k);
+static void end_run (RX_PARSER * pp);
+static void split_classes (REGEX * rxp);
+static void next_gen (LAZY_DFA * dp);
+static void closure (LAZY_DFA * dp, uint x, const BOOL bol, const BOOL eol,
+                     uint * list, uint * n);
+static uint step (LAZY_DFA * dp, const uint * list, const uint n,
+                  const uchar c, uint * out);
+static BOOL has_match (const LAZY_DFA * dp, const uint * list, const uint n);
+static BOOL eol_accept (LAZY_DFA * dp, const uint * list, const uint n,
+                        const BOOL bol);
+static int lookup_state (const LAZY_DFA * dp, const uint * list,
+                         const uint n);
+static int add_state (LAZY_DFA * dp, const uint * list, const uint n);
+static void flush_dfa (LAZY_DFA * dp);
+static int add_transition (LAZY_DFA * dp, const int s, const uint k,
+                           const uchar * q, const BOOL yield);
+static const uchar *run_dfa (LAZY_DFA * dp, const uchar * p,
+                             const uchar * end);
+static const uchar *simulate (LAZY_DFA * dp, const uchar * line,
+                              const uchar * end);
+static int compare_states (const void *a, const void *b);
+
+/* functions. */
+
+/*!
+   \fn REGEX * new_regex (char *const *, const size_t *, const ulong, const BOOL)
+
+   \brief A function that compiles many regular expressions into an automaton.
+
+   This function parses the `num' extended regular expressions
+   (`patterns' with lengths `lens') and compiles them into one
+   nondeterministic automaton, which matches if any of them
+   matches. It also finds the longest literal which each of
+   their alternatives requires. If `fold' is `true', then the
+   automaton ignores case distinctions. If a regular expression
+   is invalid, it exits.
+
+   \param patterns a pointer to a constant pointer to a character.
+   \param lens a pointer to a constant `size_t' type definition.
+   \param num a constant unsigned long integer.
+   \param fold a constant `BOOL' enumeration value.
+
+   \return A pointer to a `REGEX' data structure.
+*/
+REGEX *
+new_regex (char *const *patterns, const size_t * lens,
+           const ulong num, const BOOL fold)
+{
+  /* externs. */
+
+  /* function externs. */
+  extern void *emalloc (size_t);
+
+  REGEX *newp;
+
+  /* the parser and compiler state. */
+  RX_PARSER parser, *pp = &parser;
+
+  /* the roots of the patterns. */
+  uint root = RX_NONE, k, alt;
+
+  /* the total length of the patterns. */
+  size_t total = 0;
+
+  /* is used for the loops. */
+  register ulong i;
+  register uint c;
+
+  /* allocate enough memory space. */
+  newp = (REGEX *) emalloc (sizeof (REGEX));
+  newp->kinds = NULL;
+  newp->next = newp->alt = newp->set = NULL;
+  newp->charsets = NULL;
+  newp->num_charsets = newp->num_states = 0;
+  newp->literals = NULL;
+  newp->literal_lens = NULL;
+  newp->num_literals = 0L;
+
+  pp->rxp = newp;
+  pp->nodes = NULL;
+  pp->num_nodes = pp->room = 0;
+  pp->states_room = pp->sets_room = 0;
+  pp->fold = fold;
+
+  for (c = 0; c <= UCHAR_MAX; c++)
+    pp->char_sets[c] = RX_NONE;
+
+  /* parse the patterns (any of them may match). */
+  for (i = 0L; i < num; i++)
+    {
+      pp->pattern = patterns[i];
+      pp->p = (const uchar *) patterns[i];
+      pp->end = pp->p + lens[i];
+      pp->depth = 0;
+      total += lens[i];
+
+      /* a `)' which closes no group is an ordinary
+         character, so the whole pattern is parsed. */
+      k = parse_alt (pp);
+
+      if (root == RX_NONE)
+        root = k;
+      else
+        {
+          alt = new_node (pp, NODE_ALT);
+          pp->nodes[alt].child = root;
+          pp->nodes[root].sib = k;
+          root = alt;
+        }
+    }
+
+  /* find the required literals of the alternatives. */
+  pp->run = (char *) emalloc (total + 1);
+  pp->best = (char *) emalloc (total + 1);
+  pp->no_literal = false;
+  find_literals (pp, root);
+
+  /* the data is searched for the literals only
+     if every alternative requires one of them. */
+  if (pp->no_literal)
+    {
+      for (i = 0L; i < newp->num_literals; i++)
+        free (newp->literals[i]);
+      free (newp->literals);
+      free (newp->literal_lens);
+      newp->literals = NULL;
+      newp->literal_lens = NULL;
+      newp->num_literals = 0L;
+    }
+
+  free (pp->run);
+  free (pp->best);
+
+  /* compile the patterns in front of the accepting state. */
+  k = new_state (pp, RX_MATCH, RX_NONE, RX_NONE, 0);
+  newp->start = compile_node (pp, root, k);
+
+  free (pp->nodes);
+
+  /* the classes of the characters. */
+  split_classes (newp);
+
+  /* return the regular expression pointer. */
+  return newp;
+}
+
+/*!
+   \fn void free_regex (REGEX *)
+
+   \brief A function that deallocates a `REGEX' data structure.
+
+   \param rxp a pointer to a `REGEX' data structure.
+*/
+void
+free_regex (REGEX * rxp)
+{
+  /* is used for the loops. */
+  register ulong i;
+
+  if (rxp != NULL)
+    {
+      for (i = 0L; i < rxp->num_literals; i++)
+        free (rxp->literals[i]);
+
+      free (rxp->literals);
+      free (rxp->literal_lens);
+      free (rxp->kinds);
+      free (rxp->next);
+      free (rxp->alt);
+      free (rxp->set);
+      free (rxp->charsets);
+      free (rxp);
+    }
+}
+
+/*!
+   \fn static void regex_error (RX_PARSER *, const char *)
+
+   \brief A function that reports an invalid regular expression.
+
+   This function prints the regular expression which is parsed
+   (of the parser `pp') with the `reason' it is invalid and exits.
+
+   \param pp a pointer to a `RX_PARSER' data structure.
+   \param reason a pointer to a constant character.
+*/
+static void
+regex_error (RX_PARSER * pp, const char *reason)
+{
+  /* externs. */
+
+  /* function externs. */
+  extern void eprintf (char *, ...);
+
+  /* variable externs. */
+  extern cstring usage_invalid_regex;
+
+  eprintf (_(usage_invalid_regex), pp->pattern, _(reason));
+}
+
+/*!
+   \fn static uint new_node (RX_PARSER *, const uchar)
+
+   \brief A function that adds a new node of type `type'.
+
+   \param pp a pointer to a `RX_PARSER' data structure.
+   \param type a constant unsigned character.
+
+   \return An unsigned integer (the index of the node).
+*/
+static uint
+new_node (RX_PARSER * pp, const uchar type)
+{
+  /* externs. */
+
+  /* function externs. */
+  extern void *erealloc (void *, size_t);
+
+  RX_NODE *np;
+
+  /* grow the nodes. */
+  if (pp->num_nodes == pp->room)
+    {
+      pp->room = (pp->room > 0 ? pp->room * 2 : 64);
+      pp->nodes = (RX_NODE *) erealloc (pp->nodes,
+                                        pp->room * sizeof (RX_NODE));
+    }
+
+  np = &pp->nodes[pp->num_nodes];
+  np->type = type;
+  np->ch = -1;
+  np->set = 0;
+  np->min = np->max = 0;
+  np->child = np->sib = RX_NONE;
+
+  return pp->num_nodes++;
+}
+
+/*!
+   \fn static uint new_charset (RX_PARSER *)
+
+   \brief A function that adds a new empty character set.
+
+   \param pp a pointer to a `RX_PARSER' data structure.
+
+   \return An unsigned integer (the index of the set).
+*/
+static uint
+new_charset (RX_PARSER * pp)
+{
+  /* externs. */
+
+  /* function externs. */
+  extern void *erealloc (void *, size_t);
+
+  REGEX *rxp = pp->rxp;
+
+  /* grow the character sets. */
+  if (rxp->num_charsets == pp->sets_room)
+    {
+      pp->sets_room = (pp->sets_room > 0 ? pp->sets_room * 2 : 16);
+      rxp->charsets = (uchar *) erealloc (rxp->charsets,
+                                          pp->sets_room * RX_SET_BYTES);
+    }
+
+  memset (rxp->charsets + rxp->num_charsets * RX_SET_BYTES, 0, RX_SET_BYTES);
+
+  return rxp->num_charsets++;
+}
+
+/*!
+   \fn static void add_char (RX_PARSER *, const uint, const int)
+
+   \brief A function that adds a character to a character set.
+
+   This function adds the character `c' to the character set `set'
+   (and its other case too, if the case distinctions are ignored).
+
+   \param pp a pointer to a `RX_PARSER' data structure.
+   \param set a constant unsigned integer.
+   \param c a constant integer.
+*/
+static void
+add_char (RX_PARSER * pp, const uint set, const int c)
+{
+  uchar *bits = pp->rxp->charsets + set * RX_SET_BYTES;
+
+  bits[c >> 3] |= (uchar) (1 << (c & 7));
+
+  if (pp->fold)
+    {
+      bits[tolower (c) >> 3] |= (uchar) (1 << (tolower (c) & 7));
+      bits[toupper (c) >> 3] |= (uchar) (1 << (toupper (c) & 7));
+    }
+}
+
+/*!
+   \fn static void complement_set (RX_PARSER *, const uint)
+
+   \brief A function that complements a character set.
+
+   This function complements the character set `set'. The
+   complement never contains the new line (a line does not).
+
+   \param pp a pointer to a `RX_PARSER' data structure.
+   \param set a constant unsigned integer.
+*/
+static void
+complement_set (RX_PARSER * pp, const uint set)
+{
+  uchar *bits = pp->rxp->charsets + set * RX_SET_BYTES;
+
+  /* is used for the loops. */
+  register int i;
+
+  for (i = 0; i < RX_SET_BYTES; i++)
+    bits[i] ^= UCHAR_MAX;
+
+  bits['\n' >> 3] &= (uchar) ~(1 << ('\n' & 7));
+}
+
+/*!
+   \fn static int single_char (RX_PARSER *, const uint)
+
+   \brief A function that checks if a character set has one character.
+
+   This function returns the character of the character set `set'
+   (lowercase if the case distinctions are ignored, then its other
+   case may be in the set too) or -1 if the set has more of them.
+
+   \param pp a pointer to a `RX_PARSER' data structure.
+   \param set a constant unsigned integer.
+
+   \return An integer.
+*/
+static int
+single_char (RX_PARSER * pp, const uint set)
+{
+  const uchar *bits = pp->rxp->charsets + set * RX_SET_BYTES;
+
+  /* the first character of the set. */
+  register int c, first = -1;
+
+  for (c = 0; c <= UCHAR_MAX; c++)
+    if ((bits[c >> 3] >> (c & 7)) & 1)
+      {
+        if (first < 0)
+          first = c;
+        else if (!pp->fold || tolower (c) != tolower (first))
+          return -1;
+      }
+
+  return (first >= 0 && pp->fold ? tolower (first) : first);
+}
+
+/*!
+   \fn static uint parse_alt (RX_PARSER *)
+
+   \brief A function that parses an alternation.
+
+   \param pp a pointer to a `RX_PARSER' data structure.
+
+   \return An unsigned integer (the index of the node).
+*/
+static uint
+parse_alt (RX_PARSER * pp)
+{
+  /* the alternation and its last alternative. */
+  uint alt, last, k;
+
+  k = parse_cat (pp);
+
+  if (pp->p == pp->end || *pp->p != '|')
+    return k;
+
+  alt = new_node (pp, NODE_ALT);
+  pp->nodes[alt].child = last = k;
+
+  while (pp->p < pp->end && *pp->p == '|')
+    {
+      pp->p++;
+      k = parse_cat (pp);
+      pp->nodes[last].sib = k;
+      last = k;
+    }
+
+  return alt;
+}
+
+/*!
+   \fn static uint parse_cat (RX_PARSER *)
+
+   \brief A function that parses a concatenation.
+
+   This function parses the items of a concatenation (up to a `|'
+   or the `)' of the current group) with their repetitions. The
+   items are linked in reverse order, so a repetition applies to
+   the first of them. A repetition operator which does not follow
+   an item is an ordinary character.
+
+   \param pp a pointer to a `RX_PARSER' data structure.
+
+   \return An unsigned integer (the index of the node).
+*/
+static uint
+parse_cat (RX_PARSER * pp)
+{
+  /* the last item and the repetition counts. */
+  uint head = RX_NONE, k, min, max;
+
+  /* the current character. */
+  register int c;
+
+  while (pp->p < pp->end && *pp->p != '|'
+         && (*pp->p != ')' || pp->depth == 0))
+    {
+      c = *pp->p;
+
+      /* a repetition of the last item. */
+      if (head != RX_NONE && (c == '*' || c == '+' || c == '?'))
+        {
+          pp->p++;
+          min = (c == '+' ? 1 : 0);
+          max = (c == '?' ? 1 : RX_INFINITE);
+        }
+      else if (head == RX_NONE || c != '{'
+               || !parse_interval (pp, &min, &max))
+        {
+          k = parse_atom (pp);
+          pp->nodes[k].sib = head;
+          head = k;
+          continue;
+        }
+
+      k = new_node (pp, NODE_REPEAT);
+      pp->nodes[k].child = head;
+      pp->nodes[k].sib = pp->nodes[head].sib;
+      pp->nodes[k].min = min;
+      pp->nodes[k].max = max;
+      pp->nodes[head].sib = RX_NONE;
+      head = k;
+    }
+
+  /* an empty concatenation matches the empty string. */
+  if (head == RX_NONE)
+    return new_node (pp, NODE_EMPTY);
+
+  if (pp->nodes[head].sib == RX_NONE)
+    return head;
+
+  k = new_node (pp, NODE_CAT);
+  pp->nodes[k].child = head;
+
+  return k;
+}
+
+/*!
+   \fn static uint parse_atom (RX_PARSER *)
+
+   \brief A function that parses a group, a set, an anchor or a character.
+
+   \param pp a pointer to a `RX_PARSER' data structure.
+
+   \return An unsigned integer (the index of the node).
+*/
+static uint
+parse_atom (RX_PARSER * pp)
+{
+  /* variable externs. */
+  extern cstring regex_unmatched_paren;
+  extern cstring regex_trailing_backslash;
+  extern cstring regex_back_reference;
+  extern cstring regex_word_anchor;
+  extern cstring regex_too_big;
+
+  /* the node and its set. */
+  uint k, set;
+
+  /* the current character. */
+  register int c = *pp->p++;
+
+  switch (c)
+    {
+    case '(':
+      if (++pp->depth > RX_MAX_DEPTH)
+        regex_error (pp, regex_too_big);
+
+      k = parse_alt (pp);
+
+      if (pp->p == pp->end || *pp->p != ')')
+        regex_error (pp, regex_unmatched_paren);
+
+      pp->p++;
+      pp->depth--;
+      return k;
+
+    case '[':
+      return parse_bracket (pp);
+
+    case '^':
+      return new_node (pp, NODE_BOL);
+
+    case '$':
+      return new_node (pp, NODE_EOL);
+
+    case '.':
+      k = new_node (pp, NODE_SET);
+      pp->nodes[k].set = new_charset (pp);
+      complement_set (pp, pp->nodes[k].set);
+      return k;
+
+    case '\\':
+      if (pp->p == pp->end)
+        regex_error (pp, regex_trailing_backslash);
+
+      c = *pp->p++;
+
+      if (c >= '1' && c <= '9')
+        regex_error (pp, regex_back_reference);
+
+      if (strchr ("bB<>`'", c) != NULL)
+        regex_error (pp, regex_word_anchor);
+
+      /* the word and the space characters. */
+      if (strchr ("wWsS", c) != NULL)
+        {
+          k = new_node (pp, NODE_SET);
+          pp->nodes[k].set = set = new_charset (pp);
+          add_class (pp, set, (const uchar *) (c == 'w' || c == 'W'
+                                               ? "alnum" : "space"), 5);
+          if (c == 'w' || c == 'W')
+            add_char (pp, set, '_');
+
+          /* the complement of the set. */
+          if (c == 'W' || c == 'S')
+            complement_set (pp, set);
+
+          return k;
+        }
+      break;
+
+    default:
+      break;
+    }
+
+  /* an ordinary character (its set is shared). */
+  k = new_node (pp, NODE_SET);
+  pp->nodes[k].ch = (pp->fold ? tolower (c) : c);
+
+  if (pp->char_sets[c] == RX_NONE)
+    {
+      pp->char_sets[c] = new_charset (pp);
+      add_char (pp, pp->char_sets[c], c);
+    }
+
+  pp->nodes[k].set = pp->char_sets[c];
+
+  return k;
+}
+
+/*!
+   \fn static BOOL parse_interval (RX_PARSER *, uint *, uint *)
+
+   \brief A function that parses the counts of a repetition.
+
+   This function parses a `{M}', `{M,}', `{,N}' or `{M,N}' interval
+   (into `min' and `max'). If the `{' does not start an interval, it
+   returns `false' (it is an ordinary character). If the counts are
+   invalid, it exits.
+
+   \param pp a pointer to a `RX_PARSER' data structure.
+   \param min a pointer to an unsigned integer.
+   \param max a pointer to an unsigned integer.
+
+   \return A `BOOL' enumeration value.
+*/
+static BOOL
+parse_interval (RX_PARSER * pp, uint * min, uint * max)
+{
+  /* variable externs. */
+  extern cstring regex_invalid_interval;
+
+  /* the current character. */
+  const uchar *q = pp->p + 1;
+
+  /* the number of digits of the counts. */
+  uint digits = 0;
+
+  *min = 0;
+  while (q < pp->end && isdigit (*q))
+    {
+      if (*min <= RX_MAX_REPEAT)
+        *min = *min * 10 + (uint) (*q - '0');
+      q++;
+      digits++;
+    }
+
+  *max = *min;
+
+  if (q < pp->end && *q == ',')
+    {
+      *max = RX_INFINITE;
+
+      if (++q < pp->end && isdigit (*q))
+        {
+          *max = 0;
+          while (q < pp->end && isdigit (*q))
+            {
+              if (*max <= RX_MAX_REPEAT)
+                *max = *max * 10 + (uint) (*q - '0');
+              q++;
+              digits++;
+            }
+        }
+    }
+  else if (digits == 0)
+    return false;
+
+  if (q == pp->end || *q != '}')
+    return false;
+
+  if (*min > RX_MAX_REPEAT || *min > *max
+      || (*max != RX_INFINITE && *max > RX_MAX_REPEAT))
+    regex_error (pp, regex_invalid_interval);
+
+  pp->p = q + 1;
+
+  return true;
+}
+
+/*!
+   \fn static uint parse_bracket (RX_PARSER *)
+
+   \brief A function that parses a bracket expression.
+
+   This function parses a bracket expression (after its `['),
+   which may be negated (with a `^') and contain characters,
+   ranges, character classes (`[:alpha:]'), equivalence classes
+   and collating symbols of one character (`[=a=]', `[.a.]').
+   A negated set never matches a new line.
+
+   \param pp a pointer to a `RX_PARSER' data structure.
+
+   \return An unsigned integer (the index of the node).
+*/
+static uint
+parse_bracket (RX_PARSER * pp)
+{
+  /* variable externs. */
+  extern cstring regex_unmatched_bracket;
+  extern cstring regex_invalid_class;
+  extern cstring regex_invalid_range;
+
+  /* the node and its set. */
+  uint k, set;
+
+  /* is the set negated? is it the first element? */
+  BOOL negate = false, first = true;
+
+  /* the bounds of a range and the end of a class name. */
+  int lo, hi;
+  const uchar *q;
+
+  k = new_node (pp, NODE_SET);
+  pp->nodes[k].set = set = new_charset (pp);
+
+  if (pp->p < pp->end && *pp->p == '^')
+    {
+      negate = true;
+      pp->p++;
+    }
+
+  for (;;)
+    {
+      if (pp->p == pp->end)
+        regex_error (pp, regex_unmatched_bracket);
+
+      /* a `]' closes the set, unless it is the first element. */
+      if (*pp->p == ']' && !first)
+        {
+          pp->p++;
+          break;
+        }
+
+      first = false;
+
+      /* a character class. */
+      if (*pp->p == '[' && pp->p + 1 < pp->end && pp->p[1] == ':')
+        {
+          for (q = pp->p + 2; q + 1 < pp->end; q++)
+            if (q[0] == ':' && q[1] == ']')
+              break;
+
+          if (q + 1 >= pp->end)
+            regex_error (pp, regex_unmatched_bracket);
+
+          if (!add_class (pp, set, pp->p + 2, (size_t) (q - pp->p - 2)))
+            regex_error (pp, regex_invalid_class);
+
+          pp->p = q + 2;
+          continue;
+        }
+
+      /* the low bound of a range (or a single character). */
+      if (*pp->p == '[' && pp->p + 4 < pp->end
+          && (pp->p[1] == '=' || pp->p[1] == '.')
+          && pp->p[3] == pp->p[1] && pp->p[4] == ']')
+        {
+          lo = pp->p[2];
+          pp->p += 5;
+        }
+      else
+        lo = *pp->p++;
+
+      hi = lo;
+
+      /* the high bound of a range (a `-' before the `]' is literal). */
+      if (pp->p + 1 < pp->end && *pp->p == '-' && pp->p[1] != ']')
+        {
+          pp->p++;
+
+          if (*pp->p == '[' && pp->p + 4 < pp->end
+              && (pp->p[1] == '=' || pp->p[1] == '.')
+              && pp->p[3] == pp->p[1] && pp->p[4] == ']')
+            {
+              hi = pp->p[2];
+              pp->p += 5;
+            }
+          else
+            hi = *pp->p++;
+
+          if (hi < lo)
+            regex_error (pp, regex_invalid_range);
+        }
+
+      for (; lo <= hi; lo++)
+        add_char (pp, set, lo);
+    }
+
+  /* the complement of the set. */
+  if (negate)
+    complement_set (pp, set);
+
+  /* a set of one character is a literal character. */
+  pp->nodes[k].ch = single_char (pp, set);
+
+  return k;
+}
+
+/*!
+   \fn static BOOL add_class (RX_PARSER *, const uint, const uchar *, const size_t)
+
+   \brief A function that adds a character class to a character set.
+
+   This function adds the characters of the class `name' (with
+   length `len') to the character set `set'. If the class name is
+   unknown, it returns `false'.
+
+   \param pp a pointer to a `RX_PARSER' data structure.
+   \param set a constant unsigned integer.
+   \param name a pointer to a constant unsigned character.
+   \param len a constant `size_t' type definition.
+
+   \return A `BOOL' enumeration value.
+*/
+static BOOL
+add_class (RX_PARSER * pp, const uint set, const uchar * name,
+           const size_t len)
+{
+  /* the class names (in the order of the tests below). */
+  static const char *const names[] = {
+    "alpha", "digit", "alnum", "upper", "lower", "space",
+    "blank", "punct", "print", "graph", "cntrl", "xdigit", NULL
+  };
+
+  /* the class and its test. */
+  int class;
+  BOOL in;
+
+  /* is used for the loops. */
+  register int c;
+
+  for (class = 0; names[class] != NULL; class++)
+    if (strlen (names[class]) == len && !memcmp (names[class], name, len))
+      break;
+
+  if (names[class] == NULL)
+    return false;
+
+  for (c = 0; c <= UCHAR_MAX; c++)
+    {
+      switch (class)
+        {
+        case 0: in = (isalpha (c) ? true : false); break;
+        case 1: in = (isdigit (c) ? true : false); break;
+        case 2: in = (isalnum (c) ? true : false); break;
+        case 3: in = (isupper (c) ? true : false); break;
+        case 4: in = (islower (c) ? true : false); break;
+        case 5: in = (isspace (c) ? true : false); break;
+        case 6: in = (c == ' ' || c == '\t' ? true : false); break;
+        case 7: in = (ispunct (c) ? true : false); break;
+        case 8: in = (isprint (c) ? true : false); break;
+        case 9: in = (isgraph (c) ? true : false); break;
+        case 10: in = (iscntrl (c) ? true : false); break;
+        default: in = (isxdigit (c) ? true : false); break;
+        }
+
+      if (in)
+        add_char (pp, set, c);
+    }
+
+  return true;
+}
+
+/*!
+   \fn static uint new_state (RX_PARSER *, const uchar, const uint, const uint, const uint)
+
+   \brief A function that adds a new state to the automaton.
+
+   \param pp a pointer to a `RX_PARSER' data structure.
+   \param kind a constant unsigned character.
+   \param next a constant unsigned integer.
+   \param alt a constant unsigned integer.
+   \param set a constant unsigned integer.
+
+   \return An unsigned integer (the index of the state).
+*/
+static uint
+new_state (RX_PARSER * pp, const uchar kind, const uint next,
+           const uint alt, const uint set)
+{
+  /* externs. */
+
+  /* function externs. */
+  extern void *erealloc (void *, size_t);
+
+  /* variable externs. */
+  extern cstring regex_too_big;
+
+  REGEX *rxp = pp->rxp;
+
+  /* grow the states. */
+  if (rxp->num_states == pp->states_room)
+    {
+      if (rxp->num_states >= RX_MAX_STATES)
+        regex_error (pp, regex_too_big);
+
+      pp->states_room = (pp->states_room > 0 ? pp->states_room * 2 : 64);
+      rxp->kinds = (uchar *) erealloc (rxp->kinds, pp->states_room);
+      rxp->next = (uint *) erealloc (rxp->next,
+                                     pp->states_room * sizeof (uint));
+      rxp->alt = (uint *) erealloc (rxp->alt,
+                                    pp->states_room * sizeof (uint));
+      rxp->set = (uint *) erealloc (rxp->set,
+                                    pp->states_room * sizeof (uint));
+    }
+
+  rxp->kinds[rxp->num_states] = kind;
+  rxp->next[rxp->num_states] = next;
+  rxp->alt[rxp->num_states] = alt;
+  rxp->set[rxp->num_states] = set;
+
+  return rxp->num_states++;
+}
+
+/*!
+   \fn static uint compile_node (RX_PARSER *, const uint, uint)
+
+   \brief A function that compiles a node into states.
+
+   This function compiles the node `k' into states which go to
+   the state `next' after they match (Thompson's construction,
+   from the end to the start). A bounded repetition gets a copy
+   of its child for each count.
+
+   \param pp a pointer to a `RX_PARSER' data structure.
+   \param k a constant unsigned integer.
+   \param next an unsigned integer.
+
+   \return An unsigned integer (the entry state).
+*/
+static uint
+compile_node (RX_PARSER * pp, const uint k, uint next)
+{
+  /* the states of the node. */
+  uint s, t, c;
+
+  /* is used for the loops. */
+  register uint i;
+
+  switch (pp->nodes[k].type)
+    {
+    case NODE_SET:
+      return new_state (pp, RX_CHAR, next, RX_NONE, pp->nodes[k].set);
+
+    case NODE_BOL:
+      return new_state (pp, RX_BOL, next, RX_NONE, 0);
+
+    case NODE_EOL:
+      return new_state (pp, RX_EOL, next, RX_NONE, 0);
+
+    case NODE_CAT:
+      /* the items are linked in reverse order. */
+      for (c = pp->nodes[k].child; c != RX_NONE; c = pp->nodes[c].sib)
+        next = compile_node (pp, c, next);
+      return next;
+
+    case NODE_ALT:
+      c = pp->nodes[k].child;
+      s = compile_node (pp, c, next);
+      for (c = pp->nodes[c].sib; c != RX_NONE; c = pp->nodes[c].sib)
+        {
+          t = compile_node (pp, c, next);
+          s = new_state (pp, RX_SPLIT, s, t, 0);
+        }
+      return s;
+
+    case NODE_REPEAT:
+      c = pp->nodes[k].child;
+      t = next;
+      i = pp->nodes[k].min;
+
+      if (pp->nodes[k].max == RX_INFINITE)
+        {
+          /* a loop (through the last required copy, if any). */
+          s = new_state (pp, RX_SPLIT, RX_NONE, next, 0);
+          t = compile_node (pp, c, s);
+          pp->rxp->next[s] = t;
+
+          if (i == 0)
+            t = s;
+          else
+            i--;
+        }
+      else
+        /* the optional copies. */
+        for (s = pp->nodes[k].max - i; s > 0; s--)
+          {
+            t = compile_node (pp, c, t);
+            t = new_state (pp, RX_SPLIT, t, next, 0);
+          }
+
+      /* the required copies. */
+      for (; i > 0; i--)
+        t = compile_node (pp, c, t);
+
+      return t;
+
+    default:
+      return next;
+    }
+}
+
+/*!
+   \fn static void find_literals (RX_PARSER *, const uint)
+
+   \brief A function that finds the required literals of the alternatives.
+
+   This function finds the longest literal of each alternative of
+   the node `k' (a line which matches the alternative contains it)
+   and adds it to the literals of the regular expression. If an
+   alternative requires no literal, it marks it.
+
+   \param pp a pointer to a `RX_PARSER' data structure.
+   \param k a constant unsigned integer.
+*/
+static void
+find_literals (RX_PARSER * pp, const uint k)
+{
+  /* externs. */
+
+  /* function externs. */
+  extern void *emalloc (size_t);
+  extern void *erealloc (void *, size_t);
+
+  REGEX *rxp = pp->rxp;
+
+  /* the literal. */
+  char *lit;
+
+  /* is used for the loops. */
+  register uint c;
+  register size_t i;
+
+  if (pp->no_literal)
+    return;
+
+  if (pp->nodes[k].type == NODE_ALT)
+    {
+      for (c = pp->nodes[k].child; c != RX_NONE; c = pp->nodes[c].sib)
+        find_literals (pp, c);
+      return;
+    }
+
+  pp->run_len = pp->best_len = 0;
+  literal_run (pp, k);
+  end_run (pp);
+
+  if (pp->best_len == 0)
+    {
+      pp->no_literal = true;
+      return;
+    }
+
+  /* the runs are found in reverse. */
+  lit = (char *) emalloc (pp->best_len + 1);
+  for (i = 0; i < pp->best_len; i++)
+    lit[i] = pp->best[pp->best_len - 1 - i];
+  lit[pp->best_len] = '\0';
+
+  rxp->literals = (char **) erealloc (rxp->literals,
+                                      (rxp->num_literals + 1)
+                                      * sizeof (char *));
+  rxp->literal_lens = (size_t *) erealloc (rxp->literal_lens,
+                                           (rxp->num_literals + 1)
+                                           * sizeof (size_t));
+  rxp->literals[rxp->num_literals] = lit;
+  rxp->literal_lens[rxp->num_literals++] = pp->best_len;
+}
+
+/*!
+   \fn static void literal_run (RX_PARSER *, const uint)
+
+   \brief A function that extends the literal runs with a node.
+
+   This function walks the node `k' (in reverse order) and extends
+   the current run of the literal characters which are matched one
+   after the other. Any other node which matches characters ends it.
+
+   \param pp a pointer to a `RX_PARSER' data structure.
+   \param k a constant unsigned integer.
+*/
+static void
+literal_run (RX_PARSER * pp, const uint k)
+{
+  /* is used for the loops. */
+  register uint c;
+
+  switch (pp->nodes[k].type)
+    {
+    case NODE_SET:
+      if (pp->nodes[k].ch < 0)
+        end_run (pp);
+      else
+        pp->run[pp->run_len++] = (char) pp->nodes[k].ch;
+      break;
+
+    case NODE_CAT:
+      for (c = pp->nodes[k].child; c != RX_NONE; c = pp->nodes[c].sib)
+        literal_run (pp, c);
+      break;
+
+    case NODE_REPEAT:
+      /* a required copy has its own runs. */
+      end_run (pp);
+      if (pp->nodes[k].min > 0)
+        literal_run (pp, pp->nodes[k].child);
+      end_run (pp);
+      break;
+
+    case NODE_ALT:
+      end_run (pp);
+      break;
+
+    default:
+      break;
+    }
+}
+
+/*!
+   \fn static void end_run (RX_PARSER *)
+
+   \brief A function that ends the current literal run.
+
+   \param pp a pointer to a `RX_PARSER' data structure.
+*/
+static void
+end_run (RX_PARSER * pp)
+{
+  if (pp->run_len > pp->best_len)
+    {
+      memcpy (pp->best, pp->run, pp->run_len);
+      pp->best_len = pp->run_len;
+    }
+
+  pp->run_len = 0;
+}
+
+/*!
+   \fn static void split_classes (REGEX *)
+
+   \brief A function that maps the characters into classes.
+
+   This function splits the characters into classes, so that the
+   characters of a class are in the same character sets. The new
+   line has a class of its own.
+
+   \param rxp a pointer to a `REGEX' data structure.
+*/
+static void
+split_classes (REGEX * rxp)
+{
+  /* the new class of each (old class, membership) pair. */
+  uint map[2 * (UCHAR_MAX + 1)], n;
+
+  /* the membership of a character. */
+  uint in;
+
+  /* is used for the loops. */
+  register uint s, c;
+
+  for (c = 0; c <= UCHAR_MAX; c++)
+    rxp->classes[c] = (c == '\n' ? 1 : 0);
+  rxp->num_classes = 2;
+
+  for (s = 0; s < rxp->num_charsets; s++)
+    {
+      for (c = 0; c < 2 * rxp->num_classes; c++)
+        map[c] = RX_NONE;
+
+      for (n = 0, c = 0; c <= UCHAR_MAX; c++)
+        {
+          in = ((rxp->charsets[s * RX_SET_BYTES + (c >> 3)] >> (c & 7)) & 1);
+          if (map[rxp->classes[c] * 2 + in] == RX_NONE)
+            map[rxp->classes[c] * 2 + in] = n++;
+          rxp->classes[c] = map[rxp->classes[c] * 2 + in];
+        }
+
+      rxp->num_classes = n;
+    }
+
+  for (c = UCHAR_MAX + 1; c > 0; c--)
+    rxp->reps[rxp->classes[c - 1]] = (uchar) (c - 1);
+}
+
+/*!
+   \fn LAZY_DFA * new_lazy_dfa (const REGEX *)
+
+   \brief A function that returns a new lazy automaton.
+
+   This function allocates a new (empty) lazy deterministic
+   automaton of the regular expression `rxp'. Its cache has room
+   for `DFA_MAX_STATES' states, and a state has a transition for
+   each class of characters (not for each character), so a row
+   is small and many states fit.
+
+   \param rxp a pointer to a constant `REGEX' data structure.
+
+   \return A pointer to a `LAZY_DFA' data structure.
+*/
+LAZY_DFA *
+new_lazy_dfa (const REGEX * rxp)
+{
+  /* externs. */
+
+  /* function externs. */
+  extern void *emalloc (size_t);
+
+  LAZY_DFA *newp;
+
+  /* the number of states of the regular expression. */
+  const uint m = rxp->num_states;
+
+  /* allocate enough memory space. */
+  newp = (LAZY_DFA *) emalloc (sizeof (LAZY_DFA));
+  newp->rxp = rxp;
+
+  newp->row = rxp->num_classes;
+  newp->max_states = DFA_MAX_STATES;
+
+  for (newp->table_size = 1; newp->table_size < 2 * newp->max_states;)
+    newp->table_size *= 2;
+
+  /* any two sets fit in the room after a flush (it grows
+     up to `DFA_MAX_SET_ROOM' before the cache is flushed). */
+  newp->room = 2 * (size_t) m;
+  if (newp->room < DFA_SET_ROOM)
+    newp->room = DFA_SET_ROOM;
+
+  newp->delta = (uint *) emalloc ((size_t) newp->max_states
+                                  * newp->row * sizeof (uint));
+  newp->flags = (uchar *) emalloc (newp->max_states);
+  newp->offsets = (size_t *) emalloc (newp->max_states * sizeof (size_t));
+  newp->lens = (uint *) emalloc (newp->max_states * sizeof (uint));
+  newp->table = (uint *) emalloc (newp->table_size * sizeof (uint));
+  newp->sets = (uint *) emalloc (newp->room * sizeof (uint));
+  newp->start_set = (uint *) emalloc (m * sizeof (uint));
+  newp->work = (uint *) emalloc (m * sizeof (uint));
+  newp->scratch = (uint *) emalloc (m * sizeof (uint));
+  newp->spare = (uint *) emalloc (m * sizeof (uint));
+  newp->stack = (uint *) emalloc (m * sizeof (uint));
+  newp->marks = (uint *) emalloc (m * sizeof (uint));
+  memset (newp->marks, 0, m * sizeof (uint));
+  newp->gen = 0;
+
+  /* the start state is at a line start. */
+  newp->start_len = 0;
+  next_gen (newp);
+  closure (newp, rxp->start, true, false, newp->start_set, &newp->start_len);
+  qsort (newp->start_set, newp->start_len, sizeof (uint), compare_states);
+
+  flush_dfa (newp);
+  newp->base = NULL;
+  newp->scanned = 0;
+  newp->part = DFA_START;
+
+  /* return the automaton pointer. */
+  return newp;
+}
+
+/*!
+   \fn void free_lazy_dfa (LAZY_DFA *)
+
+   \brief A function that deallocates a `LAZY_DFA' data structure.
+
+   \param dp a pointer to a `LAZY_DFA' data structure.
+*/
+void
+free_lazy_dfa (LAZY_DFA * dp)
+{
+  if (dp != NULL)
+    {
+      free (dp->delta);
+      free (dp->flags);
+      free (dp->offsets);
+      free (dp->lens);
+      free (dp->table);
+      free (dp->sets);
+      free (dp->start_set);
+      free (dp->work);
+      free (dp->scratch);
+      free (dp->spare);
+      free (dp->stack);
+      free (dp->marks);
+      free (dp);
+    }
+}
+
+/*!
+   \fn const uchar * lazy_dfa_find (LAZY_DFA *, const uchar *, size_t)
+
+   \brief A function that finds the first line which matches.
+
+   This function runs the automaton (`dp') over the lines of the
+   `n' characters of `p' (which starts at a line start) once, so
+   its time is linear. It returns a pointer into the first line
+   which matches or NULL if there is not any.
+
+   \param dp a pointer to a `LAZY_DFA' data structure.
+   \param p a pointer to a constant unsigned character.
+   \param n a `size_t' type definition.
+
+   \return A pointer to a constant unsigned character.
+*/
+const uchar *
+lazy_dfa_find (LAZY_DFA * dp, const uchar * p, size_t n)
+{
+  /* the matching line. */
+  const uchar *hit, *end = p + n;
+
+  if (n == 0)
+    return NULL;
+
+  dp->base = p;
+  hit = run_dfa (dp, p, end);
+
+  /* the bytes which the cache has served. */
+  if (hit != NULL)
+    end = hit;
+  if (end > dp->base)
+    dp->scanned += (size_t) (end - dp->base);
+
+  return hit;
+}
+
+/*!
+   \fn const uchar * lazy_dfa_part (LAZY_DFA *, const uchar *, size_t, const BOOL, const BOOL)
+
+   \brief A function that finds a match in a part of a line.
+
+   This function runs the automaton (`dp') over the `n' characters
+   of `p', a part of one line (without its new line) which is read
+   in parts. The first part starts at the line start (`first'), the
+   next ones go on from the state at the end of the previous one, so
+   a match across two parts is found. The line end is checked after
+   the last part (`last'). The cache is flushed as often as needed,
+   but it never gives way to the simulation, which would need the
+   whole line. It returns a pointer into the part at the match or
+   NULL if there is not any yet.
+
+   \param dp a pointer to a `LAZY_DFA' data structure.
+   \param p a pointer to a constant unsigned character.
+   \param n a `size_t' type definition.
+   \param first a constant `BOOL' enumeration value.
+   \param last a constant `BOOL' enumeration value.
+
+   \return A pointer to a constant unsigned character.
+*/
+const uchar *
+lazy_dfa_part (LAZY_DFA * dp, const uchar * p, size_t n,
+               const BOOL first, const BOOL last)
+{
+  /* the classes of the characters. */
+  const uint *const classes = dp->rxp->classes;
+  const uint row = dp->row;
+
+  /* the current character and the end of the part. */
+  register const uchar *q = p;
+  const uchar *const end = p + n;
+
+  /* the current state (its row) and transition. */
+  register uint s = (first ? DFA_START : dp->part), e;
+  int t;
+
+  /* the start state matches every line. */
+  if (first && (dp->flags[DFA_START] & DFA_ACCEPT))
+    return p;
+
+  while (q < end)
+    {
+      if (!((e = dp->delta[s + classes[*q]]) & DFA_STOP))
+        {
+          s = e;
+          q++;
+          continue;
+        }
+
+      /* a transition into an accepting state. */
+      if (e != DFA_UNKNOWN)
+        return q;
+
+      t = add_transition (dp, (int) (s / row), classes[*q], q, false);
+      if (dp->flags[t] & DFA_ACCEPT)
+        return q;
+
+      s = (uint) t * row;
+      q++;
+    }
+
+  dp->part = s;
+
+  /* the line ends after the last part. */
+  if (last && (dp->flags[s / row] & DFA_EOL_ACCEPT))
+    return (q > p ? q - 1 : p);
+
+  return NULL;
+}
+
+/*!
+   \fn static void next_gen (LAZY_DFA *)
+
+   \brief A function that starts a new closure generation.
+
+   \param dp a pointer to a `LAZY_DFA' data structure.
+*/
+static void
+next_gen (LAZY_DFA * dp)
+{
+  if (++dp->gen == 0)
+    {
+      memset (dp->marks, 0, dp->rxp->num_states * sizeof (uint));
+      dp->gen = 1;
+    }
+}
+
+/*!
+   \fn static void closure (LAZY_DFA *, uint, const BOOL, const BOOL, uint *, uint *)
+
+   \brief A function that adds the closure of a state to a set.
+
+   This function adds to the set `list' (of length `n') the states
+   which are reached from the state `x' without a character (the
+   line start and the line end states are passed if `bol' and `eol'
+   are `true'). The states of the current generation are skipped.
+
+   \param dp a pointer to a `LAZY_DFA' data structure.
+   \param x an unsigned integer.
+   \param bol a constant `BOOL' enumeration value.
+   \param eol a constant `BOOL' enumeration value.
+   \param list a pointer to an unsigned integer.
+   \param n a pointer to an unsigned integer.
+*/
+static void
+closure (LAZY_DFA * dp, uint x, const BOOL bol, const BOOL eol,
+         uint * list, uint * n)
+{
+  const REGEX *rxp = dp->rxp;
+  uint *const stack = dp->stack, *const marks = dp->marks;
+  const uint gen = dp->gen;
+
+  /* the top of the stack. */
+  register uint top = 0;
+
+  if (marks[x] == gen)
+    return;
+
+  marks[x] = gen;
+  stack[top++] = x;
+
+  while (top > 0)
+    {
+      x = stack[--top];
+
+      switch (rxp->kinds[x])
+        {
+        case RX_SPLIT:
+          if (marks[rxp->alt[x]] != gen)
+            {
+              marks[rxp->alt[x]] = gen;
+              stack[top++] = rxp->alt[x];
+            }
+          if (marks[rxp->next[x]] != gen)
+            {
+              marks[rxp->next[x]] = gen;
+              stack[top++] = rxp->next[x];
+            }
+          break;
+
+        case RX_BOL:
+          if (bol && marks[rxp->next[x]] != gen)
+            {
+              marks[rxp->next[x]] = gen;
+              stack[top++] = rxp->next[x];
+            }
+          break;
+
+        case RX_EOL:
+          if (!eol)
+            list[(*n)++] = x;
+          else if (marks[rxp->next[x]] != gen)
+            {
+              marks[rxp->next[x]] = gen;
+              stack[top++] = rxp->next[x];
+            }
+          break;
+
+        default:
+          list[(*n)++] = x;
+          break;
+        }
+    }
+}
+
+/*!
+   \fn static uint step (LAZY_DFA *, const uint *, const uint, const uchar, uint *)
+
+   \brief A function that moves a set of states over a character.
+
+   This function puts in `out' the set of the states which are
+   reached from the set `list' (of length `n') over the character
+   `c' (not a new line). A match may start at any character, so
+   the closure of the start state is always added.
+
+   \param dp a pointer to a `LAZY_DFA' data structure.
+   \param list a pointer to a constant unsigned integer.
+   \param n a constant unsigned integer.
+   \param c a constant unsigned character.
+   \param out a pointer to an unsigned integer.
+
+   \return An unsigned integer (the length of the set).
+*/
+static uint
+step (LAZY_DFA * dp, const uint * list, const uint n, const uchar c,
+      uint * out)
+{
+  const REGEX *rxp = dp->rxp;
+
+  /* the length of the set. */
+  uint m = 0;
+
+  /* is used for the loops. */
+  register uint i, x;
+
+  next_gen (dp);
+
+  for (i = 0; i < n; i++)
+    {
+      x = list[i];
+
+      if (rxp->kinds[x] == RX_CHAR
+          && ((rxp->charsets[rxp->set[x] * RX_SET_BYTES + (uint) (c >> 3)]
+               >> (c & 7)) & 1))
+        closure (dp, rxp->next[x], false, false, out, &m);
+    }
+
+  closure (dp, rxp->start, false, false, out, &m);
+
+  return m;
+}
+
+/*!
+   \fn static BOOL has_match (const LAZY_DFA *, const uint *, const uint)
+
+   \brief A function that checks if a set of states has matched.
+
+   \param dp a pointer to a constant `LAZY_DFA' data structure.
+   \param list a pointer to a constant unsigned integer.
+   \param n a constant unsigned integer.
+
+   \return A `BOOL' enumeration value.
+*/
+static BOOL
+has_match (const LAZY_DFA * dp, const uint * list, const uint n)
+{
+  /* is used for the loops. */
+  register uint i;
+
+  for (i = 0; i < n; i++)
+    if (dp->rxp->kinds[list[i]] == RX_MATCH)
+      return true;
+
+  return false;
+}
+
+/*!
+   \fn static BOOL eol_accept (LAZY_DFA *, const uint *, const uint, const BOOL)
+
+   \brief A function that checks if a set of states matches at a line end.
+
+   This function checks if the set `list' (of length `n') matches
+   at a line end. If `bol' is `true', then the line end is a line
+   start too (the line is empty).
+
+   \param dp a pointer to a `LAZY_DFA' data structure.
+   \param list a pointer to a constant unsigned integer.
+   \param n a constant unsigned integer.
+   \param bol a constant `BOOL' enumeration value.
+
+   \return A `BOOL' enumeration value.
+*/
+static BOOL
+eol_accept (LAZY_DFA * dp, const uint * list, const uint n, const BOOL bol)
+{
+  /* the length of the closure. */
+  uint m = 0;
+
+  /* is used for the loops. */
+  register uint i;
+
+  if (has_match (dp, list, n))
+    return true;
+
+  next_gen (dp);
+
+  for (i = 0; i < n; i++)
+    if (dp->rxp->kinds[list[i]] == RX_EOL)
+      closure (dp, dp->rxp->next[list[i]], bol, true, dp->spare, &m);
+
+  return has_match (dp, dp->spare, m);
+}
+
+/*!
+   \fn static int lookup_state (const LAZY_DFA *, const uint *, const uint)
+
+   \brief A function that finds the cached state of a set of states.
+
+   \param dp a pointer to a constant `LAZY_DFA' data structure.
+   \param list a pointer to a constant unsigned integer (sorted).
+   \param n a constant unsigned integer.
+
+   \return An integer (the state or -1 if it is not cached).
+*/
+static int
+lookup_state (const LAZY_DFA * dp, const uint * list, const uint n)
+{
+  /* the hash of the set. */
+  uint h = 2166136261U;
+
+  /* the state. */
+  uint s;
+
+  /* is used for the loops. */
+  register uint i;
+
+  for (i = 0; i < n; i++)
+    h = (h ^ list[i]) * 16777619U;
+
+  for (i = h & (dp->table_size - 1); (s = dp->table[i]) != 0;
+       i = (i + 1) & (dp->table_size - 1))
+    if (dp->lens[s - 1] == n
+        && !memcmp (dp->sets + dp->offsets[s - 1], list, n * sizeof (uint)))
+      return (int) (s - 1);
+
+  return -1;
+}
+
+/*!
+   \fn static int add_state (LAZY_DFA *, const uint *, const uint)
+
+   \brief A function that caches a new state for a set of states.
+
+   This function caches a new state for the set `list' (sorted, of
+   length `n'), which must not be cached yet. Its transitions are
+   not computed yet. The cache must have room for it.
+
+   \param dp a pointer to a `LAZY_DFA' data structure.
+   \param list a pointer to a constant unsigned integer.
+   \param n a constant unsigned integer.
+
+   \return An integer (the state).
+*/
+static int
+add_state (LAZY_DFA * dp, const uint * list, const uint n)
+{
+  /* the hash of the set. */
+  uint h = 2166136261U;
+
+  /* the new state. */
+  const uint s = dp->num_states++;
+
+  /* is used for the loops. */
+  register uint i;
+
+  dp->offsets[s] = dp->used;
+  dp->lens[s] = n;
+  memcpy (dp->sets + dp->used, list, n * sizeof (uint));
+  dp->used += n;
+
+  dp->flags[s] = (uchar) ((has_match (dp, list, n) ? DFA_ACCEPT : 0)
+                          | (eol_accept (dp, list, n, false)
+                             ? DFA_EOL_ACCEPT : 0)
+                          | (eol_accept (dp, list, n, true)
+                             ? DFA_EMPTY_ACCEPT : 0));
+
+  for (i = 0; i < dp->row; i++)
+    dp->delta[(size_t) s * dp->row + i] = DFA_UNKNOWN;
+
+  for (i = 0; i < n; i++)
+    h = (h ^ list[i]) * 16777619U;
+
+  for (i = h & (dp->table_size - 1); dp->table[i] != 0;)
+    i = (i + 1) & (dp->table_size - 1);
+  dp->table[i] = s + 1;
+
+  return (int) s;
+}
+
+/*!
+   \fn static void flush_dfa (LAZY_DFA *)
+
+   \brief A function that empties the cache of the states.
+
+   This function drops all the cached states and caches
+   the start state again (as the state `DFA_START').
+
+   \param dp a pointer to a `LAZY_DFA' data structure.
+*/
+static void
+flush_dfa (LAZY_DFA * dp)
+{
+  dp->num_states = 0;
+  dp->used = 0;
+  memset (dp->table, 0, dp->table_size * sizeof (uint));
+
+  add_state (dp, dp->start_set, dp->start_len);
+}
+
+/*!
+   \fn static int add_transition (LAZY_DFA *, const int, const uint, const uchar *, const BOOL)
+
+   \brief A function that computes a transition of the lazy automaton.
+
+   This function computes the transition of the state `s' over
+   the class `k' (at the character `q'). If the next state is not
+   cached and the cache is full (the room of the sets grows first,
+   up to `DFA_MAX_SET_ROOM'), the cache is flushed. But if the cache
+   has served too few characters since the last flush and `yield' is
+   `true', it returns -1 (the automaton should give way to the
+   simulation).
+
+   \param dp a pointer to a `LAZY_DFA' data structure.
+   \param s a constant integer.
+   \param k a constant unsigned integer.
+   \param q a pointer to a constant unsigned character.
+   \param yield a constant `BOOL' enumeration value.
+
+   \return An integer (the next state or -1).
+*/
+static int
+add_transition (LAZY_DFA * dp, const int s, const uint k, const uchar * q,
+                const BOOL yield)
+{
+  /* externs. */
+
+  /* function externs. */
+  extern void *erealloc (void *, size_t);
+
+  /* the next set and state. */
+  uint n;
+  int t;
+
+  n = step (dp, dp->sets + dp->offsets[s], dp->lens[s], dp->rxp->reps[k],
+            dp->work);
+  qsort (dp->work, n, sizeof (uint), compare_states);
+
+  if ((t = lookup_state (dp, dp->work, n)) < 0)
+    {
+      /* the room of the sets grows before the cache is flushed. */
+      while (dp->used + n > dp->room && dp->room < DFA_MAX_SET_ROOM)
+        {
+          dp->room *= 2;
+          dp->sets = (uint *) erealloc (dp->sets, dp->room * sizeof (uint));
+        }
+
+      if (dp->num_states == dp->max_states || dp->used + n > dp->room)
+        {
+          if (yield && dp->scanned + (size_t) (q - dp->base)
+              < (size_t) DFA_MIN_YIELD * dp->num_states)
+            return -1;
+
+          /* the state `s' is dropped too. */
+          flush_dfa (dp);
+          dp->scanned = 0;
+          dp->base = q;
+
+          return add_state (dp, dp->work, n);
+        }
+
+      t = add_state (dp, dp->work, n);
+    }
+
+  /* the transition of the class. */
+  dp->delta[(size_t) s * dp->row + k] =
+    (uint) t * dp->row | (dp->flags[t] & DFA_ACCEPT ? DFA_STOP : 0);
+
+  return t;
+}
+
+/*!
+   \fn static const uchar * run_dfa (LAZY_DFA *, const uchar *, const uchar *)
+
+   \brief A function that runs the lazy automaton over the lines.
+
+   This function runs the automaton (`dp') from `p' up to `end'.
+   At each new line, it checks the line end states and starts
+   again. If the cache thrashes, the current line is searched by
+   the simulation of the regular expression, and the automaton
+   starts again (with an empty cache) at the next line.
+
+   \param dp a pointer to a `LAZY_DFA' data structure.
+   \param p a pointer to a constant unsigned character.
+   \param end a pointer to a constant unsigned character.
+
+   \return A pointer to a constant unsigned character.
+*/
+static const uchar *
+run_dfa (LAZY_DFA * dp, const uchar * p, const uchar * end)
+{
+  /* the automaton tables. */
+  const uint *const delta = dp->delta;
+  const uchar *const flags = dp->flags;
+  const uint *const classes = dp->rxp->classes;
+  const uint row = dp->row;
+
+  /* the current character and line, and a simulated match. */
+  register const uchar *q = p;
+  const uchar *line = p, *hit;
+
+  /* the current state (its row) and transition. */
+  register uint s = DFA_START, e = DFA_UNKNOWN;
+  int t;
+
+  /* the start state matches every line. */
+  if (flags[DFA_START] & DFA_ACCEPT)
+    return p;
+
+  for (;;)
+    {
+      /* follow the computed transitions until one stops. While
+         the state loops, the transitions do not depend on each
+         other, so they are taken as fast as they are loaded. */
+      while (q < end && !((e = delta[s + classes[*q]]) & DFA_STOP))
+        {
+          s = e;
+          q++;
+
+          while (end - q >= 4 && delta[s + classes[q[0]]] == s
+                 && delta[s + classes[q[1]]] == s
+                 && delta[s + classes[q[2]]] == s
+                 && delta[s + classes[q[3]]] == s)
+            q += 4;
+
+          while (q < end && delta[s + classes[*q]] == s)
+            q++;
+        }
+
+      if (q == end)
+        break;
+
+      /* a new line is never computed. */
+      if (*q == '\n')
+        {
+          if (flags[s / row]
+              & (q == line ? DFA_EMPTY_ACCEPT : DFA_EOL_ACCEPT))
+            return q;
+
+          s = DFA_START;
+          line = ++q;
+          continue;
+        }
+
+      /* a transition into an accepting state. */
+      if (e != DFA_UNKNOWN)
+        return q;
+
+      t = add_transition (dp, (int) (s / row), classes[*q], q, true);
+
+      if (t < 0)
+        {
+          /* only the current line is simulated. */
+          if ((hit = simulate (dp, line, end)) != NULL)
+            return hit;
+
+          if ((q = (const uchar *) memchr (q, '\n', (size_t) (end - q)))
+              == NULL)
+            return NULL;
+
+          flush_dfa (dp);
+          dp->scanned = 0;
+          dp->base = ++q;
+
+          s = DFA_START;
+          line = q;
+          continue;
+        }
+
+      if (flags[t] & DFA_ACCEPT)
+        return q;
+
+      s = (uint) t * row;
+      q++;
+    }
+
+  /* the last line has no new line. */
+  if (line < end && (flags[s / row] & DFA_EOL_ACCEPT))
+    return end - 1;
+
+  return NULL;
+}
+
+/*!
+   \fn static const uchar * simulate (LAZY_DFA *, const uchar *, const uchar *)
+
+   \brief A function that simulates the regular expression over a line.
+
+   This function moves a set of states of the regular expression
+   over the characters of the line `line' (up to its new line or
+   `end'), so its time is linear too (the sets are not cached).
+
+   \param dp a pointer to a `LAZY_DFA' data structure.
+   \param line a pointer to a constant unsigned character.
+   \param end a pointer to a constant unsigned character.
+
+   \return A pointer to a constant unsigned character.
+*/
+static const uchar *
+simulate (LAZY_DFA * dp, const uchar * line, const uchar * end)
+{
+  /* the current and the next set. */
+  uint *cur = dp->scratch, *nxt = dp->work, *tmp;
+  uint n;
+
+  /* the current character. */
+  const uchar *q;
+
+  memcpy (cur, dp->start_set, dp->start_len * sizeof (uint));
+  n = dp->start_len;
+
+  for (q = line; q < end && *q != '\n'; q++)
+    {
+      n = step (dp, cur, n, *q, nxt);
+      tmp = cur;
+      cur = nxt;
+      nxt = tmp;
+
+      if (has_match (dp, cur, n))
+        return q;
+    }
+
+  if (q < end)
+    return (eol_accept (dp, cur, n, (q == line ? true : false)) ? q : NULL);
+
+  if (line < end && eol_accept (dp, cur, n, false))
+    return end - 1;
+
+  return NULL;
+}
+
+/*!
+   \fn static int compare_states (const void *, const void *)
+
+   \brief A function that compares two states (for `qsort').
+
+   \param a a pointer to a constant void.
+   \param b a pointer to a constant void.
+
+   \return An integer.
+*/
+static int
+compare_states (const void *a, const void *b)
+{
+  const uint x = *(const uint *) a, y = *(const uint *) b;
+
+  return (x > y) - (x < y);
+}
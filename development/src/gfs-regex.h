@@ -0,0 +1,309 @@
+/*
+ *  `gfs-regex.h'.
+ *
+ *  This header contains the regular expression automata structs and typedefs.
+ *
+ *  Copyright (C) 2008  Efstathios Chatzikyriakidis (stathis.chatzikyriakidis@gmail.com).
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*!
+   \file gfs-regex.h
+   \brief This header contains the regular expression automata structs and typedefs.
+*/
+
+/*
+ * structure data types.
+ */
+
+/*!
+   \struct regexT
+   \brief Regular expression data structure.
+
+   This data structure keeps the regular expressions of a run as
+   one nondeterministic automaton (Thompson's construction). The
+   characters are mapped into classes (the characters which are
+   in the same character sets share one class). It also keeps the
+   literals which any matching line must contain (one for each of
+   the alternatives), so the data can be searched for them first.
+   The automaton is not changed after its compilation, so it can
+   be shared from many scanners.
+*/
+struct regexT
+{
+  /*!
+     \var kinds
+     \brief The kind of each state.
+   */
+  uchar *kinds;
+
+  /*!
+     \var next
+     \brief The next state of each state.
+   */
+  uint *next;
+
+  /*!
+     \var alt
+     \brief The alternative next state of each split state.
+   */
+  uint *alt;
+
+  /*!
+     \var set
+     \brief The character set of each character state.
+   */
+  uint *set;
+
+  /*!
+     \var charsets
+     \brief The character sets (as bitmaps).
+   */
+  uchar *charsets;
+
+  /*!
+     \var num_charsets
+     \brief The number of character sets.
+   */
+  uint num_charsets;
+
+  /*!
+     \var num_states
+     \brief The number of states.
+   */
+  uint num_states;
+
+  /*!
+     \var start
+     \brief The start state.
+   */
+  uint start;
+
+  /*!
+     \var classes
+     \brief The class of each character.
+   */
+  uint classes[UCHAR_MAX + 1];
+
+  /*!
+     \var reps
+     \brief A character of each class.
+   */
+  uchar reps[UCHAR_MAX + 1];
+
+  /*!
+     \var num_classes
+     \brief The number of character classes.
+   */
+  uint num_classes;
+
+  /*!
+     \var literals
+     \brief The required literals (lowercase if case insensitive).
+   */
+  char **literals;
+
+  /*!
+     \var literal_lens
+     \brief The lengths of the required literals.
+   */
+  size_t *literal_lens;
+
+  /*!
+     \var num_literals
+     \brief The number of the required literals (0 if there are none).
+   */
+  ulong num_literals;
+};
+
+/*!
+   \struct lazy_dfaT
+   \brief Lazy deterministic automaton data structure.
+
+   This data structure keeps the deterministic automaton of a
+   regular expression, which is built lazily (a state is a set of
+   states of the regular expression and a transition is computed
+   the first time it is taken). The states are kept in a cache of
+   bounded size, which is flushed when it is full. Each scanner
+   has its own automaton.
+*/
+struct lazy_dfaT
+{
+  /*!
+     \var rxp
+     \brief The regular expression.
+   */
+  const struct regexT *rxp;
+
+  /*!
+     \var delta
+     \brief The transitions (states x character classes).
+   */
+  uint *delta;
+
+  /*!
+     \var row
+     \brief The transitions of a state (the number of classes).
+   */
+  uint row;
+
+  /*!
+     \var flags
+     \brief The accepting flags of each state.
+   */
+  uchar *flags;
+
+  /*!
+     \var sets
+     \brief The sets of states of the regular expression.
+   */
+  uint *sets;
+
+  /*!
+     \var offsets
+     \brief The offset of the set of each state.
+   */
+  size_t *offsets;
+
+  /*!
+     \var lens
+     \brief The length of the set of each state.
+   */
+  uint *lens;
+
+  /*!
+     \var table
+     \brief The hash table of the states (state + 1, 0 if empty).
+   */
+  uint *table;
+
+  /*!
+     \var table_size
+     \brief The size of the hash table (a power of two).
+   */
+  uint table_size;
+
+  /*!
+     \var num_states
+     \brief The number of the cached states.
+   */
+  uint num_states;
+
+  /*!
+     \var max_states
+     \brief The max number of the cached states.
+   */
+  uint max_states;
+
+  /*!
+     \var used
+     \brief The used room of the sets.
+   */
+  size_t used;
+
+  /*!
+     \var room
+     \brief The room of the sets.
+   */
+  size_t room;
+
+  /*!
+     \var start_set
+     \brief The set of the start state.
+   */
+  uint *start_set;
+
+  /*!
+     \var start_len
+     \brief The length of the set of the start state.
+   */
+  uint start_len;
+
+  /*!
+     \var work
+     \brief A working set.
+   */
+  uint *work;
+
+  /*!
+     \var scratch
+     \brief A second working set.
+   */
+  uint *scratch;
+
+  /*!
+     \var spare
+     \brief A third working set.
+   */
+  uint *spare;
+
+  /*!
+     \var stack
+     \brief The stack of the closures.
+   */
+  uint *stack;
+
+  /*!
+     \var marks
+     \brief The generation of the closure which added each state.
+   */
+  uint *marks;
+
+  /*!
+     \var gen
+     \brief The generation of the current closure.
+   */
+  uint gen;
+
+  /*!
+     \var base
+     \brief The position from which the scanned bytes are counted.
+   */
+  const uchar *base;
+
+  /*!
+     \var scanned
+     \brief The bytes scanned since the last flush (up to `base').
+   */
+  size_t scanned;
+
+  /*!
+     \var part
+     \brief The state (its row) at the end of the last part of a line.
+   */
+  uint part;
+};
+
+/*
+ * type definitions.
+ */
+
+/*!
+   \typedef REGEX
+   \brief Regular expression data structure type definition.
+
+   This type definition is a synonym for
+   the regular expression data structure.
+*/
+typedef struct regexT REGEX;
+
+/*!
+   \typedef LAZY_DFA
+   \brief Lazy deterministic automaton data structure type definition.
+
+   This type definition is a synonym for the
+   lazy deterministic automaton data structure.
+*/
+typedef struct lazy_dfaT LAZY_DFA;
@@ -0,0 +1,680 @@
+/*
+ *  `gfs-search-kernels.c'.
+ *
+ *  This interface deals with the substring search kernels.
+ *
+ *  Copyright (C) 2008  Efstathios Chatzikyriakidis (stathis.chatzikyriakidis@gmail.com).
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*!
+   \file gfs-search-kernels.c
+   \brief This interface deals with the substring search kernels.
+*/
+
+/* standard includes. */
+#include <stdio.h>
+#include <string.h>
+#include <ctype.h>
+#include <limits.h>
+
+/* vector extensions (x86 only). */
+#if defined (__x86_64__) || (defined (__i386__) && defined (__SSE2__))
+# define GFS_X86_SIMD
+# include <immintrin.h>
+#endif /* x86 with SSE2. */
+
+/* basic includes. */
+#include "gfs-typedefs.h"
+#include "gfs-search-kernels.h"
+
+/* static variables. */
+
+/*!
+   \var fold_table
+   \brief The lowercase version of each character.
+*/
+static uchar fold_table[UCHAR_MAX + 1];
+
+/*!
+   \var other_case
+   \brief The other case of each lowercase character (or itself).
+*/
+static uchar other_case[UCHAR_MAX + 1];
+
+/*!
+   \var fold_pair
+   \brief Is a lowercase character the fold of at most itself and
+   its `other_case' character?
+*/
+static BOOL fold_pair[UCHAR_MAX + 1];
+
+/* function prototypes. */
+SEARCH_KERNEL select_search_kernel (const char *name, const BOOL fold);
+COUNT_KERNEL select_count_kernel (const char *name);
+static void init_fold_tables (void);
+static BOOL equal_case (const uchar * s, const uchar * lower, size_t m);
+static const uchar *search_libc (const uchar * haystack, size_t n,
+                                 const uchar * needle, size_t m);
+static const uchar *search_case (const uchar * haystack, size_t n,
+                                 const uchar * needle, size_t m);
+static ulong count_libc (const uchar * p, size_t n, const uchar c);
+#ifdef GFS_X86_SIMD
+static const uchar *search_sse2 (const uchar * haystack, size_t n,
+                                 const uchar * needle, size_t m);
+static const uchar *search_avx2 (const uchar * haystack, size_t n,
+                                 const uchar * needle, size_t m);
+static const uchar *search_case_sse2 (const uchar * haystack, size_t n,
+                                      const uchar * needle, size_t m);
+static const uchar *search_case_avx2 (const uchar * haystack, size_t n,
+                                      const uchar * needle, size_t m);
+static ulong count_sse2 (const uchar * p, size_t n, const uchar c);
+static ulong count_avx2 (const uchar * p, size_t n, const uchar c);
+#endif /* GFS_X86_SIMD. */
+
+/* functions. */
+
+/*!
+   \fn SEARCH_KERNEL select_search_kernel (const char *, const BOOL)
+
+   \brief A function that selects a substring search kernel by name.
+
+   This function returns the search kernel named `name' ("libc",
+   "sse2" or "avx2"). If `name' is NULL or "auto", then the fastest
+   kernel which the processor supports is detected at runtime. If
+   `fold' is `true', then the kernel ignores case distinctions (its
+   needle must be in lowercase). If the kernel is unknown or not
+   supported, it returns NULL.
+
+   \param name a pointer to a constant character.
+   \param fold a constant `BOOL' enumeration value.
+
+   \return A `SEARCH_KERNEL' type definition.
+*/
+SEARCH_KERNEL
+select_search_kernel (const char *name, const BOOL fold)
+{
+  /* the case folding kernels need the tables. */
+  if (fold)
+    init_fold_tables ();
+
+  /* the generic kernel of the C library. */
+  if (name != NULL && !strcmp (name, "libc"))
+    return (fold ? search_case : search_libc);
+
+#ifdef GFS_X86_SIMD
+  /* detect the processor features. */
+  __builtin_cpu_init ();
+
+  if ((name == NULL || !strcmp (name, "auto") || !strcmp (name, "avx2"))
+      && __builtin_cpu_supports ("avx2"))
+    return (fold ? search_case_avx2 : search_avx2);
+
+  if (name == NULL || !strcmp (name, "auto") || !strcmp (name, "sse2"))
+    return (fold ? search_case_sse2 : search_sse2);
+#else
+  if (name == NULL || !strcmp (name, "auto"))
+    return (fold ? search_case : search_libc);
+#endif /* GFS_X86_SIMD. */
+
+  /* unknown or unsupported kernel. */
+  return NULL;
+}
+
+/*!
+   \fn COUNT_KERNEL select_count_kernel (const char *)
+
+   \brief A function that selects a character counting kernel by name.
+
+   This function returns the counting kernel of the same instruction
+   set as the search kernel named `name' (see `select_search_kernel').
+   If the kernel is unknown or not supported, it returns NULL.
+
+   \param name a pointer to a constant character.
+
+   \return A `COUNT_KERNEL' type definition.
+*/
+COUNT_KERNEL
+select_count_kernel (const char *name)
+{
+  /* the generic kernel of the C library. */
+  if (name != NULL && !strcmp (name, "libc"))
+    return count_libc;
+
+#ifdef GFS_X86_SIMD
+  /* detect the processor features. */
+  __builtin_cpu_init ();
+
+  if ((name == NULL || !strcmp (name, "auto") || !strcmp (name, "avx2"))
+      && __builtin_cpu_supports ("avx2"))
+    return count_avx2;
+
+  if (name == NULL || !strcmp (name, "auto") || !strcmp (name, "sse2"))
+    return count_sse2;
+#else
+  if (name == NULL || !strcmp (name, "auto"))
+    return count_libc;
+#endif /* GFS_X86_SIMD. */
+
+  /* unknown or unsupported kernel. */
+  return NULL;
+}
+
+/*!
+   \fn static void init_fold_tables (void)
+
+   \brief A function that initializes the case folding tables.
+
+   This function folds each character with `tolower' (so the current
+   locale is respected) and finds the other case of each lowercase
+   character. A lowercase character is a fold pair if no other
+   character than itself and its other case folds into it. Only the
+   fold pairs can be compared with two vector comparisons.
+*/
+static void
+init_fold_tables (void)
+{
+  /* is used for the loops. */
+  register int c;
+
+  for (c = 0; c <= UCHAR_MAX; c++)
+    {
+      fold_table[c] = (uchar) tolower (c);
+      other_case[c] = (uchar) c;
+      fold_pair[c] = true;
+    }
+
+  for (c = 0; c <= UCHAR_MAX; c++)
+    if (toupper (c) != c && fold_table[toupper (c)] == c)
+      other_case[c] = (uchar) toupper (c);
+
+  for (c = 0; c <= UCHAR_MAX; c++)
+    if (c != fold_table[c] && c != other_case[fold_table[c]])
+      fold_pair[fold_table[c]] = false;
+}
+
+/*!
+   \fn static BOOL equal_case (const uchar *, const uchar *, size_t)
+
+   \brief A function that compares characters ignoring case distinctions.
+
+   \param s a pointer to a constant unsigned character.
+   \param lower a pointer to a constant unsigned character (lowercase).
+   \param m a `size_t' type definition.
+
+   \return A `BOOL' enumeration value (`false', `true').
+*/
+static BOOL
+equal_case (const uchar * s, const uchar * lower, size_t m)
+{
+  while (m-- > 0)
+    if (fold_table[*s++] != *lower++)
+      return false;
+
+  return true;
+}
+
+/*!
+   \fn static const uchar * search_libc (const uchar *, size_t, const uchar *, size_t)
+
+   \brief A function that searches a substring with the C library.
+
+   \param haystack a pointer to a constant unsigned character.
+   \param n a `size_t' type definition.
+   \param needle a pointer to a constant unsigned character.
+   \param m a `size_t' type definition.
+
+   \return A pointer to a constant unsigned character.
+*/
+static const uchar *
+search_libc (const uchar * haystack, size_t n, const uchar * needle, size_t m)
+{
+  return (const uchar *) memmem (haystack, n, needle, m);
+}
+
+/*!
+   \fn static const uchar * search_case (const uchar *, size_t, const uchar *, size_t)
+
+   \brief A function that searches a substring ignoring case distinctions.
+
+   This function compares the folded characters of the `haystack'
+   with the lowercase `needle', with no copies of the `haystack'.
+
+   \param haystack a pointer to a constant unsigned character.
+   \param n a `size_t' type definition.
+   \param needle a pointer to a constant unsigned character (lowercase).
+   \param m a `size_t' type definition.
+
+   \return A pointer to a constant unsigned character.
+*/
+static const uchar *
+search_case (const uchar * haystack, size_t n, const uchar * needle, size_t m)
+{
+  /* the last position of an occurrence. */
+  const uchar *last;
+
+  if (m == 0)
+    return haystack;
+
+  if (n < m)
+    return NULL;
+
+  for (last = haystack + n - m; haystack <= last; haystack++)
+    if (fold_table[*haystack] == needle[0]
+        && equal_case (haystack + 1, needle + 1, m - 1))
+      return haystack;
+
+  return NULL;
+}
+
+/*!
+   \fn static ulong count_libc (const uchar *, size_t, const uchar)
+
+   \brief A function that counts a character with the C library.
+
+   \param p a pointer to a constant unsigned character.
+   \param n a `size_t' type definition.
+   \param c a constant unsigned character.
+
+   \return An unsigned long integer.
+*/
+static ulong
+count_libc (const uchar * p, size_t n, const uchar c)
+{
+  /* the end of the block. */
+  const uchar *end = p + n;
+
+  register ulong cnt = 0L;
+
+  while (p < end && (p = (const uchar *) memchr (p, c, (size_t) (end - p)))
+         != NULL)
+    {
+      ++cnt;
+      ++p;
+    }
+
+  return cnt;
+}
+
+#ifdef GFS_X86_SIMD
+
+/*!
+   \fn static const uchar * search_sse2 (const uchar *, size_t, const uchar *, size_t)
+
+   \brief A function that searches a substring with SSE2 instructions.
+
+   This function compares 16 positions of the `haystack' at a time
+   with the first and the last character of the `needle' (broadcast
+   in vector registers). Only the positions where both characters
+   match are verified with `memcmp'. The tail of the `haystack' is
+   searched by the C library.
+
+   \param haystack a pointer to a constant unsigned character.
+   \param n a `size_t' type definition.
+   \param needle a pointer to a constant unsigned character.
+   \param m a `size_t' type definition.
+
+   \return A pointer to a constant unsigned character.
+*/
+static const uchar *
+search_sse2 (const uchar * haystack, size_t n, const uchar * needle, size_t m)
+{
+  /* the first and the last character of the needle. */
+  __m128i first, last;
+
+  /* current position of the haystack. */
+  size_t i = 0;
+
+  /* trivial needles. */
+  if (m < 2)
+    return (m == 0 ? haystack :
+            (const uchar *) memchr (haystack, needle[0], n));
+
+  if (n < m)
+    return NULL;
+
+  first = _mm_set1_epi8 ((char) needle[0]);
+  last = _mm_set1_epi8 ((char) needle[m - 1]);
+
+  /* the last character of the 16th position must fit. */
+  for (; i + m + 15 <= n; i += 16)
+    {
+      __m128i a = _mm_loadu_si128 ((const __m128i *) (haystack + i));
+      __m128i b = _mm_loadu_si128 ((const __m128i *) (haystack + i + m - 1));
+      uint mask = (uint) _mm_movemask_epi8 (_mm_and_si128
+                                            (_mm_cmpeq_epi8 (a, first),
+                                             _mm_cmpeq_epi8 (b, last)));
+
+      /* verify the candidates. */
+      while (mask != 0)
+        {
+          const uint bit = (uint) __builtin_ctz (mask);
+
+          if (!memcmp (haystack + i + bit + 1, needle + 1, m - 2))
+            return haystack + i + bit;
+
+          mask &= mask - 1;
+        }
+    }
+
+  /* search the tail. */
+  return search_libc (haystack + i, n - i, needle, m);
+}
+
+/*!
+   \fn static const uchar * search_avx2 (const uchar *, size_t, const uchar *, size_t)
+
+   \brief A function that searches a substring with AVX2 instructions.
+
+   This function is the same as `search_sse2', but it compares
+   32 positions of the `haystack' at a time.
+
+   \param haystack a pointer to a constant unsigned character.
+   \param n a `size_t' type definition.
+   \param needle a pointer to a constant unsigned character.
+   \param m a `size_t' type definition.
+
+   \return A pointer to a constant unsigned character.
+*/
+__attribute__ ((target ("avx2")))
+static const uchar *
+search_avx2 (const uchar * haystack, size_t n, const uchar * needle, size_t m)
+{
+  /* the first and the last character of the needle. */
+  __m256i first, last;
+
+  /* current position of the haystack. */
+  size_t i = 0;
+
+  /* trivial needles. */
+  if (m < 2)
+    return (m == 0 ? haystack :
+            (const uchar *) memchr (haystack, needle[0], n));
+
+  if (n < m)
+    return NULL;
+
+  first = _mm256_set1_epi8 ((char) needle[0]);
+  last = _mm256_set1_epi8 ((char) needle[m - 1]);
+
+  /* the last character of the 32nd position must fit. */
+  for (; i + m + 31 <= n; i += 32)
+    {
+      __m256i a = _mm256_loadu_si256 ((const __m256i *) (haystack + i));
+      __m256i b = _mm256_loadu_si256 ((const __m256i *)
+                                      (haystack + i + m - 1));
+      uint mask = (uint) _mm256_movemask_epi8 (_mm256_and_si256
+                                               (_mm256_cmpeq_epi8 (a, first),
+                                                _mm256_cmpeq_epi8 (b, last)));
+
+      /* verify the candidates. */
+      while (mask != 0)
+        {
+          const uint bit = (uint) __builtin_ctz (mask);
+
+          if (!memcmp (haystack + i + bit + 1, needle + 1, m - 2))
+            return haystack + i + bit;
+
+          mask &= mask - 1;
+        }
+    }
+
+  /* search the tail. */
+  return search_sse2 (haystack + i, n - i, needle, m);
+}
+
+/*!
+   \fn static const uchar * search_case_sse2 (const uchar *, size_t, const uchar *, size_t)
+
+   \brief A function that searches a substring ignoring case distinctions
+   with SSE2 instructions.
+
+   This function is the same as `search_sse2', but the first and
+   the last character of the `haystack' are compared with both cases
+   of the first and the last character of the `needle' (its other
+   case is broadcast, too). The candidates are verified with the fold
+   table. If those characters are not fold pairs, the scalar kernel
+   is used.
+
+   \param haystack a pointer to a constant unsigned character.
+   \param n a `size_t' type definition.
+   \param needle a pointer to a constant unsigned character (lowercase).
+   \param m a `size_t' type definition.
+
+   \return A pointer to a constant unsigned character.
+*/
+static const uchar *
+search_case_sse2 (const uchar * haystack, size_t n, const uchar * needle,
+                  size_t m)
+{
+  /* both cases of the first and the last character of the needle. */
+  __m128i first, first_other, last, last_other;
+
+  /* current position of the haystack. */
+  size_t i = 0;
+
+  /* trivial or exotic needles. */
+  if (m < 2 || n < m || !fold_pair[needle[0]] || !fold_pair[needle[m - 1]])
+    return search_case (haystack, n, needle, m);
+
+  first = _mm_set1_epi8 ((char) needle[0]);
+  first_other = _mm_set1_epi8 ((char) other_case[needle[0]]);
+  last = _mm_set1_epi8 ((char) needle[m - 1]);
+  last_other = _mm_set1_epi8 ((char) other_case[needle[m - 1]]);
+
+  /* the last character of the 16th position must fit. */
+  for (; i + m + 15 <= n; i += 16)
+    {
+      __m128i a = _mm_loadu_si128 ((const __m128i *) (haystack + i));
+      __m128i b = _mm_loadu_si128 ((const __m128i *) (haystack + i + m - 1));
+      uint mask = (uint) _mm_movemask_epi8 (_mm_and_si128
+                                            (_mm_or_si128
+                                             (_mm_cmpeq_epi8 (a, first),
+                                              _mm_cmpeq_epi8 (a, first_other)),
+                                             _mm_or_si128
+                                             (_mm_cmpeq_epi8 (b, last),
+                                              _mm_cmpeq_epi8 (b, last_other))));
+
+      /* verify the candidates. */
+      while (mask != 0)
+        {
+          const uint bit = (uint) __builtin_ctz (mask);
+
+          if (equal_case (haystack + i + bit + 1, needle + 1, m - 2))
+            return haystack + i + bit;
+
+          mask &= mask - 1;
+        }
+    }
+
+  /* search the tail. */
+  return search_case (haystack + i, n - i, needle, m);
+}
+
+/*!
+   \fn static const uchar * search_case_avx2 (const uchar *, size_t, const uchar *, size_t)
+
+   \brief A function that searches a substring ignoring case distinctions
+   with AVX2 instructions.
+
+   This function is the same as `search_case_sse2', but it compares
+   32 positions of the `haystack' at a time.
+
+   \param haystack a pointer to a constant unsigned character.
+   \param n a `size_t' type definition.
+   \param needle a pointer to a constant unsigned character (lowercase).
+   \param m a `size_t' type definition.
+
+   \return A pointer to a constant unsigned character.
+*/
+__attribute__ ((target ("avx2")))
+static const uchar *
+search_case_avx2 (const uchar * haystack, size_t n, const uchar * needle,
+                  size_t m)
+{
+  /* both cases of the first and the last character of the needle. */
+  __m256i first, first_other, last, last_other;
+
+  /* current position of the haystack. */
+  size_t i = 0;
+
+  /* trivial or exotic needles. */
+  if (m < 2 || n < m || !fold_pair[needle[0]] || !fold_pair[needle[m - 1]])
+    return search_case (haystack, n, needle, m);
+
+  first = _mm256_set1_epi8 ((char) needle[0]);
+  first_other = _mm256_set1_epi8 ((char) other_case[needle[0]]);
+  last = _mm256_set1_epi8 ((char) needle[m - 1]);
+  last_other = _mm256_set1_epi8 ((char) other_case[needle[m - 1]]);
+
+  /* the last character of the 32nd position must fit. */
+  for (; i + m + 31 <= n; i += 32)
+    {
+      __m256i a = _mm256_loadu_si256 ((const __m256i *) (haystack + i));
+      __m256i b = _mm256_loadu_si256 ((const __m256i *)
+                                      (haystack + i + m - 1));
+      uint mask = (uint) _mm256_movemask_epi8 (_mm256_and_si256
+                                               (_mm256_or_si256
+                                                (_mm256_cmpeq_epi8 (a, first),
+                                                 _mm256_cmpeq_epi8
+                                                 (a, first_other)),
+                                                _mm256_or_si256
+                                                (_mm256_cmpeq_epi8 (b, last),
+                                                 _mm256_cmpeq_epi8
+                                                 (b, last_other))));
+
+      /* verify the candidates. */
+      while (mask != 0)
+        {
+          const uint bit = (uint) __builtin_ctz (mask);
+
+          if (equal_case (haystack + i + bit + 1, needle + 1, m - 2))
+            return haystack + i + bit;
+
+          mask &= mask - 1;
+        }
+    }
+
+  /* search the tail. */
+  return search_case_sse2 (haystack + i, n - i, needle, m);
+}
+
+/*!
+   \fn static ulong count_sse2 (const uchar *, size_t, const uchar)
+
+   \brief A function that counts a character with SSE2 instructions.
+
+   This function compares 16 characters of the block at a time with
+   the character `c' (broadcast in a vector register), and subtracts
+   each comparison (0 or -1 per character) from 16 byte counters. The
+   byte counters are summed (`psadbw') before they could overflow,
+   after 255 vectors. So there is no branch per occurrence. The tail
+   of the block is counted by the C library.
+
+   \param p a pointer to a constant unsigned character.
+   \param n a `size_t' type definition.
+   \param c a constant unsigned character.
+
+   \return An unsigned long integer.
+*/
+static ulong
+count_sse2 (const uchar * p, size_t n, const uchar c)
+{
+  /* the character and the zero vector. */
+  const __m128i needle = _mm_set1_epi8 ((char) c);
+  const __m128i zero = _mm_setzero_si128 ();
+
+  /* the byte counters and their sums. */
+  __m128i acc, sum;
+
+  /* current position of the block and the end of the round. */
+  size_t i = 0, stop;
+
+  ulong cnt = 0L;
+
+  while (i + 16 <= n)
+    {
+      acc = zero;
+      stop = (n - i) / 16 > 255 ? i + 255 * 16 : n;
+
+      for (; i + 16 <= stop; i += 16)
+        acc = _mm_sub_epi8 (acc, _mm_cmpeq_epi8
+                            (_mm_loadu_si128 ((const __m128i *) (p + i)),
+                             needle));
+
+      /* each half sums at most 8 * 255 counts. */
+      sum = _mm_sad_epu8 (acc, zero);
+      cnt += (ulong) _mm_extract_epi16 (sum, 0)
+        + (ulong) _mm_extract_epi16 (sum, 4);
+    }
+
+  /* count the tail. */
+  return cnt + count_libc (p + i, n - i, c);
+}
+
+/*!
+   \fn static ulong count_avx2 (const uchar *, size_t, const uchar)
+
+   \brief A function that counts a character with AVX2 instructions.
+
+   This function is the same as `count_sse2', but it compares
+   32 characters of the block at a time.
+
+   \param p a pointer to a constant unsigned character.
+   \param n a `size_t' type definition.
+   \param c a constant unsigned character.
+
+   \return An unsigned long integer.
+*/
+__attribute__ ((target ("avx2")))
+static ulong
+count_avx2 (const uchar * p, size_t n, const uchar c)
+{
+  /* the character and the zero vector. */
+  const __m256i needle = _mm256_set1_epi8 ((char) c);
+  const __m256i zero = _mm256_setzero_si256 ();
+
+  /* the byte counters and their sums. */
+  __m256i acc, wide;
+  __m128i sum;
+
+  /* current position of the block and the end of the round. */
+  size_t i = 0, stop;
+
+  ulong cnt = 0L;
+
+  while (i + 32 <= n)
+    {
+      acc = zero;
+      stop = (n - i) / 32 > 255 ? i + 255 * 32 : n;
+
+      for (; i + 32 <= stop; i += 32)
+        acc = _mm256_sub_epi8 (acc, _mm256_cmpeq_epi8
+                               (_mm256_loadu_si256
+                                ((const __m256i *) (p + i)), needle));
+
+      /* each quarter sums at most 8 * 255 counts. */
+      wide = _mm256_sad_epu8 (acc, zero);
+      sum = _mm_add_epi64 (_mm256_castsi256_si128 (wide),
+                           _mm256_extracti128_si256 (wide, 1));
+      cnt += (ulong) _mm_extract_epi16 (sum, 0)
+        + (ulong) _mm_extract_epi16 (sum, 4);
+    }
+
+  /* count the tail. */
+  return cnt + count_sse2 (p + i, n - i, c);
+}
+
+#endif /* GFS_X86_SIMD. */
@@ -0,0 +1,52 @@
+/*
+ *  `gfs-search-kernels.h'.
+ *
+ *  This header contains the substring search kernels typedefs.
+ *
+ *  Copyright (C) 2008  Efstathios Chatzikyriakidis (stathis.chatzikyriakidis@gmail.com).
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*!
+   \file gfs-search-kernels.h
+   \brief This header contains the substring search kernels typedefs.
+*/
+
+/*
+ * type definitions.
+ */
+
+/*!
+   \typedef SEARCH_KERNEL
+   \brief Substring search kernel type definition.
+
+   This type definition is a synonym for a pointer to a function that
+   looks for the first occurrence of a `needle' of `m' characters in
+   a `haystack' of `n' characters. Both are length delimited (they may
+   contain NUL characters). It returns a pointer to the occurrence or
+   NULL if there is not any.
+*/
+typedef const uchar *(*SEARCH_KERNEL) (const uchar * haystack, size_t n,
+                                       const uchar * needle, size_t m);
+
+/*!
+   \typedef COUNT_KERNEL
+   \brief Character counting kernel type definition.
+
+   This type definition is a synonym for a pointer to a function that
+   returns the number of the occurrences of a character `c' in a block
+   `p' of `n' characters (the new lines of the block, for example).
+*/
+typedef ulong (*COUNT_KERNEL) (const uchar * p, size_t n, const uchar c);
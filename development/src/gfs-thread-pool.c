@@ -0,0 +1,458 @@
+/*
+ *  `gfs-thread-pool.c'.
+ *
+ *  This interface deals with the worker thread pool.
+ *
+ *  Copyright (C) 2008  Efstathios Chatzikyriakidis (stathis.chatzikyriakidis@gmail.com).
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*!
+   \file gfs-thread-pool.c
+   \brief This interface deals with the worker thread pool.
+*/
+
+/* standard includes. */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <sched.h>
+
+/* basic includes. */
+#include "gfs-typedefs.h"
+#include "gfs-thread-pool.h"
+
+/* enumeration constants. */
+
+/*!
+   \brief Constants used from the interface.
+
+   This anonymous enumeration is used from the
+   interface in order to specify some constants.
+*/
+enum
+{
+  MIN_TASKS = 16,               /*!< Initial size of a task queue. */
+  MAX_CGROUP_LINE = 4096        /*!< Max characters of a cgroup file line. */
+};
+
+/* function prototypes. */
+THREAD_POOL *new_thread_pool (const ulong num_workers);
+void free_thread_pool (THREAD_POOL * pool);
+void thread_pool_submit (THREAD_POOL * pool, TASK_FUNC func, void *arg);
+ulong default_num_jobs (void);
+static void *run_worker (void *arg);
+static BOOL take_task (WORKER * wp, TASK * task);
+static ulong cgroup_cpu_quota (void);
+static BOOL read_cgroup_line (const char *dir, const char *name,
+                              char *line);
+
+/* functions. */
+
+/*!
+   \fn THREAD_POOL * new_thread_pool (const ulong)
+
+   \brief A function that returns a new `THREAD_POOL' data structure.
+
+   This function allocates a new worker thread pool and starts its
+   `num_workers' worker threads. If a thread can not be started, it
+   exits.
+
+   \param num_workers a constant unsigned long integer.
+
+   \return A pointer to a `THREAD_POOL' data structure.
+*/
+THREAD_POOL *
+new_thread_pool (const ulong num_workers)
+{
+  /* externs. */
+
+  /* function externs. */
+  extern void *emalloc (size_t);
+  extern void eprintf (char *, ...);
+
+  THREAD_POOL *newp;
+
+  /* is used for the loops. */
+  register ulong i;
+
+  /* allocate enough memory space. */
+  newp = (THREAD_POOL *) emalloc (sizeof (THREAD_POOL));
+  newp->workers = (WORKER *) emalloc (num_workers * sizeof (WORKER));
+  newp->num_workers = num_workers;
+  newp->next = newp->pending = 0L;
+  newp->done = false;
+
+  pthread_mutex_init (&newp->lock, NULL);
+  pthread_cond_init (&newp->wake, NULL);
+
+  /* init the queues before any worker can steal. */
+  for (i = 0L; i < num_workers; i++)
+    {
+      WORKER *wp = &newp->workers[i];
+
+      pthread_mutex_init (&wp->lock, NULL);
+      wp->tasks = (TASK *) emalloc (MIN_TASKS * sizeof (TASK));
+      wp->size = MIN_TASKS;
+      wp->head = wp->count = 0L;
+      wp->index = i;
+      wp->pool = newp;
+    }
+
+  /* start the worker threads. */
+  for (i = 0L; i < num_workers; i++)
+    if (pthread_create (&newp->workers[i].thread, NULL,
+                        run_worker, &newp->workers[i]) != 0)
+      eprintf ("pthread_create() failed:");
+
+  /* return the pool pointer. */
+  return newp;
+}
+
+/*!
+   \fn void free_thread_pool (THREAD_POOL *)
+
+   \brief A function that deallocates a `THREAD_POOL' data structure.
+
+   This function lets the workers of the pool (`pool') run all the
+   queued tasks, waits for them to exit and deallocates the pool.
+
+   \param pool a pointer to a `THREAD_POOL' data structure.
+*/
+void
+free_thread_pool (THREAD_POOL * pool)
+{
+  /* is used for the loops. */
+  register ulong i;
+
+  /* no more tasks will come. */
+  pthread_mutex_lock (&pool->lock);
+  pool->done = true;
+  pthread_cond_broadcast (&pool->wake);
+  pthread_mutex_unlock (&pool->lock);
+
+  for (i = 0L; i < pool->num_workers; i++)
+    pthread_join (pool->workers[i].thread, NULL);
+
+  /* a late worker may still look at the queues
+     of the others, so they go after all the joins. */
+  for (i = 0L; i < pool->num_workers; i++)
+    {
+      pthread_mutex_destroy (&pool->workers[i].lock);
+      free (pool->workers[i].tasks);
+    }
+
+  pthread_cond_destroy (&pool->wake);
+  pthread_mutex_destroy (&pool->lock);
+
+  free (pool->workers);
+  free (pool);
+}
+
+/*!
+   \fn void thread_pool_submit (THREAD_POOL *, TASK_FUNC, void *)
+
+   \brief A function that submits a task to the pool.
+
+   This function queues a task (`func' with `arg') at the back of the
+   queue of the next worker (round robin) of the pool (`pool') and
+   wakes a sleeping worker.
+
+   \param pool a pointer to a `THREAD_POOL' data structure.
+   \param func a `TASK_FUNC' type definition.
+   \param arg a pointer to void.
+*/
+void
+thread_pool_submit (THREAD_POOL * pool, TASK_FUNC func, void *arg)
+{
+  /* externs. */
+
+  /* function externs. */
+  extern void *emalloc (size_t);
+
+  /* the queue of the task. */
+  WORKER *wp = &pool->workers[pool->next++ % pool->num_workers];
+
+  /* is used for the loops. */
+  register ulong i;
+
+  pthread_mutex_lock (&wp->lock);
+
+  /* grow the ring (unwrapped). */
+  if (wp->count == wp->size)
+    {
+      TASK *tasks = (TASK *) emalloc (2 * wp->size * sizeof (TASK));
+
+      for (i = 0L; i < wp->count; i++)
+        tasks[i] = wp->tasks[(wp->head + i) % wp->size];
+
+      free (wp->tasks);
+      wp->tasks = tasks;
+      wp->size *= 2;
+      wp->head = 0L;
+    }
+
+  wp->tasks[(wp->head + wp->count) % wp->size].func = func;
+  wp->tasks[(wp->head + wp->count) % wp->size].arg = arg;
+  wp->count++;
+
+  pthread_mutex_unlock (&wp->lock);
+
+  /* wake a sleeping worker. */
+  pthread_mutex_lock (&pool->lock);
+  pool->pending++;
+  pthread_cond_signal (&pool->wake);
+  pthread_mutex_unlock (&pool->lock);
+}
+
+/*!
+   \fn ulong default_num_jobs (void)
+
+   \brief A function that returns the default number of worker threads.
+
+   This function returns the number of processors which the program
+   may really use: the processors of its affinity mask, limited by
+   the processor quota of its control group (containers and batch
+   schedulers set these, so the number of the processors of the
+   machine is usually too much).
+
+   \return An unsigned long integer.
+*/
+ulong
+default_num_jobs (void)
+{
+  /* the processors of the affinity mask. */
+  cpu_set_t set;
+
+  /* the number of jobs. */
+  ulong jobs = 1L, quota;
+
+  if (sched_getaffinity (0, sizeof (set), &set) == 0)
+    jobs = (ulong) CPU_COUNT (&set);
+
+  /* the quota of the control group. */
+  if ((quota = cgroup_cpu_quota ()) > 0 && quota < jobs)
+    jobs = quota;
+
+  return (jobs > 0 ? jobs : 1L);
+}
+
+/*!
+   \fn static void * run_worker (void *)
+
+   \brief A function that runs the tasks of a worker thread.
+
+   This function is the main function of a worker thread (`arg').
+   The worker runs the tasks of its own queue, else it steals the
+   tasks of the other workers. When there are no queued tasks, it
+   sleeps until a task is submitted or the pool is released.
+
+   \param arg a pointer to void.
+
+   \return A pointer to void.
+*/
+static void *
+run_worker (void *arg)
+{
+  WORKER *wp = (WORKER *) arg;
+  THREAD_POOL *pool = wp->pool;
+
+  /* the current task. */
+  TASK task;
+
+  for (;;)
+    {
+      if (take_task (wp, &task))
+        {
+          pthread_mutex_lock (&pool->lock);
+          pool->pending--;
+          pthread_mutex_unlock (&pool->lock);
+
+          task.func (task.arg, wp->index);
+          continue;
+        }
+
+      /* sleep while there is nothing to run. */
+      pthread_mutex_lock (&pool->lock);
+
+      while (pool->pending == 0 && !pool->done)
+        pthread_cond_wait (&pool->wake, &pool->lock);
+
+      if (pool->pending == 0 && pool->done)
+        {
+          pthread_mutex_unlock (&pool->lock);
+          break;
+        }
+
+      pthread_mutex_unlock (&pool->lock);
+    }
+
+  return NULL;
+}
+
+/*!
+   \fn static BOOL take_task (WORKER *, TASK *)
+
+   \brief A function that takes the next task of a worker.
+
+   This function takes the front task of the queue of the worker
+   (`wp'). If its queue is empty, it steals the back task of the
+   queue of another worker. It returns `false' if all the queues
+   are empty.
+
+   \param wp a pointer to a `WORKER' data structure.
+   \param task a pointer to a `TASK' data structure.
+
+   \return A `BOOL' enumeration value (`false', `true').
+*/
+static BOOL
+take_task (WORKER * wp, TASK * task)
+{
+  THREAD_POOL *pool = wp->pool;
+
+  /* is used for the loops. */
+  register ulong i;
+
+  /* the own queue first (the oldest task). */
+  pthread_mutex_lock (&wp->lock);
+  if (wp->count > 0)
+    {
+      *task = wp->tasks[wp->head];
+      wp->head = (wp->head + 1) % wp->size;
+      wp->count--;
+      pthread_mutex_unlock (&wp->lock);
+      return true;
+    }
+  pthread_mutex_unlock (&wp->lock);
+
+  /* steal from the others (the newest task). */
+  for (i = 1L; i < pool->num_workers; i++)
+    {
+      WORKER *vp = &pool->workers[(wp->index + i) % pool->num_workers];
+
+      pthread_mutex_lock (&vp->lock);
+      if (vp->count > 0)
+        {
+          vp->count--;
+          *task = vp->tasks[(vp->head + vp->count) % vp->size];
+          pthread_mutex_unlock (&vp->lock);
+          return true;
+        }
+      pthread_mutex_unlock (&vp->lock);
+    }
+
+  return false;
+}
+
+/*!
+   \fn static ulong cgroup_cpu_quota (void)
+
+   \brief A function that returns the processor quota of the control group.
+
+   This function reads the processor quota of the control group of
+   the program (the `cpu.max' file of the unified hierarchy or the
+   `cpu.cfs_quota_us' and `cpu.cfs_period_us' files of the version 1
+   hierarchy) and rounds it up to processors. It returns 0 if there
+   is no quota.
+
+   \return An unsigned long integer.
+*/
+static ulong
+cgroup_cpu_quota (void)
+{
+  /* the lines of the files. */
+  char line[MAX_CGROUP_LINE], dir[MAX_CGROUP_LINE];
+
+  /* the quota and its period. */
+  long quota, period;
+
+  /* the cgroup file of the process. */
+  FILE *fp;
+
+  /* the directory of the own group (unified hierarchy). */
+  strcpy (dir, "/sys/fs/cgroup");
+  if ((fp = fopen ("/proc/self/cgroup", "r")) != NULL)
+    {
+      while (fgets (line, sizeof (line), fp) != NULL)
+        if (!strncmp (line, "0::/", 4)
+            && strlen (dir) + strlen (line + 3) < sizeof (dir))
+          {
+            line[strcspn (line, "\n")] = '\0';
+            strcat (dir, line + 3);
+            break;
+          }
+
+      fclose (fp);
+    }
+
+  /* "max PERIOD" or "QUOTA PERIOD". */
+  if (read_cgroup_line (dir, "cpu.max", line)
+      || read_cgroup_line ("/sys/fs/cgroup", "cpu.max", line))
+    {
+      if (sscanf (line, "%ld %ld", &quota, &period) == 2
+          && quota > 0 && period > 0)
+        return (ulong) ((quota + period - 1) / period);
+
+      return 0L;
+    }
+
+  /* a negative quota means no quota. */
+  if (read_cgroup_line ("/sys/fs/cgroup/cpu", "cpu.cfs_quota_us", line)
+      && sscanf (line, "%ld", &quota) == 1 && quota > 0
+      && read_cgroup_line ("/sys/fs/cgroup/cpu", "cpu.cfs_period_us", line)
+      && sscanf (line, "%ld", &period) == 1 && period > 0)
+    return (ulong) ((quota + period - 1) / period);
+
+  return 0L;
+}
+
+/*!
+   \fn static BOOL read_cgroup_line (const char *, const char *, char *)
+
+   \brief A function that reads the first line of a control group file.
+
+   This function reads the first line of the file `name' of the
+   directory `dir' into `line' (of `MAX_CGROUP_LINE' characters).
+   It returns `false' if the file can not be read.
+
+   \param dir a pointer to a constant character.
+   \param name a pointer to a constant character.
+   \param line a pointer to a character.
+
+   \return A `BOOL' enumeration value (`false', `true').
+*/
+static BOOL
+read_cgroup_line (const char *dir, const char *name, char *line)
+{
+  /* the path of the file. */
+  char path[MAX_CGROUP_LINE + 64];
+
+  /* the file. */
+  FILE *fp;
+
+  /* do we have the line? */
+  BOOL ok;
+
+  sprintf (path, "%.*s/%s", MAX_CGROUP_LINE - 1, dir, name);
+
+  if ((fp = fopen (path, "r")) == NULL)
+    return false;
+
+  ok = (fgets (line, MAX_CGROUP_LINE, fp) != NULL ? true : false);
+  fclose (fp);
+
+  return ok;
+}
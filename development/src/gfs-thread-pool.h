@@ -0,0 +1,210 @@
+/*
+ *  `gfs-thread-pool.h'.
+ *
+ *  This header contains the worker thread pool structs and typedefs.
+ *
+ *  Copyright (C) 2008  Efstathios Chatzikyriakidis (stathis.chatzikyriakidis@gmail.com).
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*!
+   \file gfs-thread-pool.h
+   \brief This header contains the worker thread pool structs and typedefs.
+*/
+
+/*
+ * type definitions.
+ */
+
+/*!
+   \typedef TASK_FUNC
+   \brief Task function type definition.
+
+   This type definition is a synonym for a pointer to a function
+   that runs a task (`arg') on the worker thread with the index
+   `worker' (so that a task can use per worker data).
+*/
+typedef void (*TASK_FUNC) (void *arg, const ulong worker);
+
+/*
+ * structure data types.
+ */
+
+/*!
+   \struct taskT
+   \brief Task data structure.
+
+   This data structure keeps a task of the pool.
+*/
+struct taskT
+{
+  /*!
+     \var func
+     \brief The function of the task.
+   */
+  TASK_FUNC func;
+
+  /*!
+     \var arg
+     \brief The argument of the function.
+   */
+  void *arg;
+};
+
+/*!
+   \struct workerT
+   \brief Worker thread data structure.
+
+   This data structure keeps a worker thread of the pool and its
+   double ended queue of tasks (a ring). The worker takes its tasks
+   from the front of its queue and the idle workers steal tasks
+   from the back.
+*/
+struct workerT
+{
+  /*!
+     \var thread
+     \brief The thread of the worker.
+   */
+  pthread_t thread;
+
+  /*!
+     \var lock
+     \brief The lock of the queue.
+   */
+  pthread_mutex_t lock;
+
+  /*!
+     \var tasks
+     \brief The ring of the queued tasks.
+   */
+  struct taskT *tasks;
+
+  /*!
+     \var head
+     \brief The index of the front task.
+   */
+  ulong head;
+
+  /*!
+     \var count
+     \brief The number of the queued tasks.
+   */
+  ulong count;
+
+  /*!
+     \var size
+     \brief The size of the ring.
+   */
+  ulong size;
+
+  /*!
+     \var index
+     \brief The index of the worker.
+   */
+  ulong index;
+
+  /*!
+     \var pool
+     \brief The pool of the worker.
+   */
+  struct thread_poolT *pool;
+};
+
+/*!
+   \struct thread_poolT
+   \brief Worker thread pool data structure.
+
+   This data structure keeps a pool of worker threads. The tasks
+   are spread over the queues of the workers and an idle worker
+   steals the tasks of the others, so the pool balances itself
+   when the tasks have very different costs. The workers sleep
+   only when there are no queued tasks at all.
+*/
+struct thread_poolT
+{
+  /*!
+     \var workers
+     \brief The worker threads.
+   */
+  struct workerT *workers;
+
+  /*!
+     \var num_workers
+     \brief The number of the worker threads.
+   */
+  ulong num_workers;
+
+  /*!
+     \var next
+     \brief The queue of the next submitted task.
+   */
+  ulong next;
+
+  /*!
+     \var lock
+     \brief The lock of the pool state.
+   */
+  pthread_mutex_t lock;
+
+  /*!
+     \var wake
+     \brief Signals the sleeping workers.
+   */
+  pthread_cond_t wake;
+
+  /*!
+     \var pending
+     \brief The number of the queued tasks of all the workers.
+   */
+  ulong pending;
+
+  /*!
+     \var done
+     \brief Are there no more tasks to come?
+   */
+  BOOL done;
+};
+
+/*
+ * type definitions.
+ */
+
+/*!
+   \typedef TASK
+   \brief Task data structure type definition.
+
+   This type definition is a synonym
+   for the task data structure.
+*/
+typedef struct taskT TASK;
+
+/*!
+   \typedef WORKER
+   \brief Worker thread data structure type definition.
+
+   This type definition is a synonym
+   for the worker thread data structure.
+*/
+typedef struct workerT WORKER;
+
+/*!
+   \typedef THREAD_POOL
+   \brief Worker thread pool data structure type definition.
+
+   This type definition is a synonym
+   for the worker thread pool data structure.
+*/
+typedef struct thread_poolT THREAD_POOL;
@@ -0,0 +1,563 @@
+/*
+ *  `gfs-walk.c'.
+ *
+ *  This interface deals with the walking of directory trees.
+ *
+ *  Copyright (C) 2008  Efstathios Chatzikyriakidis (stathis.chatzikyriakidis@gmail.com).
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*!
+   \file gfs-walk.c
+   \brief This interface deals with the walking of directory trees.
+*/
+
+/* standard includes. */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <pthread.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+/* basic includes. */
+#include "gfs-typedefs.h"
+#include "gfs-walk.h"
+
+/* enumeration constants. */
+
+/*!
+   \brief Constants used from the interface.
+
+   This anonymous enumeration is used from the
+   interface in order to specify some constants.
+*/
+enum
+{
+  MAX_PENDING = 64 * 1024,      /*!< Max listed entries not consumed. */
+  MIN_ENTRIES = 16,             /*!< Initial entries of a directory. */
+  MIN_NAMES = 256               /*!< Initial names characters of a directory. */
+};
+
+/* function prototypes. */
+WALK *new_walk (const char *root, const ulong num_walkers);
+void free_walk (WALK * w);
+char *walk_next (WALK * w);
+static DIR_NODE *new_dir_node (char *path, DIR_NODE * parent);
+static void free_dir_node (DIR_NODE * node);
+static void push_dir (WALK * w, DIR_NODE * node);
+static void unlink_dir (WALK * w, DIR_NODE * node);
+static void *run_walker (void *arg);
+static void list_dir (WALK * w, DIR_NODE * node);
+static char *join_path (const char *dir, const char *name);
+
+/* functions. */
+
+/*!
+   \fn WALK * new_walk (const char *, const ulong)
+
+   \brief A function that starts the walk of a directory tree.
+
+   This function allocates a new walk of the directory tree `root'
+   and starts its `num_walkers' walker threads. If there are not any
+   walker threads, the consumer lists the directories itself.
+
+   \param root a pointer to a constant character.
+   \param num_walkers a constant unsigned long integer.
+
+   \return A pointer to a `WALK' data structure.
+*/
+WALK *
+new_walk (const char *root, const ulong num_walkers)
+{
+  /* externs. */
+
+  /* function externs. */
+  extern void *emalloc (size_t);
+  extern char *estrdup (const char *);
+  extern void eprintf (char *, ...);
+
+  WALK *newp;
+
+  /* is used for the loops. */
+  register ulong i;
+
+  /* allocate enough memory space. */
+  newp = (WALK *) emalloc (sizeof (WALK));
+
+  pthread_mutex_init (&newp->lock, NULL);
+  pthread_cond_init (&newp->work, NULL);
+  pthread_cond_init (&newp->listed, NULL);
+
+  newp->queue = NULL;
+  newp->pending = 0L;
+  newp->done = false;
+
+  /* the root is the first queued directory. */
+  newp->root = newp->curr = new_dir_node (estrdup (root), NULL);
+  push_dir (newp, newp->root);
+
+  newp->num_walkers = num_walkers;
+  newp->threads = (pthread_t *) emalloc ((num_walkers ? num_walkers : 1)
+                                         * sizeof (pthread_t));
+
+  for (i = 0L; i < num_walkers; i++)
+    if (pthread_create (&newp->threads[i], NULL, run_walker, newp) != 0)
+      eprintf ("pthread_create() failed:");
+
+  /* return the walk pointer. */
+  return newp;
+}
+
+/*!
+   \fn void free_walk (WALK *)
+
+   \brief A function that deallocates a `WALK' data structure.
+
+   This function stops the walker threads of a walk (`w') and
+   deallocates the walk (even if it is not finished).
+
+   \param w a pointer to a `WALK' data structure.
+*/
+void
+free_walk (WALK * w)
+{
+  /* is used for the loops. */
+  register ulong i;
+
+  pthread_mutex_lock (&w->lock);
+  w->done = true;
+  pthread_cond_broadcast (&w->work);
+  pthread_mutex_unlock (&w->lock);
+
+  for (i = 0L; i < w->num_walkers; i++)
+    pthread_join (w->threads[i], NULL);
+
+  /* the rest of the tree. */
+  if (w->root != NULL)
+    free_dir_node (w->root);
+
+  pthread_cond_destroy (&w->listed);
+  pthread_cond_destroy (&w->work);
+  pthread_mutex_destroy (&w->lock);
+
+  free (w->threads);
+  free (w);
+}
+
+/*!
+   \fn char * walk_next (WALK *)
+
+   \brief A function that returns the next file of a walk.
+
+   This function returns the path of the next regular file of the
+   walk (`w') in depth first order (the entries of a directory are
+   taken in the order of the directory) or NULL if the walk is
+   finished. If the directory of the consumer is not listed yet, it
+   waits for its walker, or it lists it itself if no walker took it.
+   The caller must free the path.
+
+   \param w a pointer to a `WALK' data structure.
+
+   \return A pointer to a character.
+*/
+char *
+walk_next (WALK * w)
+{
+  /* the current directory and entry. */
+  DIR_NODE *node;
+  DIR_ENTRY *e;
+
+  /* the path of the file. */
+  char *path = NULL;
+
+  pthread_mutex_lock (&w->lock);
+
+  while ((node = w->curr) != NULL)
+    {
+      /* list the directory now. */
+      if (node->state == d_queued)
+        {
+          unlink_dir (w, node);
+          node->state = d_listing;
+
+          pthread_mutex_unlock (&w->lock);
+          list_dir (w, node);
+          pthread_mutex_lock (&w->lock);
+        }
+
+      while (node->state != d_listed)
+        pthread_cond_wait (&w->listed, &w->lock);
+
+      if (node->pos < node->num_entries)
+        {
+          e = &node->entries[node->pos++];
+
+          /* there is room for the walkers. */
+          if (w->pending-- == MAX_PENDING)
+            pthread_cond_broadcast (&w->work);
+
+          /* descend into the subdirectory. */
+          if (e->child != NULL)
+            {
+              w->curr = e->child;
+              continue;
+            }
+
+          path = join_path (node->path, node->names + e->name);
+          break;
+        }
+
+      /* the directory is finished. */
+      w->curr = node->parent;
+
+      if (node->parent != NULL)
+        node->parent->entries[node->parent->pos - 1].child = NULL;
+      else
+        w->root = NULL;
+
+      free_dir_node (node);
+    }
+
+  pthread_mutex_unlock (&w->lock);
+
+  return path;
+}
+
+/*!
+   \fn static DIR_NODE * new_dir_node (char *, DIR_NODE *)
+
+   \brief A function that returns a new `DIR_NODE' data structure.
+
+   \param path a pointer to a character (the node keeps it).
+   \param parent a pointer to a `DIR_NODE' data structure.
+
+   \return A pointer to a `DIR_NODE' data structure.
+*/
+static DIR_NODE *
+new_dir_node (char *path, DIR_NODE * parent)
+{
+  /* externs. */
+
+  /* function externs. */
+  extern void *emalloc (size_t);
+
+  DIR_NODE *newp;
+
+  /* allocate enough memory space. */
+  newp = (DIR_NODE *) emalloc (sizeof (DIR_NODE));
+
+  newp->path = path;
+  newp->state = d_queued;
+  newp->names = NULL;
+  newp->entries = NULL;
+  newp->num_entries = newp->pos = 0L;
+  newp->parent = parent;
+  newp->prev = newp->next = NULL;
+
+  /* return the node pointer. */
+  return newp;
+}
+
+/*!
+   \fn static void free_dir_node (DIR_NODE *)
+
+   \brief A function that deallocates a `DIR_NODE' data structure.
+
+   This function deallocates a directory node (`node') and all
+   its subdirectory nodes.
+
+   \param node a pointer to a `DIR_NODE' data structure.
+*/
+static void
+free_dir_node (DIR_NODE * node)
+{
+  /* is used for the loops. */
+  register ulong i;
+
+  for (i = 0L; i < node->num_entries; i++)
+    if (node->entries[i].child != NULL)
+      free_dir_node (node->entries[i].child);
+
+  free (node->entries);
+  free (node->names);
+  free (node->path);
+  free (node);
+}
+
+/*!
+   \fn static void push_dir (WALK *, DIR_NODE *)
+
+   \brief A function that queues a directory for the walkers.
+
+   This function queues a directory (`node') on the top of the
+   queue of the walk (`w'). The walk must be locked.
+
+   \param w a pointer to a `WALK' data structure.
+   \param node a pointer to a `DIR_NODE' data structure.
+*/
+static void
+push_dir (WALK * w, DIR_NODE * node)
+{
+  node->prev = NULL;
+  node->next = w->queue;
+
+  if (w->queue != NULL)
+    w->queue->prev = node;
+
+  w->queue = node;
+}
+
+/*!
+   \fn static void unlink_dir (WALK *, DIR_NODE *)
+
+   \brief A function that removes a directory from the queue.
+
+   This function removes a queued directory (`node') from the
+   queue of the walk (`w'). The walk must be locked.
+
+   \param w a pointer to a `WALK' data structure.
+   \param node a pointer to a `DIR_NODE' data structure.
+*/
+static void
+unlink_dir (WALK * w, DIR_NODE * node)
+{
+  if (node->prev != NULL)
+    node->prev->next = node->next;
+  else
+    w->queue = node->next;
+
+  if (node->next != NULL)
+    node->next->prev = node->prev;
+
+  node->prev = node->next = NULL;
+}
+
+/*!
+   \fn static void * run_walker (void *)
+
+   \brief A function that runs a walker thread.
+
+   This function is the main function of a walker thread of a walk
+   (`arg'). The walker lists the last queued directory, while the
+   listed entries which are not consumed are not too many.
+
+   \param arg a pointer to void.
+
+   \return A pointer to void.
+*/
+static void *
+run_walker (void *arg)
+{
+  WALK *w = (WALK *) arg;
+
+  /* the directory to list. */
+  DIR_NODE *node;
+
+  pthread_mutex_lock (&w->lock);
+
+  for (;;)
+    {
+      while (!w->done && (w->queue == NULL || w->pending >= MAX_PENDING))
+        pthread_cond_wait (&w->work, &w->lock);
+
+      if (w->done)
+        break;
+
+      node = w->queue;
+      unlink_dir (w, node);
+      node->state = d_listing;
+
+      pthread_mutex_unlock (&w->lock);
+      list_dir (w, node);
+      pthread_mutex_lock (&w->lock);
+    }
+
+  pthread_mutex_unlock (&w->lock);
+
+  return NULL;
+}
+
+/*!
+   \fn static void list_dir (WALK *, DIR_NODE *)
+
+   \brief A function that lists a directory.
+
+   This function reads the entries of a directory (`node') through
+   its open descriptor. Only the regular files and the subdirectories
+   are kept (the symbolic links are not followed) and the type of an
+   entry is asked only if the directory does not tell it. Then the
+   entries are published to the walk (`w') and the subdirectories are
+   queued (the first one on the top). The walk must not be locked.
+
+   \param w a pointer to a `WALK' data structure.
+   \param node a pointer to a `DIR_NODE' data structure.
+*/
+static void
+list_dir (WALK * w, DIR_NODE * node)
+{
+  /* externs. */
+
+  /* function externs. */
+  extern void *emalloc (size_t);
+  extern void *erealloc (void *, size_t);
+  extern void weprintf (char *, ...);
+
+  /* the directory and its descriptor. */
+  DIR *dir = NULL;
+  int fd;
+
+  /* the current entry. */
+  struct dirent *de;
+
+  /* buffer for keeping file info. */
+  struct stat stbuf;
+
+  /* the type of the current entry. */
+  int type;
+
+  /* the entries and their names. */
+  DIR_ENTRY *entries = NULL;
+  char *names = NULL;
+  ulong num = 0L, max = 0L;
+  size_t len = 0, size = 0, n;
+
+  /* is used for the loops. */
+  register ulong i;
+
+  fd = openat (AT_FDCWD, node->path,
+               O_RDONLY | O_DIRECTORY | O_NOCTTY | O_CLOEXEC);
+
+  if (fd != -1 && (dir = fdopendir (fd)) == NULL)
+    close (fd);
+
+  /* a directory which we cannot access is skipped. */
+  if (dir == NULL && errno != ENOENT && errno != EACCES)
+    weprintf ("opendir(\"%.500s\") failed:", node->path);
+
+  while (dir != NULL && (de = readdir (dir)) != NULL)
+    {
+      if (!strcmp (de->d_name, ".") || !strcmp (de->d_name, ".."))
+        continue;
+
+      type = de->d_type;
+
+      /* the directory does not tell the type. */
+      if (type == DT_UNKNOWN)
+        {
+          if (fstatat (dirfd (dir), de->d_name, &stbuf,
+                       AT_SYMLINK_NOFOLLOW) == -1)
+            continue;
+
+          if (S_ISREG (stbuf.st_mode))
+            type = DT_REG;
+          else if (S_ISDIR (stbuf.st_mode))
+            type = DT_DIR;
+        }
+
+      /* skip the links and the special files. */
+      if (type != DT_REG && type != DT_DIR)
+        continue;
+
+      /* grow the entries and the names. */
+      if (num == max)
+        {
+          max = (max ? 2 * max : MIN_ENTRIES);
+          entries = (DIR_ENTRY *) erealloc (entries, max * sizeof (DIR_ENTRY));
+        }
+
+      n = strlen (de->d_name) + 1;
+      if (len + n > size)
+        {
+          do
+            size = (size ? 2 * size : MIN_NAMES);
+          while (len + n > size);
+
+          names = (char *) erealloc (names, size);
+        }
+
+      memcpy (names + len, de->d_name, n);
+
+      entries[num].name = len;
+      entries[num].child = (type == DT_DIR
+                            ? new_dir_node (join_path (node->path,
+                                                       de->d_name), node)
+                            : NULL);
+      len += n;
+      num++;
+    }
+
+  if (dir != NULL)
+    closedir (dir);
+
+  /* publish the listing. */
+  pthread_mutex_lock (&w->lock);
+
+  node->entries = entries;
+  node->names = names;
+  node->num_entries = num;
+  node->state = d_listed;
+
+  /* the first subdirectory is on the top. */
+  for (i = num; i > 0; i--)
+    if (entries[i - 1].child != NULL)
+      push_dir (w, entries[i - 1].child);
+
+  w->pending += num;
+
+  pthread_cond_broadcast (&w->listed);
+  pthread_cond_broadcast (&w->work);
+  pthread_mutex_unlock (&w->lock);
+}
+
+/*!
+   \fn static char * join_path (const char *, const char *)
+
+   \brief A function that joins a directory path and an entry name.
+
+   \param dir a pointer to a constant character.
+   \param name a pointer to a constant character.
+
+   \return A pointer to a character.
+*/
+static char *
+join_path (const char *dir, const char *name)
+{
+  /* externs. */
+
+  /* function externs. */
+  extern void *emalloc (size_t);
+
+  /* the lengths of the parts. */
+  size_t dlen = strlen (dir);
+  const size_t nlen = strlen (name);
+
+  /* the joined path. */
+  char *path = (char *) emalloc (dlen + nlen + 2);
+
+  memcpy (path, dir, dlen);
+
+  /* do not double the separator. */
+  if (dlen > 0 && dir[dlen - 1] != '/')
+    path[dlen++] = '/';
+
+  memcpy (path + dlen, name, nlen + 1);
+
+  return path;
+}
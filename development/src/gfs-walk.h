@@ -0,0 +1,237 @@
+/*
+ *  `gfs-walk.h'.
+ *
+ *  This header contains the directory walker structs and typedefs.
+ *
+ *  Copyright (C) 2008  Efstathios Chatzikyriakidis (stathis.chatzikyriakidis@gmail.com).
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*!
+   \file gfs-walk.h
+   \brief This header contains the directory walker structs and typedefs.
+*/
+
+/*
+ * enumeration data types.
+ */
+
+/*!
+   \enum dir_stateT
+   \brief Directory state enumeration data type.
+
+   This enumeration data type is used from the walker in
+   order to specify the state of the listing of a directory.
+*/
+enum dir_stateT
+{
+  d_queued,                     /*!< the directory waits for a walker. */
+  d_listing,                    /*!< the directory is being listed.    */
+  d_listed                      /*!< the directory is listed.          */
+};
+
+/*
+ * structure data types.
+ */
+
+/*!
+   \struct dir_entryT
+   \brief Directory entry data structure.
+
+   This data structure keeps an entry (a regular file
+   or a subdirectory) of a listed directory.
+*/
+struct dir_entryT
+{
+  /*!
+     \var name
+     \brief The offset of the name in the names of the directory.
+   */
+  size_t name;
+
+  /*!
+     \var child
+     \brief The subdirectory node (or NULL for a file).
+   */
+  struct dir_nodeT *child;
+};
+
+/*!
+   \struct dir_nodeT
+   \brief Directory node data structure.
+
+   This data structure keeps a directory of the walked tree
+   and its entries (in the order of the directory).
+*/
+struct dir_nodeT
+{
+  /*!
+     \var path
+     \brief The path of the directory.
+   */
+  char *path;
+
+  /*!
+     \var state
+     \brief The state of the listing.
+   */
+  enum dir_stateT state;
+
+  /*!
+     \var names
+     \brief The names of the entries (NUL terminated).
+   */
+  char *names;
+
+  /*!
+     \var entries
+     \brief The entries of the directory.
+   */
+  struct dir_entryT *entries;
+
+  /*!
+     \var num_entries
+     \brief The number of the entries.
+   */
+  ulong num_entries;
+
+  /*!
+     \var pos
+     \brief The next entry of the consumer.
+   */
+  ulong pos;
+
+  /*!
+     \var parent
+     \brief The parent directory (or NULL for the root).
+   */
+  struct dir_nodeT *parent;
+
+  /*!
+     \var prev
+     \brief The previous queued directory.
+   */
+  struct dir_nodeT *prev;
+
+  /*!
+     \var next
+     \brief The next queued directory.
+   */
+  struct dir_nodeT *next;
+};
+
+/*!
+   \struct walkT
+   \brief Directory walker data structure.
+
+   This data structure keeps the walk of a directory tree. The walker
+   threads list the queued directories ahead (the last queued first,
+   so they follow the consumer) and the consumer takes the files of
+   the tree in depth first order. The listed entries which are not
+   consumed yet are bounded, so a huge tree does not fill the memory.
+*/
+struct walkT
+{
+  /*!
+     \var threads
+     \brief The walker threads.
+   */
+  pthread_t *threads;
+
+  /*!
+     \var num_walkers
+     \brief The number of the walker threads.
+   */
+  ulong num_walkers;
+
+  /*!
+     \var lock
+     \brief The lock of the walk state.
+   */
+  pthread_mutex_t lock;
+
+  /*!
+     \var work
+     \brief Signals the walkers (queued directories or room).
+   */
+  pthread_cond_t work;
+
+  /*!
+     \var listed
+     \brief Signals the consumer (a listed directory).
+   */
+  pthread_cond_t listed;
+
+  /*!
+     \var queue
+     \brief The queued directories (last in, first out).
+   */
+  struct dir_nodeT *queue;
+
+  /*!
+     \var root
+     \brief The root directory (or NULL when it is consumed).
+   */
+  struct dir_nodeT *root;
+
+  /*!
+     \var curr
+     \brief The current directory of the consumer.
+   */
+  struct dir_nodeT *curr;
+
+  /*!
+     \var pending
+     \brief The listed entries which are not consumed yet.
+   */
+  ulong pending;
+
+  /*!
+     \var done
+     \brief Is the walk released?
+   */
+  BOOL done;
+};
+
+/*
+ * type definitions.
+ */
+
+/*!
+   \typedef DIR_NODE
+   \brief Directory node data structure type definition.
+
+   This type definition is a synonym
+   for the directory node data structure.
+*/
+typedef struct dir_nodeT DIR_NODE;
+
+/*!
+   \typedef DIR_ENTRY
+   \brief Directory entry data structure type definition.
+
+   This type definition is a synonym
+   for the directory entry data structure.
+*/
+typedef struct dir_entryT DIR_ENTRY;
+
+/*!
+   \typedef WALK
+   \brief Directory walker data structure type definition.
+
+   This type definition is a synonym
+   for the directory walker data structure.
+*/
+typedef struct walkT WALK;
@@ -27,8 +27,12 @@
 /* standard includes. */
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <locale.h>
 #include <libintl.h>
+#include <sys/types.h>
+#include <sys/time.h>
+#include <sys/resource.h>
 
 /* basic includes. */
 #include "gfs-defines.h"
@@ -61,9 +65,9 @@
 
 /*!
    \var input_files_list
-   \brief Input files linked list.
+   \brief Input files list.
 
-   This is a pointer to the input files linked list.
+   This is a pointer to the input files list.
 */
 INPUT_FILES *input_files_list = NULL;
 
@@ -91,10 +95,13 @@ main (int argc, char *argv[])
   extern ulong count_input_files (INPUT_FILES *);
   extern void print_input_files (FILE *, INPUT_FILES *);
   extern void free_input_files (INPUT_FILES *);
+  extern ulong input_files_memory (INPUT_FILES *);
 
   extern BOOL process_input_files (INPUT_FILES *, OPTIONS *);
   extern BOOL process_input_file (FILE *, OPTIONS *);
 
+  extern int index_command (cint, char *[]);
+
   extern void eprintf (char *, ...);
   extern FILE *efopen (const char *, const char *);
   extern void set_prog_name (const char *);
@@ -104,6 +111,8 @@ main (int argc, char *argv[])
   extern cstring show_input_files;
   extern cstring show_search_files;
   extern cstring usage_specify_pattern;
+  extern cstring show_peak_memory;
+  extern cstring show_list_memory;
 
   /* local variables. */
 
@@ -122,6 +131,9 @@ main (int argc, char *argv[])
    */
   BOOL found_match = false;
 
+  /* the resource usage of the program. */
+  struct rusage usage;
+
   /*** set program name and get environment input. ***/
 
   /* set the internal program name. */
@@ -140,13 +152,21 @@ main (int argc, char *argv[])
   bindtextdomain (LOCALE_PACKAGE, LOC_DIR);
   textdomain (LOCALE_PACKAGE);
 
+  /*** run an index command. ***/
+
+  /* the first argument may be an index command. */
+  if (argc > 1 && !strcmp (argv[1], "index"))
+    return index_command (argc - 1, argv + 1);
+
   /*** manage command line options. ***/
 
   /* parse the command line arguments. */
   cop = parse_options (cop, argc, argv);
 
-  /* if match pattern is empty return a short usage. */
-  if (cop->pattern == NULL)
+  /* if there is no match pattern return a short usage. An
+     empty patterns file is a pattern source which matches
+     nothing. */
+  if (cop->num_patterns == 0 && !cop->pattern_file)
     eprintf ("%s", _(usage_specify_pattern));
 
   /* print verbose messages. */
@@ -175,13 +195,13 @@ main (int argc, char *argv[])
   /*** try to open the environment input file. ***/
 
   /* if there are no input files. */
-  if (count_input_files (input_files_list) == 0)
+  if (count_input_files (input_files_list) == 0 && cop->files_from == NULL)
     /* if there is an environment input file. */
     if (env_input != NULL)
       /* try to open it and check for error. */
       if ((efp = efopen (env_input, "r")) == NULL)
         {
-          /* free input files linked list. */
+          /* free input files list. */
           free_input_files (input_files_list);
 
           return (EXIT_ERROR);
@@ -189,27 +209,38 @@ main (int argc, char *argv[])
 
   /*** process input data. ***/
 
-  /* if the are any accepted input files. */
-  if (count_input_files (input_files_list) > 0)
+  /* if the are any accepted input files (or a file list). */
+  if (count_input_files (input_files_list) > 0 || cop->files_from != NULL)
     {
       /* if verbose option is enabled. */
       if (cop->verbose)
         fprintf (stdout, "%s%s", _(show_search_files), NEW_LINE);
 
-      /* process the input files linked list. */
+      /* process the input files list. */
       found_match = process_input_files (input_files_list, cop);
     }
   else
     /* process either environment or standard input. */
     found_match = process_input_file ((efp != NULL ? efp : stdin), cop);
 
+  /* if verbose option is enabled print the peak memory
+     of the program and the memory of the input files. */
+  if (cop->verbose && getrusage (RUSAGE_SELF, &usage) == 0)
+    {
+      fprintf (stdout, "%s%s %ld%s", NEW_LINE, _(show_peak_memory),
+               usage.ru_maxrss, NEW_LINE);
+      fprintf (stdout, "%s %lu%s", _(show_list_memory),
+               (input_files_memory (input_files_list) + 1023) / 1024,
+               NEW_LINE);
+    }
+
   /*** free memory, close files and return status. ***/
 
   /* close environment input file. */
   if (efp != NULL)
     fclose (efp);
 
-  /* free input files linked list. */
+  /* free input files list. */
   free_input_files (input_files_list);
 
   /* return status to the caller. */